@@ -0,0 +1,271 @@
+// Measures the framework's own runtime costs: test registration and dispatch, assertions, sections, filtering
+// and console reporting.  Results are written to stdout as JSON so that runs can be compared with a baseline.
+//
+// Usage: RuntimeBenchmark [--quick] [--repetitions=<count>] [name1] [name2] ...
+//   --quick:                Run a fraction of the iterations (a smoke test rather than a measurement)
+//   --repetitions=<count>:  Repeat each measurement <count> times and report the fastest and median (default 5)
+//   name:                   Only run the benchmarks whose name contains one of the given names
+#include "CppUnitTestFramework.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    // Discards all calls, so that measurements exclude reporting.
+    struct NullLogger : ILogger
+    {
+        void BeginRun(size_t /*test_count*/) override {}
+        void EndRun(size_t /*pass_count*/, size_t /*fail_count*/, size_t /*skip_count*/) override {}
+
+        void SkipTest(const std::string_view& /*name*/) override {}
+        void EnterTest(const std::string_view& /*name*/) override {}
+        void ExitTest(bool /*failed*/) override {}
+
+        void SkipSection(const std::string_view& /*name*/) override {}
+        void PushSection(const std::string_view& /*name*/) override {}
+        void PopSection() override {}
+
+        void AssertFailed(
+            AssertType /*type*/,
+            const AssertLocation& /*location*/,
+            const std::string_view& /*message*/
+        ) override {}
+        void UnhandledException(const std::string_view& /*message*/) override {}
+    };
+
+    // A stream buffer that discards its output, so that ConsoleLogger is measured without terminal I/O.
+    struct NullBuffer : std::streambuf
+    {
+    protected:
+        int overflow(int c) override {
+            return c;
+        }
+        std::streamsize xsputn(const char* /*data*/, std::streamsize count) override {
+            return count;
+        }
+    };
+
+    // Values read through a volatile so that the compiler cannot fold the assertions away.
+    volatile int s_left = 1;
+    volatile int s_right = 1;
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Runs the assertion and section macros in a loop.
+    struct BenchmarkFixture : CommonFixture
+    {
+        using CommonFixture::CommonFixture;
+
+        void PassingChecks(size_t iterations) {
+            for (size_t i = 0; i != iterations; ++i) {
+                CHECK_EQUAL(s_left, s_right);
+            }
+        }
+
+        void FailingChecks(size_t iterations) {
+            for (size_t i = 0; i != iterations; ++i) {
+                CHECK_EQUAL(s_left, s_right + 1);
+            }
+        }
+
+        void PassingDecomposedChecks(size_t iterations) {
+            for (size_t i = 0; i != iterations; ++i) {
+                CHECK(s_left == s_right);
+            }
+        }
+
+        void FailingDecomposedChecks(size_t iterations) {
+            for (size_t i = 0; i != iterations; ++i) {
+                CHECK(s_left == s_right + 1);
+            }
+        }
+
+        void Sections(size_t iterations) {
+            for (size_t i = 0; i != iterations; ++i) {
+                SECTION("Benchmark") {}
+            }
+        }
+    };
+
+    // An empty test case, registered by hand so that registration can be timed.
+    struct EmptyTestCase : CommonFixture
+    {
+        using CommonFixture::CommonFixture;
+        static constexpr std::string_view SourceFile = __FILE__;
+        static constexpr size_t SourceLine = __LINE__;
+        static constexpr std::string_view Name = "BenchmarkFixture::EmptyTestCase";
+        static std::vector<std::string_view> Tags;
+
+        void Run() {}
+    };
+    std::vector<std::string_view> EmptyTestCase::Tags = make_tags_array("fast", "benchmark");
+
+    //--------------------------------------------------------------------------------------------------------
+
+    struct Result {
+        std::string Name;
+        size_t Iterations;
+        std::vector<double> Nanoseconds;    // Per iteration, one entry per repetition
+    };
+
+    struct Benchmark {
+        bool Quick = false;
+        size_t Repetitions = 5;
+        std::vector<std::string> Filters;
+        std::vector<Result> Results;
+
+        bool IsSelected(std::string_view name) const {
+            if (Filters.empty()) {
+                return true;
+            }
+            return std::any_of(Filters.begin(), Filters.end(), [&](const std::string& filter) {
+                return name.find(filter) != std::string_view::npos;
+            });
+        }
+
+        size_t Scaled(size_t iterations) const {
+            return Quick ? std::max<size_t>(1, iterations / 100) : iterations;
+        }
+
+        // Times [body(iterations)] once per repetition.
+        template <typename TBody>
+        void Measure(std::string_view name, size_t iterations, size_t repetitions, const TBody& body) {
+            if (!IsSelected(name)) {
+                return;
+            }
+
+            Result result{ std::string(name), iterations, {} };
+            for (size_t repetition = 0; repetition != repetitions; ++repetition) {
+                auto start = std::chrono::steady_clock::now();
+                body(iterations);
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                result.Nanoseconds.push_back(
+                    std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations)
+                );
+            }
+            Results.push_back(std::move(result));
+        }
+
+        template <typename TBody>
+        void Measure(std::string_view name, size_t iterations, const TBody& body) {
+            Measure(name, iterations, Repetitions, body);
+        }
+
+        void WriteJson(std::ostream& out) const {
+            out << "{\n  \"benchmarks\": [";
+            for (size_t index = 0; index != Results.size(); ++index) {
+                auto& result = Results[index];
+                auto sorted = result.Nanoseconds;
+                std::sort(sorted.begin(), sorted.end());
+
+                out << (index == 0 ? "\n" : ",\n");
+                out << "    { \"name\": \"" << result.Name << "\""
+                    << ", \"iterations\": " << result.Iterations
+                    << ", \"repetitions\": " << sorted.size()
+                    << ", \"min_ns\": " << sorted.front()
+                    << ", \"median_ns\": " << sorted[sorted.size() / 2]
+                    << " }";
+            }
+            out << "\n  ]\n}" << std::endl;
+        }
+    };
+}
+
+//------------------------------------------------------------------------------------------------------------
+
+int main(int argc, const char* argv[]) {
+    Benchmark benchmark;
+    for (int index = 1; index < argc; ++index) {
+        std::string_view arg = argv[index];
+        if (arg == "--quick") {
+            benchmark.Quick = true;
+        } else if (arg.substr(0, 14) == "--repetitions=") {
+            benchmark.Repetitions = std::max<size_t>(1, std::strtoul(argv[index] + 14, nullptr, 10));
+        } else if (arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 2;
+        } else {
+            benchmark.Filters.emplace_back(arg);
+        }
+    }
+
+    auto null_logger = std::make_shared<NullLogger>();
+
+    // Registration can only be measured once, as the registry cannot be emptied.  The registered test cases
+    // are then used by the dispatch and filtering benchmarks.
+    const size_t test_count = benchmark.Scaled(10000);
+    bool registered = false;
+    benchmark.Measure("registration", test_count, 1, [&](size_t iterations) {
+        for (size_t i = 0; i != iterations; ++i) {
+            TestRegistry::Add<EmptyTestCase>();
+        }
+        registered = true;
+    });
+    if (!registered) {
+        for (size_t i = 0; i != test_count; ++i) {
+            TestRegistry::Add<EmptyTestCase>();
+        }
+    }
+
+    // Per test case cost of TestRegistry::Run, measured over every registered test case.
+    auto run_all = [&](const RunOptions& options) {
+        return [&, options](size_t /*iterations*/) {
+            TestRegistry::Run(&options, null_logger);
+        };
+    };
+    benchmark.Measure("dispatch", test_count, run_all(RunOptions{}));
+
+    RunOptions parallel_options;
+    parallel_options.Jobs = 4;
+    benchmark.Measure("dispatch_jobs4", test_count, run_all(parallel_options));
+
+    RunOptions no_match_options;
+    no_match_options.Keywords = { "NoSuchTest", "NoSuchTag" };
+    benchmark.Measure("filter_no_match", test_count, run_all(no_match_options));
+
+    RunOptions tag_match_options;
+    tag_match_options.Keywords = { "NoSuchTest", "benchmark" };
+    benchmark.Measure("filter_tag_match", test_count, run_all(tag_match_options));
+
+    // Assertions and sections, reported to a logger that does nothing.
+    BenchmarkFixture fixture(null_logger);
+    benchmark.Measure("check_pass", benchmark.Scaled(10000000), [&](size_t iterations) { fixture.PassingChecks(iterations); });
+    benchmark.Measure("check_fail", benchmark.Scaled(1000000), [&](size_t iterations) { fixture.FailingChecks(iterations); });
+    benchmark.Measure("check_decomposed_pass", benchmark.Scaled(10000000), [&](size_t iterations) { fixture.PassingDecomposedChecks(iterations); });
+    benchmark.Measure("check_decomposed_fail", benchmark.Scaled(1000000), [&](size_t iterations) { fixture.FailingDecomposedChecks(iterations); });
+    benchmark.Measure("section", benchmark.Scaled(1000000), [&](size_t iterations) { fixture.Sections(iterations); });
+
+    // A passing test case with one section, and a failing one, reported by ConsoleLogger.
+    NullBuffer null_buffer;
+    auto null_stream = std::make_shared<std::ostream>(&null_buffer);
+    for (bool verbose : { false, true }) {
+        RunOptions options;
+        options.Verbose = verbose;
+        auto logger = ConsoleLogger::Create(&options, null_stream);
+
+        std::string prefix = verbose ? "console_verbose" : "console_quiet";
+        benchmark.Measure(prefix + "_pass", benchmark.Scaled(100000), [&](size_t iterations) {
+            for (size_t i = 0; i != iterations; ++i) {
+                logger->EnterTest("BenchmarkFixture::Passed");
+                logger->PushSection("Section: Benchmark");
+                logger->PopSection();
+                logger->ExitTest(false);
+            }
+        });
+        benchmark.Measure(prefix + "_fail", benchmark.Scaled(100000), [&](size_t iterations) {
+            for (size_t i = 0; i != iterations; ++i) {
+                logger->EnterTest("BenchmarkFixture::Failed");
+                logger->PushSection("Section: Benchmark");
+                logger->AssertFailed(AssertType::Continue, AssertLocation{ __FILE__, __LINE__ }, "[1] == [2]");
+                logger->PopSection();
+                logger->ExitTest(true);
+            }
+        });
+    }
+
+    benchmark.WriteJson(std::cout);
+    return 0;
+}
@@ -1,16 +1,137 @@
 #pragma once
 
+// By default the framework is header-only and every translation unit compiles all of it.  Defining
+// CPPUTF_SPLIT_COMPILATION (for every translation unit) moves the non-template parts out of line: they are
+// compiled once, in the translation unit that defines GENERATE_UNIT_TEST_MAIN or CPPUTF_IMPLEMENTATION, and
+// the other translation units only see declarations, templates and macros.
+#if defined(GENERATE_UNIT_TEST_MAIN) && !defined(CPPUTF_IMPLEMENTATION)
+    #define CPPUTF_IMPLEMENTATION
+#endif
+#if defined(CPPUTF_SPLIT_COMPILATION)
+    #define CPPUTF_INLINE
+    #if !defined(CPPUTF_IMPLEMENTATION)
+        #define CPPUTF_DECLARATIONS_ONLY
+    #endif
+#else
+    #define CPPUTF_INLINE inline
+#endif
+
+#include <algorithm>
 #include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
-#include <functional>
-#include <iomanip>
-#include <iostream>
+#include <exception>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
+#include <string>
 #include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
 #include <vector>
 
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    #include <atomic>
+    #include <cctype>
+    #include <cerrno>
+    #include <condition_variable>
+    #include <cstdio>
+    #include <deque>
+    #include <filesystem>
+    #include <fstream>
+    #include <iomanip>
+    #include <iostream>
+    #include <list>
+    #include <map>
+    #include <set>
+    #include <system_error>
+    #include <thread>
+    #include <unordered_map>
+    #include <unordered_set>
+
+    // Bulk comparisons use SSE2/AVX2 when the compiler targets them.  Define CPPUTF_NO_SIMD to force the
+    // scalar implementation.
+    #if !defined(CPPUTF_NO_SIMD)
+        #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+            #include <emmintrin.h>
+            #define CPPUTF_SIMD_SSE2
+        #endif
+        #if defined(__AVX2__)
+            #include <immintrin.h>
+            #define CPPUTF_SIMD_AVX2
+        #endif
+    #endif
+
+    #if defined(__unix__) || defined(__APPLE__)
+        #include <fcntl.h>
+        #include <poll.h>
+        #include <signal.h>
+        #include <sys/mman.h>
+        #include <sys/stat.h>
+        #include <unistd.h>
+        #define CPPUTF_HAS_MMAP
+    #endif
+
+    #if defined(__linux__)
+        #include <elf.h>
+        #include <link.h>
+        #include <sys/epoll.h>
+    #endif
+#endif
+
+// The result cache fingerprints the loaded objects found through dl_iterate_phdr().
+#if defined(__linux__)
+    #define CPPUTF_HAS_RESULT_CACHE
+#endif
+
+// Output capture redirects the stdout and stderr file descriptors.
+#if defined(__unix__) || defined(__APPLE__)
+    #define CPPUTF_HAS_CAPTURE
+#endif
+
+// The async logger drains its queue when the process is killed by a fatal signal, through sigaction().
+#if defined(__unix__) || defined(__APPLE__)
+    #define CPPUTF_HAS_SIGACTION
+#endif
+
+// Async test cases can wait for file descriptors, through epoll on Linux and poll() elsewhere.  Timers are
+// available on every platform.
+#if defined(__unix__) || defined(__APPLE__)
+    #define CPPUTF_HAS_ASYNC_IO
+#endif
+
+// With C++20, async test cases can also be written as coroutines.  See COROUTINE_TEST_CASE.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    #include <coroutine>
+    #define CPPUTF_HAS_COROUTINES
+#endif
+
+#if !defined(CPPUTF_NO_FORK) && (defined(__unix__) || defined(__APPLE__))
+    #if !defined(CPPUTF_DECLARATIONS_ONLY)
+        #include <arpa/inet.h>
+        #include <fcntl.h>
+        #include <netdb.h>
+        #include <netinet/in.h>
+        #include <netinet/tcp.h>
+        #include <poll.h>
+        #include <sys/socket.h>
+        #include <sys/un.h>
+        #include <sys/wait.h>
+        #include <unistd.h>
+    #endif
+    #define CPPUTF_HAS_FORK
+#endif
+
 namespace CppUnitTestFramework {
 
     struct AssertLocation {
@@ -42,54 +163,427 @@ namespace CppUnitTestFramework {
     //--------------------------------------------------------------------------------------------------------
     //--------------------------------------------------------------------------------------------------------
 
+    struct ReporterOptions {
+        std::string Name;
+        std::string OutputFile;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // The exact names of the test cases to run, read from a --test_list file.  Keywords are each searched for
+    // in every test name, so a large selection is better passed as a list, whose names are looked up in a hash
+    // set and are not bound by the command line length.
+    struct TestList;
+
+    //--------------------------------------------------------------------------------------------------------
+
     struct RunOptions {
+        static constexpr size_t MaxJobs = 1024;
+
         bool Verbose = false;
         bool DiscoveryMode = false;
         bool AdapterInfo = false;
+        bool AsyncLogging = false;
+        bool Isolate = false;
+        size_t Jobs = 1;                // At most MaxJobs
+        std::string Coordinator;        // Address that workers connect to
+        size_t LocalWorkers = 0;        // Worker processes started by the coordinator
+        std::string Worker;             // Address of the coordinator to take test cases from
+        std::string CacheFile;          // Results of earlier runs, see ResultCache
+        std::string CacheKey;           // Added to every fingerprint
+        bool NoCache = false;           // Run every test case, but still update CacheFile
+        bool Capture = false;           // Report the stdout and stderr output of test cases, see OutputCapture
+        size_t CaptureLimit = 1 << 20;  // Bytes captured per test case
+        size_t AsyncLimit = 64;         // Async test cases in flight together on one event loop
+        bool UpdateSnapshots = false;
+        std::string SnapshotDirectory = "snapshots";
+        size_t TestDataLimit = size_t(512) << 20;   // Bytes of TEST_DATA files kept mapped while unused
+        std::string TraceFile;          // Timeline of the run, see TraceRecorder
         std::vector<std::string> Keywords;
+        std::shared_ptr<const TestList> SelectedTests;  // Run alongside the Keywords matches
+        std::vector<ReporterOptions> Reporters;
 
-        bool ParseCommandLine(int argc, const char* argv[]) {
-            for (int index = 1; index < argc; ++index) {
-                auto arg = argv[index];
+        bool ParseCommandLine(int argc, const char* argv[]);
 
-                if (arg[0] != '-') {
-                    Keywords.push_back(arg);
-                    continue;
+        // Reads SelectedTests from [path], or from stdin if [path] is "-".  Returns false if it can't be read.
+        bool LoadTestList(const std::string& path);
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE bool RunOptions::ParseCommandLine(int argc, const char* argv[]) {
+        for (int index = 1; index < argc; ++index) {
+            auto arg = argv[index];
+
+            if (arg[0] != '-') {
+                Keywords.push_back(arg);
+                continue;
+            }
+
+            std::string option_name{ &arg[1] };
+            std::optional<std::string> option_value;
+            if (auto split = option_name.find('='); option_name[0] == '-' && split != std::string::npos) {
+                option_value = option_name.substr(split + 1);
+                option_name.resize(split);
+            }
+
+            // The option as it was typed, for error messages.
+            const std::string option_arg = "-" + option_name;
+
+            // Long options can be spelled with hyphens instead of underscores, as in "--test-list".
+            if (option_name[0] == '-') {
+                std::replace(option_name.begin() + 1, option_name.end(), '-', '_');
+            }
+
+            if (option_name.size() > 1 && option_name[0] == 'j' && std::isdigit(static_cast<unsigned char>(option_name[1]))) {
+                // "-j<count>"
+                option_value = option_name.substr(1);
+                option_name = "j";
+            }
+
+            // Fetches the value for options that accept either "--name=value" or "--name value".  The next
+            // argument is not taken if it is another option.  Reports the missing value if there is none.
+            auto take_value = [&]() -> std::optional<std::string> {
+                if (!option_value && index + 1 < argc && std::strncmp(argv[index + 1], "--", 2) != 0) {
+                    option_value = argv[++index];
+                }
+                if (!option_value) {
+                    std::cerr << "Missing value for option: " << option_arg << std::endl;
+                }
+                return option_value;
+            };
+
+            // Fetches a size in bytes, which may have a K, M or G suffix.  Returns nullopt if it is not valid.
+            auto take_size = [&]() -> std::optional<size_t> {
+                auto value = take_value();
+                if (!value || value->empty()) {
+                    return std::nullopt;
+                }
+
+                size_t shift = 0;
+                switch (std::toupper(static_cast<unsigned char>(value->back()))) {
+                    case 'K': shift = 10; break;
+                    case 'M': shift = 20; break;
+                    case 'G': shift = 30; break;
+                    default: break;
                 }
 
-                std::string option_name{ &arg[1] };
-                if (option_name == "h" || option_name == "-help" || option_name == "?") {
-                    std::cout << "Usage: <program> [<options>] [keyword1] [keyword2] ..." << std::endl;
-                    std::cout << "    -h, --help, -?:        Displays this message" << std::endl;
-                    std::cout << "    -v, --verbose:         Show verbose output" << std::endl;
-                    std::cout << "        --discover_tests:  Output test details" << std::endl;
-                    std::cout << "        --adapter_info:    Output additional details for test adapters" << std::endl;
+                size_t size = 0;
+                auto end = value->data() + value->size() - (shift != 0 ? 1 : 0);
+                if (end == value->data() || std::from_chars(value->data(), end, size).ptr != end || size > (std::numeric_limits<size_t>::max() >> shift)) {
+                    return std::nullopt;
+                }
+                return size << shift;
+            };
+
+            if (option_name == "h" || option_name == "-help" || option_name == "?") {
+                std::cout << "Usage: <program> [<options>] [keyword1] [keyword2] ..." << std::endl;
+                std::cout << "    -h, --help, -?:           Displays this message" << std::endl;
+                std::cout << "    -v, --verbose:            Show verbose output" << std::endl;
+                std::cout << "        --discover_tests:     Output test details" << std::endl;
+                std::cout << "        --adapter_info:       Output additional details for test adapters" << std::endl;
+                std::cout << "        --reporter=<name>:    Add a reporter (console, junit or json)" << std::endl;
+                std::cout << "        --out=<file>:         Write the preceding reporter to <file> instead of stdout" << std::endl;
+                std::cout << "        --async_logging:      Write reports from a background thread" << std::endl;
+                std::cout << "        --isolate:            Run each test case in a forked child process" << std::endl;
+                std::cout << "        --async_limit=<n>:    Run at most <n> async test cases together (default 64)" << std::endl;
+                std::cout << "    -j, --jobs=<count>:       Run up to <count> test cases in parallel (0: one per core)" << std::endl;
+                std::cout << "        --coordinator=<addr>: Hand out test cases to workers that connect to <addr>" << std::endl;
+                std::cout << "        --workers=<count>:    Start <count> local worker processes for the coordinator" << std::endl;
+                std::cout << "        --worker=<addr>:      Run the test cases handed out by the coordinator at <addr>" << std::endl;
+                std::cout << "        --cache=<file>:       Skip test cases that passed with the same fingerprint, recorded in <file>" << std::endl;
+                std::cout << "        --cache_key=<value>:  Add <value> (e.g. a hash of the test data) to every fingerprint" << std::endl;
+                std::cout << "        --no_cache:           Run every test case, but still update the --cache file" << std::endl;
+                std::cout << "        --capture:            Report the stdout and stderr output of failed test cases" << std::endl;
+                std::cout << "        --capture_limit=<n>:  Capture at most <n> bytes per test case (default 1M)" << std::endl;
+                std::cout << "        --snapshot_dir=<dir>: Read and write snapshots in <dir> (default: snapshots)" << std::endl;
+                std::cout << "        --update_snapshots:   Rewrite snapshots that are missing or differ" << std::endl;
+                std::cout << "        --data_limit=<n>:     Keep at most <n> bytes of unused TEST_DATA files mapped (default 512M)" << std::endl;
+                std::cout << "        --trace=<file>:       Write a timeline of the run to <file> as Chrome trace events" << std::endl;
+                std::cout << "        --test_list=<file>:   Also run the test cases named in <file>, one per line (-: stdin)" << std::endl;
+                return false;
+            }
+
+            if (option_name == "v" || option_name == "-verbose") {
+                Verbose = true;
+                continue;
+            }
+
+            if (option_name == "-discover_tests") {
+                DiscoveryMode = true;
+                continue;
+            }
+
+            if (option_name == "-adapter_info") {
+                AdapterInfo = true;
+                continue;
+            }
+
+            if (option_name == "-async_logging") {
+                AsyncLogging = true;
+                continue;
+            }
+
+            if (option_name == "-isolate") {
+#if defined(CPPUTF_HAS_FORK)
+                Isolate = true;
+                continue;
+#else
+                std::cerr << "Test isolation is not supported on this platform" << std::endl;
+                return false;
+#endif
+            }
+
+            if (option_name == "j" || option_name == "-jobs") {
+                auto value = take_value();
+                if (!value) {
+                    return false;
+                }
+                size_t jobs = 0;
+                auto end = value->data() + value->size();
+                auto [ptr, error] = std::from_chars(value->data(), end, jobs);
+                if (error != std::errc() || ptr != end) {
+                    std::cerr << "Invalid job count: " << *value << std::endl;
+                    return false;
+                }
+                if (jobs > MaxJobs) {
+                    std::cerr << "Invalid job count: " << *value << " (at most " << MaxJobs << ")" << std::endl;
                     return false;
                 }
 
-                if (option_name == "v" || option_name == "-verbose") {
-                    Verbose = true;
-                    continue;
+                Jobs = (jobs == 0) ? std::max(1u, std::thread::hardware_concurrency()) : jobs;
+                continue;
+            }
+
+            if (option_name == "-coordinator" || option_name == "-worker" || option_name == "-workers") {
+#if defined(CPPUTF_HAS_FORK)
+                auto value = take_value();
+                if (!value) {
+                    return false;
+                }
+                if (value->empty()) {
+                    std::cerr << "Missing value for option: " << option_arg << std::endl;
+                    return false;
                 }
 
-                if (option_name == "-discover_tests") {
-                    DiscoveryMode = true;
-                    continue;
+                if (option_name == "-coordinator") {
+                    Coordinator = *value;
+                } else if (option_name == "-worker") {
+                    Worker = *value;
+                } else {
+                    auto end = value->data() + value->size();
+                    if (std::from_chars(value->data(), end, LocalWorkers).ptr != end || LocalWorkers == 0) {
+                        std::cerr << "Invalid worker count: " << *value << std::endl;
+                        return false;
+                    }
                 }
+                continue;
+#else
+                std::cerr << "Distributed runs are not supported on this platform" << std::endl;
+                return false;
+#endif
+            }
 
-                if (option_name == "-adapter_info") {
-                    AdapterInfo = true;
-                    continue;
+            if (option_name == "-cache" || option_name == "-cache_key") {
+#if defined(CPPUTF_HAS_RESULT_CACHE)
+                auto value = take_value();
+                if (!value) {
+                    return false;
+                }
+                if (value->empty() && option_name == "-cache") {
+                    std::cerr << "Missing value for option: " << option_arg << std::endl;
+                    return false;
                 }
 
-                // Unknown option
-                std::cerr << "Unknown option: " << option_name << std::endl;
+                (option_name == "-cache" ? CacheFile : CacheKey) = *value;
+                continue;
+#else
+                std::cerr << "Result caching is not supported on this platform" << std::endl;
                 return false;
+#endif
             }
 
-            return true;
+            if (option_name == "-no_cache") {
+                NoCache = true;
+                continue;
+            }
+
+            if (option_name == "-capture" || option_name == "-capture_limit") {
+#if defined(CPPUTF_HAS_CAPTURE)
+                if (option_name == "-capture_limit") {
+                    auto limit = take_size();
+                    if (!option_value) {
+                        return false;
+                    }
+                    if (!limit || *limit == 0) {
+                        std::cerr << "Invalid capture limit: " << *option_value << std::endl;
+                        return false;
+                    }
+                    CaptureLimit = *limit;
+                }
+                Capture = true;
+                continue;
+#else
+                std::cerr << "Output capture is not supported on this platform" << std::endl;
+                return false;
+#endif
+            }
+
+            if (option_name == "-update_snapshots") {
+                UpdateSnapshots = true;
+                continue;
+            }
+
+            if (option_name == "-snapshot_dir") {
+                auto directory = take_value();
+                if (!directory) {
+                    return false;
+                }
+                if (directory->empty()) {
+                    std::cerr << "Missing directory for option: " << option_arg << std::endl;
+                    return false;
+                }
+
+                SnapshotDirectory = *directory;
+                continue;
+            }
+
+            if (option_name == "-async_limit") {
+                auto value = take_value();
+                if (!value) {
+                    return false;
+                }
+                size_t limit = 0;
+                auto end = value->data() + value->size();
+                auto [ptr, error] = std::from_chars(value->data(), end, limit);
+                if (error != std::errc() || ptr != end || limit == 0) {
+                    std::cerr << "Invalid async limit: " << *value << std::endl;
+                    return false;
+                }
+
+                AsyncLimit = limit;
+                continue;
+            }
+
+            if (option_name == "-data_limit") {
+                auto limit = take_size();
+                if (!option_value) {
+                    return false;
+                }
+                if (!limit) {
+                    std::cerr << "Invalid test data limit: " << *option_value << std::endl;
+                    return false;
+                }
+
+                TestDataLimit = *limit;
+                continue;
+            }
+
+            if (option_name == "-trace") {
+                auto file = take_value();
+                if (!file) {
+                    return false;
+                }
+                if (file->empty()) {
+                    std::cerr << "Missing file name for option: " << option_arg << std::endl;
+                    return false;
+                }
+
+                TraceFile = *file;
+                continue;
+            }
+
+            if (option_name == "-test_list") {
+                auto file = take_value();
+                if (!file) {
+                    return false;
+                }
+                if (file->empty()) {
+                    std::cerr << "Missing file name for option: " << option_arg << std::endl;
+                    return false;
+                }
+                if (SelectedTests) {
+                    std::cerr << "Only one test list can be given" << std::endl;
+                    return false;
+                }
+
+                if (!LoadTestList(*file)) {
+                    std::cerr << "Unable to read test list: " << *file << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            if (option_name == "-reporter") {
+                auto name = take_value();
+                if (!name) {
+                    return false;
+                }
+                if (*name != "console" && *name != "junit" && *name != "json") {
+                    std::cerr << "Unknown reporter: " << *name << std::endl;
+                    return false;
+                }
+
+                Reporters.push_back({ *name, {} });
+                continue;
+            }
+
+            if (option_name == "-out") {
+                auto file = take_value();
+                if (!file) {
+                    return false;
+                }
+                if (file->empty()) {
+                    std::cerr << "Missing file name for option: " << option_arg << std::endl;
+                    return false;
+                }
+
+                if (Reporters.empty()) {
+                    // No reporter named yet.  Redirect the default console output.
+                    Reporters.push_back({ "console", {} });
+                }
+                if (!Reporters.back().OutputFile.empty()) {
+                    std::cerr << "Multiple output files for reporter: " << Reporters.back().Name << std::endl;
+                    return false;
+                }
+
+                Reporters.back().OutputFile = *file;
+                continue;
+            }
+
+            // Unknown option
+            std::cerr << "Unknown option: " << option_arg << std::endl;
+            return false;
         }
-    };
+
+        size_t stdout_reporters = 0;
+        for (auto& reporter : Reporters) {
+            if (reporter.OutputFile.empty()) {
+                stdout_reporters++;
+            }
+        }
+        if (stdout_reporters > 1) {
+            std::cerr << "Only one reporter can write to stdout.  Use --out to redirect the others." << std::endl;
+            return false;
+        }
+
+        if (!Worker.empty() && (!Coordinator.empty() || LocalWorkers > 0)) {
+            std::cerr << "A worker cannot also be a coordinator" << std::endl;
+            return false;
+        }
+
+        // Threads share stdout and stderr, so only test cases in their own process can be captured in parallel.
+        if (Capture && Jobs > 1 && !Isolate) {
+            std::cerr << "Capturing output with --jobs requires --isolate" << std::endl;
+            return false;
+        }
+        if (Capture && AsyncLogging) {
+            std::cerr << "Capturing output cannot be combined with --async_logging" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+#endif
 
     //--------------------------------------------------------------------------------------------------------
     //--------------------------------------------------------------------------------------------------------
@@ -105,6 +599,13 @@ namespace CppUnitTestFramework {
         virtual void EnterTest(const std::string_view& name) = 0;
         virtual void ExitTest(bool failed) = 0;
 
+        // A test case that was not run because it passed last time with the same fingerprint (see --cache).
+        // Counted as a pass.
+        virtual void CachedTest(const std::string_view& name) {
+            EnterTest(name);
+            ExitTest(false);
+        }
+
         virtual void SkipSection(const std::string_view& name) = 0;
         virtual void PushSection(const std::string_view& name) = 0;
         virtual void PopSection() = 0;
@@ -115,33 +616,67 @@ namespace CppUnitTestFramework {
             const std::string_view& message
         ) = 0;
         virtual void UnhandledException(const std::string_view& message) = 0;
+
+        // The stdout and stderr output of the current test case, reported before ExitTest() when it failed or
+        // in verbose mode (see --capture).  [truncated] is set if the output exceeded the capture limit.
+        virtual void TestOutput(const std::string_view& /*output*/, bool /*truncated*/) {}
+
+        // A measurement taken by the current test case, such as the throughput of a STRESS_TEST.  Reported
+        // before ExitTest().
+        virtual void TestMetric(const std::string_view& /*name*/, double /*value*/) {}
+
+        // Writes out any output held in a buffer, such as that of an --out file, so that it survives the
+        // process being killed.
+        virtual void Flush() {}
     };
     using ILoggerPtr = std::shared_ptr<ILogger>;
 
     //--------------------------------------------------------------------------------------------------------
 
+    using OutputStreamPtr = std::shared_ptr<std::ostream>;
+
+    OutputStreamPtr StandardOutput();
+
+    // Builds the logger described by the --reporter and --out options.  Returns nullptr if an output file
+    // could not be opened.
+    ILoggerPtr CreateLogger(const RunOptions* options);
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE OutputStreamPtr StandardOutput() {
+        // Non-owning.  std::cout outlives every logger.
+        return OutputStreamPtr(&std::cout, [](std::ostream*) {});
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
     struct ConsoleLogger :
         ILogger
     {
         static ILoggerPtr Create(const RunOptions* options) {
-            return std::unique_ptr<ConsoleLogger>{ new ConsoleLogger(options) };
+            return Create(options, StandardOutput());
+        }
+        static ILoggerPtr Create(const RunOptions* options, OutputStreamPtr stream) {
+            return std::unique_ptr<ConsoleLogger>{ new ConsoleLogger(options, std::move(stream)) };
         }
 
         virtual ~ConsoleLogger() = default;
 
         void BeginRun(size_t test_count) override {
-            std::cout << "Running " << test_count << " test cases..." << std::endl;
+            *m_stream << "Running " << test_count << " test cases..." << std::endl;
         }
         void EndRun(size_t pass_count, size_t fail_count, size_t skip_count) override {
-            std::cout << "Complete." << std::endl;
-            std::cout << "    Passed:  " << pass_count << std::endl;
-            std::cout << "    Failed:  " << fail_count << std::endl;
-            std::cout << "    Skipped: " << skip_count << std::endl;
+            *m_stream << "Complete." << std::endl;
+            *m_stream << "    Passed:  " << pass_count << std::endl;
+            *m_stream << "    Failed:  " << fail_count << std::endl;
+            *m_stream << "    Skipped: " << skip_count << std::endl;
+        }
+        void Flush() override {
+            m_stream->flush();
         }
 
         void SkipTest(const std::string_view& name) override {
             m_test_log.clear();
-            m_test_log << "Skip: " << name.data() << std::endl;
+            m_test_log << "Skip: " << name << std::endl;
             
             if (m_run_options->Verbose) {
                 FlushLog();
@@ -149,7 +684,7 @@ namespace CppUnitTestFramework {
         }
         void EnterTest(const std::string_view& name) override {
             m_test_log = std::stringstream();
-            m_test_log << "Test: " << name.data() << std::endl;
+            m_test_log << "Test: " << name << std::endl;
             m_indent_level++;
 
             if (m_run_options->Verbose) {
@@ -172,16 +707,28 @@ namespace CppUnitTestFramework {
                 FlushLog();
             }
         }
+        void CachedTest(const std::string_view& name) override {
+            m_test_log = std::stringstream();
+            m_test_log << "Test: " << name << std::endl;
+            m_test_log << "    [Cached]" << std::endl;
+            if (m_run_options->AdapterInfo) {
+                m_test_log << "Test Complete: passed" << std::endl;
+            }
+
+            if (m_run_options->Verbose) {
+                FlushLog();
+            }
+        }
 
         void SkipSection(const std::string_view& name) override {
-            Indent() << "[Skipped] " << name.data() << std::endl;
+            Indent() << "[Skipped] " << name << std::endl;
 
             if (m_run_options->Verbose) {
                 FlushLog();
             }
         }
         void PushSection(const std::string_view& name) override {
-            Indent() << name.data() << std::endl;
+            Indent() << name << std::endl;
             m_indent_level++;
 
             if (m_run_options->Verbose) {
@@ -208,14 +755,41 @@ namespace CppUnitTestFramework {
             case AssertType::Continue: log << "CHECK"; break;
             }
 
-            log << ": " << message.data() << std::endl;
+            log << ": " << message << std::endl;
             
             if (m_run_options->Verbose) {
                 FlushLog();
             }
         }
         void UnhandledException(const std::string_view& message) override {
-            Indent() << "Fail: " << message.data() << std::endl;
+            Indent() << "Fail: " << message << std::endl;
+
+            if (m_run_options->Verbose) {
+                FlushLog();
+            }
+        }
+
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            // Indented beneath the test case so that test adapters take it as part of the result.
+            Indent() << "Output:" << std::endl;
+            m_indent_level++;
+            for (size_t begin = 0; begin < output.size();) {
+                auto end = std::min(output.find('\n', begin), output.size());
+                Indent() << output.substr(begin, end - begin) << std::endl;
+                begin = end + 1;
+            }
+            if (truncated) {
+                Indent() << "[Truncated]" << std::endl;
+            }
+            m_indent_level--;
+
+            if (m_run_options->Verbose) {
+                FlushLog();
+            }
+        }
+
+        void TestMetric(const std::string_view& name, double value) override {
+            Indent() << "Metric: " << name << " = " << value << std::endl;
 
             if (m_run_options->Verbose) {
                 FlushLog();
@@ -223,8 +797,9 @@ namespace CppUnitTestFramework {
         }
 
     private:
-        ConsoleLogger(const RunOptions* run_options)
-          : m_run_options(run_options)
+        ConsoleLogger(const RunOptions* run_options, OutputStreamPtr stream)
+          : m_run_options(run_options),
+            m_stream(std::move(stream))
         {}
 
         std::ostream& Indent() {
@@ -235,203 +810,5919 @@ namespace CppUnitTestFramework {
         }
 
         void FlushLog() {
-            std::cout << m_test_log.str().c_str();
+            *m_stream << m_test_log.str();
             m_test_log = std::stringstream();
         }
 
     private:
         const RunOptions*const m_run_options;
+        OutputStreamPtr m_stream;
         size_t m_indent_level = 0;
         std::stringstream m_test_log;
     };
 
     //--------------------------------------------------------------------------------------------------------
-    //--------------------------------------------------------------------------------------------------------
-    //--------------------------------------------------------------------------------------------------------
-
-    struct TestRegistry {
-    private:
-        using TestCallback = std::function<bool (const ILoggerPtr& logger)>;
-        struct TestDetails {
-            std::string_view Name;
-            std::string_view SourceFile;
-            size_t SourceLine;
-            std::vector<std::string_view> Tags;
-            TestCallback Callback;
-        };
 
-    public:
-        template <typename TTestCase>
-        struct AutoReg {
-            AutoReg() {
-                TestRegistry::Add<TTestCase>();
-            }
-        };
+    struct JUnitLogger :
+        ILogger
+    {
+        static ILoggerPtr Create(OutputStreamPtr stream) {
+            return std::unique_ptr<JUnitLogger>{ new JUnitLogger(std::move(stream)) };
+        }
 
-    public:
-        template <typename TTestCase>
-        static void Add() {
-            TestDetails details;
-            details.Name = TTestCase::Name;
-            details.SourceFile = TTestCase::SourceFile;
-            details.SourceLine = TTestCase::SourceLine;
-            details.Tags.assign(std::begin(TTestCase::Tags), std::end(TTestCase::Tags));
-            details.Callback = [](const auto&... args) -> bool {
-                TTestCase test_case(args...);
-                test_case.Run();
-                return test_case.HaveChecksFailed();
-            };
+        virtual ~JUnitLogger() = default;
 
-            GetTestVector().push_back(std::move(details));
+        void BeginRun(size_t test_count) override {
+            // The document is streamed, so only the up-front test count can be written as an attribute.
+            // Consumers derive the failure and skip counts from the <testcase> elements.
+            *m_stream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+            *m_stream << "<testsuites tests=\"" << test_count << "\">\n";
+            *m_stream << "  <testsuite name=\"CppUnitTestFramework\" tests=\"" << test_count << "\">\n";
+        }
+        void EndRun(size_t /*pass_count*/, size_t /*fail_count*/, size_t /*skip_count*/) override {
+            *m_stream << "  </testsuite>\n";
+            *m_stream << "</testsuites>\n";
+            m_stream->flush();
+        }
+        void Flush() override {
+            m_stream->flush();
         }
 
-        static bool Run(const RunOptions* options, const ILoggerPtr& logger) {
-            const auto& all_test_cases = GetTestVector();
+        void SkipTest(const std::string_view& name) override {
+            WriteTestCaseOpen(name, std::nullopt);
+            *m_stream << "      <skipped/>\n";
+            *m_stream << "    </testcase>\n";
+        }
+        void EnterTest(const std::string_view& name) override {
+            m_test_name = name;
+            m_test_start = std::chrono::steady_clock::now();
+            m_test_body.clear();
+            m_test_output.clear();
+            m_test_properties.clear();
+            m_sections.clear();
+        }
+        void ExitTest(bool failed) override {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_test_start;
 
-            if (options->DiscoveryMode) {
-                for (auto& test_case : all_test_cases) {
-                    // Output the test name.
-                    std::cout << test_case.Name;
+            if (failed && m_test_body.empty()) {
+                m_test_body += "      <failure message=\"Test failed\"/>\n";
+            }
 
-                    if (options->AdapterInfo) {
-                        // Output the source file and line number.
-                        std::cout << "," << test_case.SourceFile << "," << test_case.SourceLine;
-                    }
+            // Only the current test case is ever held in memory.
+            WriteTestCaseOpen(m_test_name, elapsed.count());
+            if (!m_test_properties.empty()) {
+                *m_stream << "      <properties>" << m_test_properties << "</properties>\n";
+            }
+            *m_stream << m_test_body;
+            *m_stream << m_test_output;
+            *m_stream << "    </testcase>\n";
+        }
+        void CachedTest(const std::string_view& name) override {
+            WriteTestCaseOpen(name, std::nullopt);
+            *m_stream << "      <properties><property name=\"cached\" value=\"true\"/></properties>\n";
+            *m_stream << "    </testcase>\n";
+        }
 
-                    std::cout << std::endl;
-                }
-                return true;
+        void SkipSection(const std::string_view& /*name*/) override {}
+        void PushSection(const std::string_view& name) override {
+            m_sections.emplace_back(name);
+        }
+        void PopSection() override {
+            if (!m_sections.empty()) {
+                m_sections.pop_back();
             }
+        }
 
-            logger->BeginRun(all_test_cases.size());
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            const char* type_name = (type == AssertType::Throw) ? "REQUIRE" : "CHECK";
+
+            m_test_body += "      <failure type=\"";
+            m_test_body += type_name;
+            m_test_body += "\" message=\"";
+            AppendEscaped(m_test_body, message);
+            m_test_body += "\">";
+            AppendEscaped(m_test_body, location.SourceFile);
+            m_test_body += ":" + std::to_string(location.LineNumber);
+            for (auto& section : m_sections) {
+                m_test_body += "\n";
+                AppendEscaped(m_test_body, section);
+            }
+            m_test_body += "</failure>\n";
+        }
+        void UnhandledException(const std::string_view& message) override {
+            m_test_body += "      <error message=\"";
+            AppendEscaped(m_test_body, message);
+            m_test_body += "\"/>\n";
+        }
 
-            size_t pass_count = 0;
-            size_t fail_count = 0;
-            size_t skip_count = 0;
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            m_test_output = "      <system-out>";
+            AppendEscaped(m_test_output, output);
+            if (truncated) {
+                AppendEscaped(m_test_output, "\n[Truncated]");
+            }
+            m_test_output += "</system-out>\n";
+        }
 
-            for (auto& test_case : all_test_cases) {
-                if (!ShouldRunTest(options, test_case.Name, test_case.Tags)) {
-                    logger->SkipTest(test_case.Name);
-                    skip_count++;
-                    continue;
-                }
+        void TestMetric(const std::string_view& name, double value) override {
+            std::ostringstream ss;
+            ss << value;
+            m_test_properties += "<property name=\"";
+            AppendEscaped(m_test_properties, name);
+            m_test_properties += "\" value=\"" + ss.str() + "\"/>";
+        }
 
-                logger->EnterTest(test_case.Name);
+    private:
+        JUnitLogger(OutputStreamPtr stream)
+          : m_stream(std::move(stream))
+        {}
 
-                bool test_failed = true;
+        void WriteTestCaseOpen(const std::string_view& name, std::optional<double> seconds) {
+            // Test names are "<fixture>::<test>".  JUnit splits these into classname and name.
+            auto split = name.rfind("::");
+            auto class_name = (split == std::string_view::npos) ? std::string_view() : name.substr(0, split);
+            auto test_name = (split == std::string_view::npos) ? name : name.substr(split + 2);
+
+            std::string line = "    <testcase classname=\"";
+            AppendEscaped(line, class_name);
+            line += "\" name=\"";
+            AppendEscaped(line, test_name);
+            line += "\"";
+            if (seconds) {
+                std::ostringstream ss;
+                ss << std::fixed << std::setprecision(6) << *seconds;
+                line += " time=\"" + ss.str() + "\"";
+            }
+            line += ">\n";
+
+            *m_stream << line;
+        }
+
+        static void AppendEscaped(std::string& out, const std::string_view& text) {
+            for (char c : text) {
+                switch (c) {
+                case '&': out += "&amp;"; break;
+                case '<': out += "&lt;"; break;
+                case '>': out += "&gt;"; break;
+                case '"': out += "&quot;"; break;
+                case '\'': out += "&apos;"; break;
+                case '\n': out += "&#10;"; break;
+                case '\r': out += "&#13;"; break;
+                case '\t': out += "&#9;"; break;
+                default:
+                    // Other control characters are not permitted in XML 1.0.
+                    if (static_cast<unsigned char>(c) >= 0x20) {
+                        out += c;
+                    }
+                    break;
+                }
+            }
+        }
+
+    private:
+        OutputStreamPtr m_stream;
+        std::string m_test_name;
+        std::chrono::steady_clock::time_point m_test_start;
+        std::string m_test_body;
+        std::string m_test_output;
+        std::string m_test_properties;
+        std::vector<std::string> m_sections;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    struct JsonLogger :
+        ILogger
+    {
+        static ILoggerPtr Create(OutputStreamPtr stream) {
+            return std::unique_ptr<JsonLogger>{ new JsonLogger(std::move(stream)) };
+        }
+
+        virtual ~JsonLogger() = default;
+
+        void BeginRun(size_t test_count) override {
+            *m_stream << "{\n";
+            *m_stream << "  \"test_count\": " << test_count << ",\n";
+            *m_stream << "  \"tests\": [";
+            m_first_test = true;
+        }
+        void EndRun(size_t pass_count, size_t fail_count, size_t skip_count) override {
+            *m_stream << "\n  ],\n";
+            *m_stream << "  \"passed\": " << pass_count << ",\n";
+            *m_stream << "  \"failed\": " << fail_count << ",\n";
+            *m_stream << "  \"skipped\": " << skip_count << "\n";
+            *m_stream << "}\n";
+            m_stream->flush();
+        }
+        void Flush() override {
+            m_stream->flush();
+        }
+
+        void SkipTest(const std::string_view& name) override {
+            WriteTest(name, "skipped", std::nullopt);
+        }
+        void EnterTest(const std::string_view& name) override {
+            m_test_name = name;
+            m_test_start = std::chrono::steady_clock::now();
+            m_failures.clear();
+            m_output.clear();
+            m_metrics.clear();
+            m_sections.clear();
+        }
+        void ExitTest(bool failed) override {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_test_start;
+
+            // Only the current test case is ever held in memory.
+            WriteTest(m_test_name, failed ? "failed" : "passed", elapsed.count());
+        }
+        void CachedTest(const std::string_view& name) override {
+            WriteTest(name, "passed", std::nullopt, true);
+        }
+
+        void SkipSection(const std::string_view& /*name*/) override {}
+        void PushSection(const std::string_view& name) override {
+            m_sections.emplace_back(name);
+        }
+        void PopSection() override {
+            if (!m_sections.empty()) {
+                m_sections.pop_back();
+            }
+        }
+
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            BeginFailure();
+            m_failures += "{ \"type\": \"";
+            m_failures += (type == AssertType::Throw) ? "REQUIRE" : "CHECK";
+            m_failures += "\", \"file\": ";
+            AppendQuoted(m_failures, location.SourceFile);
+            m_failures += ", \"line\": " + std::to_string(location.LineNumber);
+            m_failures += ", \"sections\": [";
+            for (size_t i = 0; i != m_sections.size(); ++i) {
+                if (i != 0) {
+                    m_failures += ", ";
+                }
+                AppendQuoted(m_failures, m_sections[i]);
+            }
+            m_failures += "], \"message\": ";
+            AppendQuoted(m_failures, message);
+            m_failures += " }";
+        }
+        void UnhandledException(const std::string_view& message) override {
+            BeginFailure();
+            m_failures += "{ \"type\": \"exception\", \"message\": ";
+            AppendQuoted(m_failures, message);
+            m_failures += " }";
+        }
+
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            m_output = ", \"output\": ";
+            AppendQuoted(m_output, output);
+            if (truncated) {
+                m_output += ", \"output_truncated\": true";
+            }
+        }
+
+        void TestMetric(const std::string_view& name, double value) override {
+            // JSON has no representation for infinities or NaN.
+            std::ostringstream ss;
+            if (std::isfinite(value)) {
+                ss << value;
+            } else {
+                ss << "null";
+            }
+            m_metrics += m_metrics.empty() ? ", \"metrics\": { " : ", ";
+            AppendQuoted(m_metrics, name);
+            m_metrics += ": " + ss.str();
+        }
+
+        // Appends [text] to [out] as a quoted JSON string.
+        static void AppendQuoted(std::string& out, const std::string_view& text) {
+            out += '"';
+            for (char c : text) {
+                switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        static constexpr char s_hex[] = "0123456789abcdef";
+                        out += "\\u00";
+                        out += s_hex[(c >> 4) & 0xF];
+                        out += s_hex[c & 0xF];
+                    } else {
+                        out += c;
+                    }
+                    break;
+                }
+            }
+            out += '"';
+        }
+
+    private:
+        JsonLogger(OutputStreamPtr stream)
+          : m_stream(std::move(stream))
+        {}
+
+        void BeginFailure() {
+            m_failures += m_failures.empty() ? "\n        " : ",\n        ";
+        }
+
+        void WriteTest(const std::string_view& name, const char* status, std::optional<double> seconds, bool cached = false) {
+            std::string entry = m_first_test ? "\n    { \"name\": " : ",\n    { \"name\": ";
+            m_first_test = false;
+
+            AppendQuoted(entry, name);
+            entry += ", \"status\": \"";
+            entry += status;
+            entry += "\"";
+            if (cached) {
+                entry += ", \"cached\": true";
+            }
+            if (seconds) {
+                std::ostringstream ss;
+                ss << std::fixed << std::setprecision(6) << *seconds;
+                entry += ", \"duration\": " + ss.str();
+
+                entry += ", \"failures\": [";
+                entry += m_failures;
+                entry += m_failures.empty() ? "]" : "\n      ]";
+                entry += m_output;
+                if (!m_metrics.empty()) {
+                    entry += m_metrics + " }";
+                }
+            }
+            entry += " }";
+
+            *m_stream << entry;
+        }
+
+    private:
+        OutputStreamPtr m_stream;
+        bool m_first_test = true;
+        std::string m_test_name;
+        std::chrono::steady_clock::time_point m_test_start;
+        std::string m_failures;
+        std::string m_output;
+        std::string m_metrics;
+        std::vector<std::string> m_sections;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    struct MultiLogger :
+        ILogger
+    {
+        static ILoggerPtr Create(std::vector<ILoggerPtr> loggers) {
+            return std::unique_ptr<MultiLogger>{ new MultiLogger(std::move(loggers)) };
+        }
+
+        virtual ~MultiLogger() = default;
+
+        void BeginRun(size_t test_count) override {
+            for (auto& logger : m_loggers) { logger->BeginRun(test_count); }
+        }
+        void EndRun(size_t pass_count, size_t fail_count, size_t skip_count) override {
+            for (auto& logger : m_loggers) { logger->EndRun(pass_count, fail_count, skip_count); }
+        }
+
+        void SkipTest(const std::string_view& name) override {
+            for (auto& logger : m_loggers) { logger->SkipTest(name); }
+        }
+        void EnterTest(const std::string_view& name) override {
+            for (auto& logger : m_loggers) { logger->EnterTest(name); }
+        }
+        void ExitTest(bool failed) override {
+            for (auto& logger : m_loggers) { logger->ExitTest(failed); }
+        }
+        void CachedTest(const std::string_view& name) override {
+            for (auto& logger : m_loggers) { logger->CachedTest(name); }
+        }
+
+        void SkipSection(const std::string_view& name) override {
+            for (auto& logger : m_loggers) { logger->SkipSection(name); }
+        }
+        void PushSection(const std::string_view& name) override {
+            for (auto& logger : m_loggers) { logger->PushSection(name); }
+        }
+        void PopSection() override {
+            for (auto& logger : m_loggers) { logger->PopSection(); }
+        }
+
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            for (auto& logger : m_loggers) { logger->AssertFailed(type, location, message); }
+        }
+        void UnhandledException(const std::string_view& message) override {
+            for (auto& logger : m_loggers) { logger->UnhandledException(message); }
+        }
+
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            for (auto& logger : m_loggers) { logger->TestOutput(output, truncated); }
+        }
+        void TestMetric(const std::string_view& name, double value) override {
+            for (auto& logger : m_loggers) { logger->TestMetric(name, value); }
+        }
+
+        void Flush() override {
+            for (auto& logger : m_loggers) { logger->Flush(); }
+        }
+
+    private:
+        MultiLogger(std::vector<ILoggerPtr> loggers)
+          : m_loggers(std::move(loggers))
+        {}
+
+    private:
+        std::vector<ILoggerPtr> m_loggers;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Records the calls made while a test case runs so that they can be replayed on another logger once it
+    // completes.  Used to keep the output of parallel test cases from interleaving.
+    struct BufferedLogger :
+        ILogger
+    {
+        static std::shared_ptr<BufferedLogger> Create() {
+            return std::shared_ptr<BufferedLogger>{ new BufferedLogger() };
+        }
+
+        virtual ~BufferedLogger() = default;
+
+        void Replay(ILogger& logger) const {
+            for (auto& event : m_events) {
+                switch (event.Type) {
+                case EventType::SkipSection: logger.SkipSection(event.Text); break;
+                case EventType::PushSection: logger.PushSection(event.Text); break;
+                case EventType::PopSection: logger.PopSection(); break;
+                case EventType::AssertFailed:
+                    logger.AssertFailed(event.Assert, AssertLocation{ event.SourceFile, event.LineNumber }, event.Text);
+                    break;
+                case EventType::UnhandledException: logger.UnhandledException(event.Text); break;
+                case EventType::TestOutput: logger.TestOutput(event.Text, event.Truncated); break;
+                case EventType::TestMetric: logger.TestMetric(event.Text, event.Value); break;
+                }
+            }
+        }
+
+        void BeginRun(size_t /*test_count*/) override {}
+        void EndRun(size_t /*pass_count*/, size_t /*fail_count*/, size_t /*skip_count*/) override {}
+
+        void SkipTest(const std::string_view& /*name*/) override {}
+        void EnterTest(const std::string_view& /*name*/) override {}
+        void ExitTest(bool /*failed*/) override {}
+
+        void SkipSection(const std::string_view& name) override {
+            m_events.push_back({ EventType::SkipSection, AssertType::Continue, {}, 0, std::string(name) });
+        }
+        void PushSection(const std::string_view& name) override {
+            m_events.push_back({ EventType::PushSection, AssertType::Continue, {}, 0, std::string(name) });
+        }
+        void PopSection() override {
+            m_events.push_back({ EventType::PopSection, AssertType::Continue, {}, 0, {} });
+        }
+
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            m_events.push_back({ EventType::AssertFailed, type, location.SourceFile, location.LineNumber, std::string(message) });
+        }
+        void UnhandledException(const std::string_view& message) override {
+            m_events.push_back({ EventType::UnhandledException, AssertType::Continue, {}, 0, std::string(message) });
+        }
+
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            m_events.push_back({ EventType::TestOutput, AssertType::Continue, {}, 0, std::string(output), truncated });
+        }
+        void TestMetric(const std::string_view& name, double value) override {
+            m_events.push_back({ EventType::TestMetric, AssertType::Continue, {}, 0, std::string(name), false, value });
+        }
+
+    private:
+        BufferedLogger() = default;
+
+        enum class EventType {
+            SkipSection,
+            PushSection,
+            PopSection,
+            AssertFailed,
+            UnhandledException,
+            TestOutput,
+            TestMetric
+        };
+
+        struct Event {
+            EventType Type;
+            AssertType Assert;
+            std::string_view SourceFile;    // Always a __FILE__ literal
+            size_t LineNumber;
+            std::string Text;
+            bool Truncated = false;
+            double Value = 0;
+        };
+
+    private:
+        std::vector<Event> m_events;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Decorates another logger so that its output is produced on a background thread.  Events are copied
+    // into a fixed size ring buffer and the test thread only blocks when the ring is full.  All ILogger
+    // calls must come from a single thread.
+    struct AsyncLogger :
+        ILogger
+    {
+        static ILoggerPtr Create(ILoggerPtr sink, size_t capacity = 4096) {
+            return std::shared_ptr<AsyncLogger>{ new AsyncLogger(std::move(sink), capacity) };
+        }
+
+        virtual ~AsyncLogger() {
+            Flush();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_data_ready.notify_one();
+            m_thread.join();
+
+            AsyncLogger* self = this;
+            if (ActiveLogger().compare_exchange_strong(self, nullptr)) {
+                std::set_terminate(m_previous_terminate);
+                RestoreSignalHandlers();
+            }
+        }
+
+        // Blocks until every queued event has been written to the sink.  The background thread flushes the
+        // sink itself whenever it goes idle.
+        void Flush() override {
+            WaitForSpace([&]() { return m_head.load() == m_tail.load(std::memory_order_relaxed); });
+        }
+
+        // Flushes the logger that hooked std::terminate, if any.  Called before fork() so that the background
+        // thread is idle, and the child has no queued events.
+        static void FlushActive() {
+            if (auto logger = ActiveLogger().load()) {
+                logger->Flush();
+            }
+        }
+
+        // Called in a forked child, which has no background thread to wait for.  Restores the terminate and
+        // signal handlers that the active logger replaced, so that they don't wait for the thread.
+        static void DetachFromChild() {
+            if (auto logger = ActiveLogger().exchange(nullptr)) {
+                std::set_terminate(logger->m_previous_terminate);
+                logger->RestoreSignalHandlers();
+            }
+        }
+
+        void BeginRun(size_t test_count) override {
+            Push(EventType::BeginRun, [&](Event& event) { event.Counts[0] = test_count; });
+        }
+        void EndRun(size_t pass_count, size_t fail_count, size_t skip_count) override {
+            Push(EventType::EndRun, [&](Event& event) {
+                event.Counts[0] = pass_count;
+                event.Counts[1] = fail_count;
+                event.Counts[2] = skip_count;
+            });
+            Flush();
+        }
+
+        void SkipTest(const std::string_view& name) override {
+            Push(EventType::SkipTest, [&](Event& event) { event.Text.assign(name); });
+        }
+        void EnterTest(const std::string_view& name) override {
+            Push(EventType::EnterTest, [&](Event& event) { event.Text.assign(name); });
+        }
+        void ExitTest(bool failed) override {
+            Push(EventType::ExitTest, [&](Event& event) { event.Failed = failed; });
+        }
+        void CachedTest(const std::string_view& name) override {
+            Push(EventType::CachedTest, [&](Event& event) { event.Text.assign(name); });
+        }
+
+        void SkipSection(const std::string_view& name) override {
+            Push(EventType::SkipSection, [&](Event& event) { event.Text.assign(name); });
+        }
+        void PushSection(const std::string_view& name) override {
+            Push(EventType::PushSection, [&](Event& event) { event.Text.assign(name); });
+        }
+        void PopSection() override {
+            Push(EventType::PopSection, [](Event&) {});
+        }
+
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            Push(EventType::AssertFailed, [&](Event& event) {
+                event.Assert = type;
+                event.SourceFile.assign(location.SourceFile);
+                event.LineNumber = location.LineNumber;
+                event.Text.assign(message);
+            });
+        }
+        void UnhandledException(const std::string_view& message) override {
+            Push(EventType::UnhandledException, [&](Event& event) { event.Text.assign(message); });
+        }
+
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            Push(EventType::TestOutput, [&](Event& event) {
+                event.Text.assign(output);
+                event.Failed = truncated;
+            });
+        }
+        void TestMetric(const std::string_view& name, double value) override {
+            Push(EventType::TestMetric, [&](Event& event) {
+                event.Text.assign(name);
+                event.Value = value;
+            });
+        }
+
+    private:
+        enum class EventType {
+            BeginRun, EndRun,
+            SkipTest, EnterTest, ExitTest, CachedTest,
+            SkipSection, PushSection, PopSection,
+            AssertFailed, UnhandledException, TestOutput, TestMetric
+        };
+
+        struct Event {
+            EventType Type = EventType::PopSection;
+            size_t Counts[3] = {};
+            bool Failed = false;            // ExitTest's [failed], or TestOutput's [truncated]
+            AssertType Assert = AssertType::Continue;
+            std::string SourceFile;
+            size_t LineNumber = 0;
+            std::string Text;   // Slots are reused, so the string capacity is retained between events.
+            double Value = 0;
+        };
+
+    private:
+        AsyncLogger(ILoggerPtr sink, size_t capacity)
+          : m_sink(std::move(sink)),
+            m_ring(capacity > 0 ? capacity : 1)
+        {
+            m_thread = std::thread([this]() { Consume(); });
+
+            // Flush pending output if the process is about to terminate.
+            AsyncLogger* expected = nullptr;
+            if (ActiveLogger().compare_exchange_strong(expected, this)) {
+                m_previous_terminate = std::set_terminate(&OnTerminate);
+                InstallSignalHandlers();
+            }
+        }
+
+        template <typename TFill>
+        void Push(EventType type, const TFill& fill) {
+            auto tail = m_tail.load(std::memory_order_relaxed);
+            WaitForSpace([&]() { return tail - m_head.load() < m_ring.size(); });
+
+            auto& event = m_ring[tail % m_ring.size()];
+            event.Type = type;
+            fill(event);
+            m_tail.store(tail + 1);
+
+            if (m_consumer_waiting.load()) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_data_ready.notify_one();
+            }
+        }
+
+        template <typename TPredicate>
+        void WaitForSpace(const TPredicate& predicate) {
+            if (predicate()) {
+                // Fast path.  No locking required.
+                return;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_producer_waiting++;
+            m_space_ready.wait(lock, predicate);
+            m_producer_waiting--;
+        }
+
+        void Consume() {
+            for (;;) {
+                auto head = m_head.load(std::memory_order_relaxed);
+                if (head == m_tail.load(std::memory_order_acquire)) {
+                    // Idle.  Write out what the sink left in its stream buffers, which is lost if the process
+                    // dies of a signal.
+                    FlushSink();
+
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_consumer_waiting = true;
+                    m_data_ready.wait(lock, [&]() { return head != m_tail.load() || m_stopping; });
+                    m_consumer_waiting = false;
+
+                    if (head == m_tail.load()) {
+                        // Stopping and fully drained.
+                        return;
+                    }
+                    continue;
+                }
+
+                Dispatch(m_ring[head % m_ring.size()]);
+                m_head.store(head + 1);
+
+                if (m_producer_waiting.load() > 0) {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_space_ready.notify_all();
+                }
+            }
+        }
+
+        void Dispatch(const Event& event) {
+            try {
+                switch (event.Type) {
+                case EventType::BeginRun: m_sink->BeginRun(event.Counts[0]); break;
+                case EventType::EndRun: m_sink->EndRun(event.Counts[0], event.Counts[1], event.Counts[2]); break;
+                case EventType::SkipTest: m_sink->SkipTest(event.Text); break;
+                case EventType::EnterTest: m_sink->EnterTest(event.Text); break;
+                case EventType::ExitTest: m_sink->ExitTest(event.Failed); break;
+                case EventType::CachedTest: m_sink->CachedTest(event.Text); break;
+                case EventType::SkipSection: m_sink->SkipSection(event.Text); break;
+                case EventType::PushSection: m_sink->PushSection(event.Text); break;
+                case EventType::PopSection: m_sink->PopSection(); break;
+                case EventType::AssertFailed:
+                    m_sink->AssertFailed(event.Assert, AssertLocation{ event.SourceFile, event.LineNumber }, event.Text);
+                    break;
+                case EventType::UnhandledException: m_sink->UnhandledException(event.Text); break;
+                case EventType::TestOutput: m_sink->TestOutput(event.Text, event.Failed); break;
+                case EventType::TestMetric: m_sink->TestMetric(event.Text, event.Value); break;
+                }
+            } catch (const std::exception& e) {
+                // There is nowhere to report a failing sink except stderr.
+                std::cerr << "Logger error: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Logger error: <unstructured>" << std::endl;
+            }
+        }
+
+        void FlushSink() {
+            try {
+                m_sink->Flush();
+            } catch (const std::exception& e) {
+                std::cerr << "Logger error: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Logger error: <unstructured>" << std::endl;
+            }
+        }
+
+        static std::atomic<AsyncLogger*>& ActiveLogger() {
+            static std::atomic<AsyncLogger*> s_active_logger{ nullptr };
+            return s_active_logger;
+        }
+
+        [[noreturn]] static void OnTerminate() {
+            auto logger = ActiveLogger().load();
+            if (logger && std::this_thread::get_id() != logger->m_thread.get_id()) {
+                logger->Flush();
+            }
+
+            if (logger && logger->m_previous_terminate) {
+                logger->m_previous_terminate();
+            }
+            std::abort();
+        }
+
+#if defined(CPPUTF_HAS_SIGACTION)
+        static constexpr int FatalSignals[] = { SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV };
+
+        // The longest a fatal signal waits for the queued events to be written.
+        static constexpr std::chrono::seconds FatalSignalTimeout{ 2 };
+
+        void InstallSignalHandlers() {
+            struct sigaction action = {};
+            action.sa_sigaction = &OnFatalSignal;
+            action.sa_flags = SA_SIGINFO | SA_RESETHAND;
+            sigemptyset(&action.sa_mask);
+            for (size_t index = 0; index != std::size(FatalSignals); ++index) {
+                sigaction(FatalSignals[index], &action, &m_previous_actions[index]);
+            }
+        }
+
+        void RestoreSignalHandlers() {
+            for (size_t index = 0; index != std::size(FatalSignals); ++index) {
+                sigaction(FatalSignals[index], &m_previous_actions[index], nullptr);
+            }
+        }
+
+        // Gives the background thread a limited time to write the queued events and go idle, unless it is the
+        // thread that failed, then hands the signal to the handler that was replaced.  Only async-signal-safe
+        // calls are made: the queue is polled rather than waited for.
+        static void OnFatalSignal(int signal, siginfo_t* info, void* /*context*/) {
+            if (auto logger = ActiveLogger().exchange(nullptr)) {
+                if (std::this_thread::get_id() != logger->m_thread.get_id()) {
+                    auto deadline = std::chrono::steady_clock::now() + FatalSignalTimeout;
+                    auto idle = [&]() { return logger->m_head.load() == logger->m_tail.load() && logger->m_consumer_waiting.load(); };
+                    while (!idle() && std::chrono::steady_clock::now() < deadline) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }
+                logger->RestoreSignalHandlers();
+            }
+
+            // A fault raised by the CPU happens again when this returns.  A signal that was sent, such as by
+            // abort(), is sent again.
+            if (info->si_code <= 0) {
+                raise(signal);
+            }
+        }
+#else
+        void InstallSignalHandlers() {}
+        void RestoreSignalHandlers() {}
+#endif
+
+    private:
+        ILoggerPtr m_sink;
+        std::vector<Event> m_ring;
+        std::atomic<size_t> m_head{ 0 };    // Next event to be written to the sink
+        std::atomic<size_t> m_tail{ 0 };    // Next free slot
+
+        std::mutex m_mutex;
+        std::condition_variable m_data_ready;
+        std::condition_variable m_space_ready;
+        std::atomic<bool> m_consumer_waiting{ false };
+        std::atomic<int> m_producer_waiting{ 0 };   // The producer, and threads forking with FlushActive()
+        bool m_stopping = false;
+
+        std::terminate_handler m_previous_terminate = nullptr;
+#if defined(CPPUTF_HAS_SIGACTION)
+        struct sigaction m_previous_actions[std::size(FatalSignals)] = {};
+#endif
+        std::thread m_thread;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    CPPUTF_INLINE ILoggerPtr CreateLogger(const RunOptions* options) {
+        std::vector<ILoggerPtr> loggers;
+        if (options->Reporters.empty()) {
+            loggers.push_back(ConsoleLogger::Create(options));
+        }
+
+        for (auto& reporter : options->Reporters) {
+            OutputStreamPtr stream = StandardOutput();
+            if (!reporter.OutputFile.empty()) {
+                auto file = std::make_shared<std::ofstream>(reporter.OutputFile, std::ios::out | std::ios::trunc);
+                if (!file->is_open()) {
+                    std::cerr << "Unable to open output file: " << reporter.OutputFile << std::endl;
+                    return nullptr;
+                }
+                stream = std::move(file);
+            }
+
+            if (reporter.Name == "junit") {
+                loggers.push_back(JUnitLogger::Create(std::move(stream)));
+            } else if (reporter.Name == "json") {
+                loggers.push_back(JsonLogger::Create(std::move(stream)));
+            } else {
+                loggers.push_back(ConsoleLogger::Create(options, std::move(stream)));
+            }
+        }
+
+        auto logger = (loggers.size() == 1) ? loggers.front() : MultiLogger::Create(std::move(loggers));
+        if (options->AsyncLogging) {
+            logger = AsyncLogger::Create(std::move(logger));
+        }
+        return logger;
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Records a timeline of the run as Chrome trace events (see --trace), for chrome://tracing or Perfetto.
+    // Each worker thread or process records to a track of its own without locking, and the tracks are only
+    // written to the file once the run completes.
+    struct TraceRecorder;
+
+    // Records the test cases, sections and failures logged on it to a TraceRecorder track.  Used alongside the
+    // logger that reports them.
+    struct TraceLogger;
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    struct TraceRecorder {
+        struct Event {
+            char Phase;                                 // Trace event type: 'B'/'E', 'b'/'e' (async) or 'i'
+            std::chrono::steady_clock::time_point Time;
+            std::string Name;
+            std::string Detail;                         // Failure message, or the result of a test case
+            uint64_t Id;                                // Async test cases only
+        };
+
+        struct Track {
+            size_t Id;
+            std::string Name;
+            std::vector<Event> Events;
+        };
+
+        // Returns nullptr if [path] could not be opened.
+        static std::unique_ptr<TraceRecorder> Create(const std::string& path) {
+            std::unique_ptr<TraceRecorder> recorder{ new TraceRecorder() };
+            recorder->m_file.open(path, std::ios::out | std::ios::trunc);
+            if (!recorder->m_file.is_open()) {
+                return nullptr;
+            }
+            return recorder;
+        }
+
+        // The returned track must only be written to by one thread at a time.
+        Track& AddTrack(std::string name) {
+            std::lock_guard lock(m_mutex);
+            m_tracks.push_back({ m_tracks.size(), std::move(name), {} });
+            return m_tracks.back();
+        }
+
+        // Writes every track.  Must not be called while tracks are being written to.  Returns false on failure.
+        bool Write() {
+            auto& out = m_file;
+            out << "{\"traceEvents\":[\n";
+            out << std::fixed << std::setprecision(3);
+
+            bool first = true;
+            std::string line;
+            for (auto& track : m_tracks) {
+                line = first ? "" : ",\n";
+                first = false;
+                line += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(track.Id) + ",\"args\":{\"name\":";
+                JsonLogger::AppendQuoted(line, track.Name);
+                out << line << "}}";
+
+                for (auto& event : track.Events) {
+                    line = ",\n{\"name\":";
+                    JsonLogger::AppendQuoted(line, event.Name);
+                    line += ",\"ph\":\"";
+                    line += event.Phase;
+                    if (event.Phase == 'i') {
+                        line += "\",\"cat\":\"failure\",\"s\":\"t\"";    // A marker on the track
+                    } else {
+                        line += "\",\"cat\":\"test\"";
+                    }
+                    if (event.Phase == 'b' || event.Phase == 'e') {
+                        line += ",\"id\":" + std::to_string(event.Id);
+                    }
+                    line += ",\"pid\":1,\"tid\":" + std::to_string(track.Id) + ",\"ts\":";
+                    out << line << std::chrono::duration<double, std::micro>(event.Time - m_start).count();
+
+                    if (!event.Detail.empty()) {
+                        line = ",\"args\":{\"";
+                        line += (event.Phase == 'i') ? "message" : "result";
+                        line += "\":";
+                        JsonLogger::AppendQuoted(line, event.Detail);
+                        out << line << "}";
+                    }
+                    out << "}";
+                }
+            }
+
+            out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+            out.flush();
+            return out.good();
+        }
+
+    private:
+        TraceRecorder() = default;
+
+    private:
+        std::ofstream m_file;
+        std::chrono::steady_clock::time_point m_start = std::chrono::steady_clock::now();
+        std::mutex m_mutex;
+        std::deque<Track> m_tracks;     // Not moved as it grows
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    struct TraceLogger :
+        ILogger
+    {
+        // Test cases that run one after another on [track] are recorded as nested spans.  Those that overlap
+        // others on the same track, like async test cases, need an [async_id] of their own, and their sections
+        // are recorded as async spans with the same ID.
+        static std::shared_ptr<TraceLogger> Create(TraceRecorder::Track& track, std::optional<uint64_t> async_id = std::nullopt) {
+            return std::shared_ptr<TraceLogger>{ new TraceLogger(track, async_id) };
+        }
+
+        virtual ~TraceLogger() = default;
+
+        TraceRecorder::Track& Track() const {
+            return m_track;
+        }
+
+        void BeginRun(size_t /*test_count*/) override {}
+        void EndRun(size_t /*pass_count*/, size_t /*fail_count*/, size_t /*skip_count*/) override {}
+
+        void SkipTest(const std::string_view& /*name*/) override {}
+        void EnterTest(const std::string_view& name) override {
+            m_test_name = name;
+            Record(m_async_id ? 'b' : 'B', m_test_name);
+        }
+        void ExitTest(bool failed) override {
+            // A failed REQUIRE leaves its sections open.
+            while (!m_sections.empty()) {
+                PopSection();
+            }
+            Record(m_async_id ? 'e' : 'E', m_test_name, failed ? "failed" : "passed");
+        }
+        void CachedTest(const std::string_view& /*name*/) override {}
+
+        void SkipSection(const std::string_view& /*name*/) override {}
+        void PushSection(const std::string_view& name) override {
+            m_sections.emplace_back(name);
+            Record(m_async_id ? 'b' : 'B', name);
+        }
+        void PopSection() override {
+            if (!m_sections.empty()) {
+                // Async spans are matched by name as well as ID.
+                Record(m_async_id ? 'e' : 'E', m_async_id ? m_sections.back() : std::string_view());
+                m_sections.pop_back();
+            }
+        }
+
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            Record(
+                'i',
+                (type == AssertType::Throw) ? "REQUIRE failed" : "CHECK failed",
+                std::string(location.SourceFile) + "(" + std::to_string(location.LineNumber) + "): " + std::string(message)
+            );
+        }
+        void UnhandledException(const std::string_view& message) override {
+            Record('i', "Unhandled exception", message);
+        }
+
+    private:
+        TraceLogger(TraceRecorder::Track& track, std::optional<uint64_t> async_id)
+          : m_track(track),
+            m_async_id(async_id)
+        {}
+
+        void Record(char phase, const std::string_view& name, const std::string_view& detail = {}) {
+            m_track.Events.push_back({ phase, std::chrono::steady_clock::now(), std::string(name), std::string(detail), m_async_id.value_or(0) });
+        }
+
+    private:
+        TraceRecorder::Track& m_track;
+        std::optional<uint64_t> m_async_id;
+        std::string m_test_name;
+        std::vector<std::string> m_sections;
+    };
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    // A read-only view of a file's contents.  The file is memory-mapped where supported, otherwise it is read
+    // into memory.
+    struct MappedFile {
+        static std::shared_ptr<MappedFile> Open(const std::string& path) {
+            std::shared_ptr<MappedFile> file{ new MappedFile() };
+#if defined(CPPUTF_HAS_MMAP)
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return nullptr;
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+                close(fd);
+                return nullptr;
+            }
+
+            file->m_size = static_cast<size_t>(info.st_size);
+            if (file->m_size > 0) {
+                void* data = mmap(nullptr, file->m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED) {
+                    close(fd);
+                    return nullptr;
+                }
+                file->m_data = static_cast<const char*>(data);
+            }
+            close(fd);
+#else
+            std::ifstream stream(path, std::ios::binary);
+            if (!stream) {
+                return nullptr;
+            }
+            file->m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+            file->m_data = file->m_buffer.data();
+            file->m_size = file->m_buffer.size();
+#endif
+            return file;
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator = (const MappedFile&) = delete;
+
+        ~MappedFile() {
+#if defined(CPPUTF_HAS_MMAP)
+            if (m_data) {
+                munmap(const_cast<char*>(m_data), m_size);
+            }
+#endif
+        }
+
+        std::string_view Contents() const {
+            return std::string_view(m_data, m_size);
+        }
+
+    private:
+        MappedFile() = default;
+
+    private:
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+#if !defined(CPPUTF_HAS_MMAP)
+        std::string m_buffer;
+#endif
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    struct TestList {
+        // Returns nullptr if [path] can't be read.  A [path] of "-" reads stdin.
+        static std::shared_ptr<const TestList> Load(const std::string& path) {
+            std::shared_ptr<TestList> list{ new TestList() };
+            std::string_view contents;
+            if (path == "-") {
+                list->m_buffer.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+                contents = list->m_buffer;
+            } else {
+                list->m_file = MappedFile::Open(path);
+                if (!list->m_file) {
+                    return nullptr;
+                }
+                contents = list->m_file->Contents();
+            }
+
+            // The names are views of the contents, which the list keeps.  Blank lines are ignored, as are the
+            // '\r's of Windows line endings.
+            list->m_names.reserve(static_cast<size_t>(std::count(contents.begin(), contents.end(), '\n')) + 1);
+            while (!contents.empty()) {
+                auto end = std::min(contents.find('\n'), contents.size());
+                auto name = contents.substr(0, end);
+                contents.remove_prefix(std::min(end + 1, contents.size()));
+
+                if (!name.empty() && name.back() == '\r') {
+                    name.remove_suffix(1);
+                }
+                if (!name.empty()) {
+                    list->m_names.insert(name);
+                }
+            }
+            return list;
+        }
+
+        TestList(const TestList&) = delete;
+        TestList& operator = (const TestList&) = delete;
+
+        bool Contains(const std::string_view& test_name) const {
+            return m_names.count(test_name) != 0;
+        }
+
+        size_t Size() const {
+            return m_names.size();
+        }
+
+    private:
+        TestList() = default;
+
+    private:
+        std::shared_ptr<MappedFile> m_file;
+        std::string m_buffer;
+        std::unordered_set<std::string_view> m_names;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    CPPUTF_INLINE bool RunOptions::LoadTestList(const std::string& path) {
+        SelectedTests = TestList::Load(path);
+        return SelectedTests != nullptr;
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    namespace Snapshot {
+        struct Settings {
+            std::string Directory = "snapshots";
+            bool Update = false;
+        };
+
+        // Set from RunOptions by TestRegistry::Run.
+        inline Settings& CurrentSettings() {
+            static Settings s_settings;
+            return s_settings;
+        }
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        inline std::filesystem::path PathFor(std::string_view name) {
+            return std::filesystem::path(CurrentSettings().Directory) / std::filesystem::path(name);
+        }
+
+        // Replaces the snapshot in a single rename, so that readers never see a partially written file.
+        inline bool Write(const std::filesystem::path& path, std::string_view contents) {
+            std::error_code error;
+            std::filesystem::create_directories(path.parent_path(), error);
+
+            static std::atomic<uint64_t> s_counter{ 0 };
+            auto temp_path = path;
+            temp_path += ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "_" + std::to_string(s_counter++);
+            {
+                std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+                file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+                if (!file.flush()) {
+                    file.close();
+                    std::filesystem::remove(temp_path, error);
+                    return false;
+                }
+            }
+
+            std::filesystem::rename(temp_path, path, error);
+            if (error) {
+                std::filesystem::remove(temp_path, error);
+                return false;
+            }
+            return true;
+        }
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_RESULT_CACHE) && !defined(CPPUTF_DECLARATIONS_ONLY)
+    // Records the fingerprints of the test cases that passed, so that the next run can skip them while
+    // nothing they depend on has changed.  A fingerprint covers the test case name and tags, the --cache_key
+    // value, the contents of the files named by "cache_data:<path>" tags, and the loaded sections of the
+    // shared libraries.  When the executable kept its relocations (see CodeGraph) it also covers the code and
+    // data reachable from the test case's entry points, and from the executable's start-up code.  Otherwise
+    // it covers every loaded section of the executable.  The cache file holds one hexadecimal fingerprint
+    // per line.
+    struct ResultCache {
+        // [entry_points] are those of every registered test case.  The start-up code reaches them through the
+        // registration of the test cases, but only covers the registration itself.
+        explicit ResultCache(const RunOptions* options, const std::vector<uintptr_t>& entry_points = {})
+          : m_path(options->CacheFile),
+            m_graph(CodeGraph::Load())
+        {
+            if (m_graph) {
+                m_base = Hash(Hash(Hash(LibraryFingerprint(), options->CacheKey), "graph"), m_graph->StartupHash(entry_points, m_nodes));
+            } else {
+                m_base = Hash(BinaryFingerprint(), options->CacheKey);
+            }
+
+            std::ifstream file(m_path);
+            std::string line;
+            while (std::getline(file, line)) {
+                uint64_t fingerprint = 0;
+                auto end = line.data() + line.size();
+                if (std::from_chars(line.data(), end, fingerprint, 16).ptr == end && !line.empty()) {
+                    m_passed.insert(fingerprint);
+                }
+            }
+        }
+
+        // [entry_points] are the addresses of the functions that run the test case.  Without them, or if any
+        // cannot be found in the executable, the whole executable is covered instead.
+        uint64_t Fingerprint(
+            std::string_view name,
+            const std::vector<std::string_view>& tags,
+            const std::vector<uintptr_t>& entry_points = {}
+        ) {
+            constexpr std::string_view data_prefix = "cache_data:";
+
+            auto fingerprint = Hash(m_base, name);
+            if (m_graph) {
+                auto code = m_graph->ReachableHash(entry_points, m_nodes);
+                fingerprint = code ? Hash(fingerprint, *code) : Hash(fingerprint, ExecutableFingerprint());
+            }
+            for (auto& tag : tags) {
+                fingerprint = Hash(fingerprint, tag);
+                if (tag.substr(0, data_prefix.size()) == data_prefix) {
+                    // A missing file hashes differently to an empty one.
+                    auto file = MappedFile::Open(std::string(tag.substr(data_prefix.size())));
+                    fingerprint = file ? Hash(Hash(fingerprint, "+"), file->Contents()) : Hash(fingerprint, "-");
+                }
+            }
+            return fingerprint;
+        }
+
+        bool Passed(uint64_t fingerprint) const {
+            return m_passed.count(fingerprint) != 0;
+        }
+
+        // Replaces the cache file.  Returns false if it could not be written.
+        bool Save(const std::vector<uint64_t>& passed) const {
+            std::string contents;
+            char buffer[16];
+            for (auto fingerprint : passed) {
+                auto end = std::to_chars(std::begin(buffer), std::end(buffer), fingerprint, 16).ptr;
+                contents.append(buffer, end);
+                contents += '\n';
+            }
+            return Snapshot::Write(m_path, contents);
+        }
+
+        // FNV-1a over 8 byte words rather than bytes, so that hashing a large executable stays cheap.
+        static uint64_t Hash(uint64_t hash, std::string_view data) {
+            constexpr uint64_t prime = 0x100000001b3ull;
+            size_t index = 0;
+            for (; index + sizeof(uint64_t) <= data.size(); index += sizeof(uint64_t)) {
+                uint64_t word;
+                std::memcpy(&word, data.data() + index, sizeof(word));
+                hash = (hash ^ word) * prime;
+            }
+            for (; index != data.size(); ++index) {
+                hash = (hash ^ static_cast<unsigned char>(data[index])) * prime;
+            }
+            return (hash ^ data.size()) * prime;
+        }
+        static uint64_t Hash(uint64_t hash, uint64_t value) {
+            return Hash(hash, std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)));
+        }
+
+        // Hashes the sections that are loaded into memory (code, read-only data and initialized data) of the
+        // executable and of every shared library in the process when it is first called: those that the
+        // executable links to and any loaded with dlopen() by then.  Each object's sections are read from its
+        // file.  Debug information, symbols and the build ID are left out, so that a relink which only changes
+        // those still matches.  Objects without a file, such as the vDSO, are skipped.
+        static uint64_t BinaryFingerprint() {
+            return Hash(ExecutableFingerprint(), LibraryFingerprint());
+        }
+
+        // The same for the executable alone.
+        static uint64_t ExecutableFingerprint() {
+            return LoadedObjects().first;
+        }
+
+        // The same for the shared libraries alone.
+        static uint64_t LibraryFingerprint() {
+            return LoadedObjects().second;
+        }
+
+    private:
+        // The executable's symbols, linked by the relocations that the linker kept in it with --emit-relocs.
+        // Each node is the extent of a symbol, or a piece of anonymous data such as a string literal.
+        // A node's hash covers its bytes with the relocated fields masked out, and what each relocation
+        // refers to by name, so that code which only moved still hashes the same.  References within a
+        // section are resolved by the assembler and leave no relocation, so the executable must also be built
+        // with -ffunction-sections and -fdata-sections.  Only x86-64 is supported.
+        struct CodeGraph {
+            struct Region {
+                uint64_t Start;
+                uint64_t End;
+
+                bool operator<(const Region& other) const {
+                    return (Start != other.Start) ? (Start < other.Start) : (End < other.End);
+                }
+            };
+
+            struct Node {
+                uint64_t Hash;
+                std::vector<Region> Next;
+            };
+
+            using NodeMap = std::map<Region, Node>;
+
+            // Returns nullptr unless the executable is an x86-64 ELF file with a symbol table and the
+            // relocations of its code.
+            static std::unique_ptr<CodeGraph> Load() {
+                auto file = MappedFile::Open("/proc/self/exe");
+                if (!file) {
+                    return nullptr;
+                }
+
+                std::unique_ptr<CodeGraph> graph{ new CodeGraph() };
+                graph->m_file = std::move(file);
+                if (!graph->Parse()) {
+                    return nullptr;
+                }
+
+                // The run-time address of the executable's symbols.  The executable is the object without a name.
+                dl_iterate_phdr([](dl_phdr_info* info, size_t /*size*/, void* data) {
+                    if (info->dlpi_name == nullptr || info->dlpi_name[0] == '\0') {
+                        *static_cast<uint64_t*>(data) = info->dlpi_addr;
+                        return 1;
+                    }
+                    return 0;
+                }, &graph->m_load_address);
+                return graph;
+            }
+
+            // Hashes what the entry point and the static initializers reach, without entering [stops].
+            uint64_t StartupHash(const std::vector<uintptr_t>& stops, NodeMap& nodes) const {
+                std::vector<Region> roots{ RegionAt(m_entry) };
+                for (auto& section : m_sections) {
+                    if (section.sh_type == SHT_INIT_ARRAY || section.sh_type == SHT_PREINIT_ARRAY) {
+                        roots.push_back({ section.sh_addr, section.sh_addr + section.sh_size });
+                    }
+                }
+
+                std::set<uint64_t> stop_addresses;
+                for (auto address : stops) {
+                    if (auto region = SymbolAt(address - m_load_address)) {
+                        stop_addresses.insert(region->Start);
+                    }
+                }
+                return Reachable(roots, stop_addresses, nodes);
+            }
+
+            // Hashes what the functions at [entry_points] reach.  Returns nullopt if there are none, or one is
+            // not a symbol in the executable.
+            std::optional<uint64_t> ReachableHash(const std::vector<uintptr_t>& entry_points, NodeMap& nodes) const {
+                std::vector<Region> roots;
+                for (auto address : entry_points) {
+                    auto region = SymbolAt(address - m_load_address);
+                    if (!region) {
+                        return std::nullopt;
+                    }
+                    roots.push_back(*region);
+                }
+                if (roots.empty()) {
+                    return std::nullopt;
+                }
+                return Reachable(roots, {}, nodes);
+            }
+
+        private:
+            struct Symbol {
+                std::string_view Name;
+                uint64_t Value;
+                uint64_t Size;
+                unsigned char Type;
+                uint16_t SectionIndex;
+            };
+
+            struct Relocation {
+                uint64_t Offset;
+                uint32_t Type;
+                uint32_t Symbol;
+                int64_t Addend;
+            };
+
+            CodeGraph() = default;
+
+            bool Parse() {
+                auto contents = m_file->Contents();
+                if (contents.size() < sizeof(Elf64_Ehdr) || contents.compare(0, SELFMAG, ELFMAG) != 0 || contents[EI_CLASS] != ELFCLASS64) {
+                    return false;
+                }
+
+                Elf64_Ehdr header;
+                std::memcpy(&header, contents.data(), sizeof(header));
+                if (header.e_machine != EM_X86_64 || header.e_shentsize != sizeof(Elf64_Shdr)) {
+                    return false;
+                }
+                if (header.e_shoff + header.e_shnum * sizeof(Elf64_Shdr) > contents.size()) {
+                    return false;
+                }
+                m_entry = header.e_entry;
+                m_sections.resize(header.e_shnum);
+                std::memcpy(m_sections.data(), contents.data() + header.e_shoff, header.e_shnum * sizeof(Elf64_Shdr));
+                for (auto& section : m_sections) {
+                    if (section.sh_type != SHT_NOBITS && section.sh_offset + section.sh_size > contents.size()) {
+                        return false;
+                    }
+                }
+
+                // The symbol table.
+                bool has_code_relocations = false;
+                for (auto& section : m_sections) {
+                    if (section.sh_type == SHT_SYMTAB && section.sh_link < m_sections.size()) {
+                        auto& names = m_sections[section.sh_link];
+                        auto name_table = contents.substr(names.sh_offset, names.sh_size);
+                        for (size_t offset = 0; offset + sizeof(Elf64_Sym) <= section.sh_size; offset += sizeof(Elf64_Sym)) {
+                            Elf64_Sym symbol;
+                            std::memcpy(&symbol, contents.data() + section.sh_offset + offset, sizeof(symbol));
+                            auto name_end = name_table.find('\0', symbol.st_name);
+                            m_symbols.push_back({
+                                (symbol.st_name < name_table.size()) ? name_table.substr(symbol.st_name, name_end - symbol.st_name) : std::string_view(),
+                                symbol.st_value,
+                                symbol.st_size,
+                                static_cast<unsigned char>(ELF64_ST_TYPE(symbol.st_info)),
+                                symbol.st_shndx
+                            });
+                        }
+                    }
+                }
+
+                // The relocations that the linker kept.  Those in loaded sections are for the dynamic linker.
+                for (auto& section : m_sections) {
+                    if (section.sh_type != SHT_RELA || (section.sh_flags & SHF_ALLOC) != 0 || section.sh_info >= m_sections.size()) {
+                        continue;
+                    }
+                    auto& target = m_sections[section.sh_info];
+                    if ((target.sh_flags & SHF_ALLOC) == 0) {
+                        continue;
+                    }
+                    has_code_relocations |= (target.sh_flags & SHF_EXECINSTR) != 0;
+                    for (size_t offset = 0; offset + sizeof(Elf64_Rela) <= section.sh_size; offset += sizeof(Elf64_Rela)) {
+                        Elf64_Rela relocation;
+                        std::memcpy(&relocation, contents.data() + section.sh_offset + offset, sizeof(relocation));
+                        auto type = static_cast<uint32_t>(ELF64_R_TYPE(relocation.r_info));
+                        if (!FieldSize(type)) {
+                            return false;
+                        }
+                        m_relocations.push_back({
+                            relocation.r_offset,
+                            type,
+                            static_cast<uint32_t>(ELF64_R_SYM(relocation.r_info)),
+                            relocation.r_addend
+                        });
+                    }
+                }
+                if (m_symbols.empty() || !has_code_relocations) {
+                    return false;
+                }
+                std::sort(m_relocations.begin(), m_relocations.end(), [](auto& a, auto& b) { return a.Offset < b.Offset; });
+
+                // The extents of the sized symbols in loaded sections, without duplicates for aliases.
+                for (auto& symbol : m_symbols) {
+                    bool sized = symbol.Size > 0 && symbol.Type != STT_SECTION && symbol.Type != STT_TLS;
+                    if (sized && symbol.SectionIndex < m_sections.size() && (m_sections[symbol.SectionIndex].sh_flags & SHF_ALLOC) != 0) {
+                        m_extents.push_back({ symbol.Value, symbol.Value + symbol.Size });
+                    }
+                }
+                std::sort(m_extents.begin(), m_extents.end());
+                m_extents.erase(std::unique(m_extents.begin(), m_extents.end(), [](auto& a, auto& b) {
+                    return a.Start == b.Start && a.End == b.End;
+                }), m_extents.end());
+
+                // The addresses that relocations refer to without a sized symbol, such as string literals.  Each
+                // one starts a separate piece of anonymous data.
+                for (auto& relocation : m_relocations) {
+                    if (relocation.Symbol == 0 || relocation.Symbol >= m_symbols.size() || IsTls(relocation.Type)) {
+                        continue;
+                    }
+                    auto& symbol = m_symbols[relocation.Symbol];
+                    if (symbol.SectionIndex != SHN_UNDEF && (symbol.Type == STT_SECTION || symbol.Size == 0)) {
+                        m_labels.push_back(TargetAddress(relocation));
+                    }
+                }
+                std::sort(m_labels.begin(), m_labels.end());
+                m_labels.erase(std::unique(m_labels.begin(), m_labels.end()), m_labels.end());
+                return true;
+            }
+
+            // The size of the field that a relocation type patches, or nullopt for an unknown type.
+            static std::optional<uint64_t> FieldSize(uint32_t type) {
+                switch (type) {
+                case R_X86_64_NONE: case R_X86_64_TLSDESC_CALL:
+                    return 0;
+                case R_X86_64_8: case R_X86_64_PC8:
+                    return 1;
+                case R_X86_64_16: case R_X86_64_PC16:
+                    return 2;
+                case R_X86_64_PC32: case R_X86_64_GOT32: case R_X86_64_PLT32: case R_X86_64_GOTPCREL:
+                case R_X86_64_32: case R_X86_64_32S: case R_X86_64_TLSGD: case R_X86_64_TLSLD:
+                case R_X86_64_DTPOFF32: case R_X86_64_GOTTPOFF: case R_X86_64_TPOFF32: case R_X86_64_GOTPC32:
+                case R_X86_64_SIZE32: case R_X86_64_GOTPC32_TLSDESC: case R_X86_64_GOTPCRELX:
+                case R_X86_64_REX_GOTPCRELX:
+                    return 4;
+                case R_X86_64_64: case R_X86_64_DTPMOD64: case R_X86_64_DTPOFF64: case R_X86_64_TPOFF64:
+                case R_X86_64_PC64: case R_X86_64_GOTOFF64: case R_X86_64_SIZE64:
+                    return 8;
+                default:
+                    return std::nullopt;
+                }
+            }
+
+            // A relative field is taken from the end of the instruction, which is usually the end of the field.
+            static bool IsPcRelative(uint32_t type) {
+                switch (type) {
+                case R_X86_64_PC8: case R_X86_64_PC16: case R_X86_64_PC32: case R_X86_64_PLT32:
+                case R_X86_64_GOTPCREL: case R_X86_64_GOTPCRELX: case R_X86_64_REX_GOTPCRELX:
+                case R_X86_64_GOTPC32: case R_X86_64_PC64:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            static bool IsTls(uint32_t type) {
+                switch (type) {
+                case R_X86_64_DTPMOD64: case R_X86_64_DTPOFF64: case R_X86_64_TPOFF64: case R_X86_64_TLSGD:
+                case R_X86_64_TLSLD: case R_X86_64_DTPOFF32: case R_X86_64_GOTTPOFF: case R_X86_64_TPOFF32:
+                case R_X86_64_GOTPC32_TLSDESC: case R_X86_64_TLSDESC_CALL:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            const Elf64_Shdr* SectionAt(uint64_t address) const {
+                for (auto& section : m_sections) {
+                    if ((section.sh_flags & SHF_ALLOC) != 0 && address >= section.sh_addr && address < section.sh_addr + section.sh_size) {
+                        return &section;
+                    }
+                }
+                return nullptr;
+            }
+
+            // The extent of the symbol that holds [address].
+            std::optional<Region> SymbolAt(uint64_t address) const {
+                auto next = std::upper_bound(m_extents.begin(), m_extents.end(), Region{ address, UINT64_MAX });
+                while (next != m_extents.begin()) {
+                    --next;
+                    if (next->End > address) {
+                        return *next;
+                    }
+                    if (next->Start + (1 << 20) < address) {
+                        break;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            // The extent of the symbol that holds [address], or else the anonymous data from there up to the
+            // next symbol or address that a relocation refers to, and at most 4K.
+            Region RegionAt(uint64_t address) const {
+                if (auto symbol = SymbolAt(address)) {
+                    return *symbol;
+                }
+
+                auto section = SectionAt(address);
+                if (!section) {
+                    return { address, address };
+                }
+                auto end = std::min(address + 4096, section->sh_addr + section->sh_size);
+                auto next = std::upper_bound(m_extents.begin(), m_extents.end(), Region{ address, UINT64_MAX });
+                if (next != m_extents.end()) {
+                    end = std::min(end, std::max(next->Start, address + 1));
+                }
+                auto label = std::upper_bound(m_labels.begin(), m_labels.end(), address);
+                if (label != m_labels.end()) {
+                    end = std::min(end, *label);
+                }
+
+                // What follows a string literal can be padding or a string that nothing uses any more, so a string
+                // of at least 4 characters ends at its terminator.
+                if (section->sh_type != SHT_NOBITS) {
+                    auto contents = m_file->Contents().substr(section->sh_offset + (address - section->sh_addr), end - address);
+                    auto terminator = contents.find('\0');
+                    bool printable = std::all_of(contents.begin(), contents.begin() + std::min(terminator, contents.size()), [](char c) {
+                        auto byte = static_cast<unsigned char>(c);
+                        return byte >= 0x20 || byte == '\t' || byte == '\n' || byte == '\r';
+                    });
+                    if (terminator != std::string_view::npos && terminator >= 4 && printable) {
+                        end = address + terminator + 1;
+                    }
+                }
+                return { address, end };
+            }
+
+            // The bytes of [region] with the relocated fields zeroed.
+            std::string MaskedBytes(const Region& region) const {
+                auto section = SectionAt(region.Start);
+                if (!section || section->sh_type == SHT_NOBITS) {
+                    return std::string(region.End - region.Start, '\0');
+                }
+                auto end = std::min(region.End, section->sh_addr + section->sh_size);
+                std::string bytes{ m_file->Contents().substr(section->sh_offset + (region.Start - section->sh_addr), end - region.Start) };
+
+                auto first = std::lower_bound(m_relocations.begin(), m_relocations.end(), region.Start, [](auto& relocation, uint64_t offset) {
+                    return relocation.Offset < offset;
+                });
+                for (auto relocation = first; relocation != m_relocations.end() && relocation->Offset < end; ++relocation) {
+                    auto field_start = relocation->Offset - region.Start;
+                    auto field_end = std::min<uint64_t>(field_start + *FieldSize(relocation->Type), bytes.size());
+                    std::fill(bytes.begin() + field_start, bytes.begin() + field_end, '\0');
+                }
+                return bytes;
+            }
+
+            // The address that [relocation] refers to, taking a relative field from its end.
+            uint64_t TargetAddress(const Relocation& relocation) const {
+                auto address = m_symbols[relocation.Symbol].Value + static_cast<uint64_t>(relocation.Addend);
+                return address + (IsPcRelative(relocation.Type) ? *FieldSize(relocation.Type) : 0);
+            }
+
+            // Hashes what [relocation] refers to without its address, and adds the regions that it reaches.
+            uint64_t Target(const Relocation& relocation, std::vector<Region>& next) const {
+                auto addend = static_cast<uint64_t>(relocation.Addend);
+                if (relocation.Symbol == 0 || relocation.Symbol >= m_symbols.size()) {
+                    return ResultCache::Hash(ResultCache::Hash(0, "absolute"), addend);
+                }
+
+                auto& symbol = m_symbols[relocation.Symbol];
+                bool defined = symbol.SectionIndex != SHN_UNDEF && symbol.SectionIndex < m_sections.size();
+                if (IsTls(relocation.Type) || !defined) {
+                    // Thread-local data is addressed by its offset in the TLS block, so only its initial values
+                    // are hashed.  An undefined symbol is in a shared library, which is hashed as a whole.
+                    auto hash = ResultCache::Hash(ResultCache::Hash(0, symbol.Name), addend);
+                    if (defined && symbol.Type == STT_SECTION && m_sections[symbol.SectionIndex].sh_type != SHT_NOBITS) {
+                        auto& section = m_sections[symbol.SectionIndex];
+                        hash = ResultCache::Hash(hash, m_file->Contents().substr(section.sh_offset, section.sh_size));
+                    }
+                    return hash;
+                }
+
+                if (symbol.Type != STT_SECTION && symbol.Size > 0) {
+                    next.push_back({ symbol.Value, symbol.Value + symbol.Size });
+                    return ResultCache::Hash(ResultCache::Hash(0, symbol.Name), addend);
+                }
+
+                // A section symbol or a label: find what the address lands in.  A relative field can be followed
+                // by an immediate of up to 4 bytes, so that the address is up to 4 bytes short of the target.
+                auto address = TargetAddress(relocation);
+                auto hash = ResultCache::Hash(0, symbol.Name);
+                auto first = SymbolAt(address);
+                if (first) {
+                    hash = ResultCache::Hash(hash, address - first->Start);
+                }
+                for (uint64_t offset = 0; offset <= 4; ++offset) {
+                    auto region = RegionAt(address + offset);
+                    if (region.End == region.Start || (!next.empty() && next.back().Start == region.Start)) {
+                        continue;
+                    }
+                    next.push_back(region);
+                    if (!SymbolAt(address + offset)) {
+                        // Anonymous data has no name, so its contents stand in for one.
+                        hash = ResultCache::Hash(hash, MaskedBytes(region));
+                        break;
+                    }
+                }
+                return hash;
+            }
+
+            const Node& Visit(const Region& region, NodeMap& nodes) const {
+                auto found = nodes.find(region);
+                if (found != nodes.end()) {
+                    return found->second;
+                }
+
+                Node node;
+                node.Hash = ResultCache::Hash(0, MaskedBytes(region));
+                auto first = std::lower_bound(m_relocations.begin(), m_relocations.end(), region.Start, [](auto& relocation, uint64_t offset) {
+                    return relocation.Offset < offset;
+                });
+                for (auto relocation = first; relocation != m_relocations.end() && relocation->Offset < region.End; ++relocation) {
+                    node.Hash = ResultCache::Hash(node.Hash, relocation->Offset - region.Start);
+                    node.Hash = ResultCache::Hash(node.Hash, relocation->Type);
+                    node.Hash = ResultCache::Hash(node.Hash, Target(*relocation, node.Next));
+                }
+                return nodes.emplace(region, std::move(node)).first->second;
+            }
+
+            // Combines the hashes of every node reachable from [roots], in an order that doesn't depend on the
+            // layout.
+            uint64_t Reachable(const std::vector<Region>& roots, const std::set<uint64_t>& stops, NodeMap& nodes) const {
+                std::set<Region> visited(roots.begin(), roots.end());
+                std::vector<Region> pending(roots.begin(), roots.end());
+                std::vector<uint64_t> hashes;
+                while (!pending.empty()) {
+                    auto region = pending.back();
+                    pending.pop_back();
+
+                    auto& node = Visit(region, nodes);
+                    hashes.push_back(node.Hash);
+                    for (auto& next : node.Next) {
+                        if (stops.count(next.Start) == 0 && visited.insert(next).second) {
+                            pending.push_back(next);
+                        }
+                    }
+                }
+
+                std::sort(hashes.begin(), hashes.end());
+                uint64_t hash = 0xcbf29ce484222325ull;
+                for (auto node_hash : hashes) {
+                    hash = ResultCache::Hash(hash, node_hash);
+                }
+                return hash;
+            }
+
+            std::shared_ptr<MappedFile> m_file;
+            uint64_t m_entry = 0;
+            uint64_t m_load_address = 0;
+            std::vector<Elf64_Shdr> m_sections;
+            std::vector<Symbol> m_symbols;
+            std::vector<Relocation> m_relocations;
+            std::vector<Region> m_extents;      // Sorted by address
+            std::vector<uint64_t> m_labels;     // Sorted
+        };
+
+        // Returns the hashes of the executable and of the shared libraries.
+        static const std::pair<uint64_t, uint64_t>& LoadedObjects() {
+            static const std::pair<uint64_t, uint64_t> s_hashes = []() {
+                std::pair<uint64_t, uint64_t> hashes{ 0xcbf29ce484222325ull, 0xcbf29ce484222325ull };
+                dl_iterate_phdr([](dl_phdr_info* info, size_t /*size*/, void* data) {
+                    // The executable is the object without a name.
+                    bool executable = info->dlpi_name == nullptr || info->dlpi_name[0] == '\0';
+                    auto file = MappedFile::Open(executable ? "/proc/self/exe" : info->dlpi_name);
+                    if (file) {
+                        auto& object_hashes = *static_cast<std::pair<uint64_t, uint64_t>*>(data);
+                        auto& hash = executable ? object_hashes.first : object_hashes.second;
+                        hash = HashLoadedSections(hash, file->Contents());
+                    }
+                    return 0;
+                }, &hashes);
+                return hashes;
+            }();
+            return s_hashes;
+        }
+
+        // Hashes the loaded sections of an ELF file.  Falls back to the whole file for anything else.
+        static uint64_t HashLoadedSections(uint64_t hash, std::string_view contents) {
+            if (contents.size() < sizeof(Elf64_Ehdr) || contents.compare(0, SELFMAG, ELFMAG) != 0 || contents[EI_CLASS] != ELFCLASS64) {
+                return Hash(hash, contents);
+            }
+
+            Elf64_Ehdr header;
+            std::memcpy(&header, contents.data(), sizeof(header));
+            for (size_t index = 0; index != header.e_shnum; ++index) {
+                Elf64_Shdr section;
+                auto offset = header.e_shoff + index * header.e_shentsize;
+                if (offset + sizeof(section) > contents.size()) {
+                    break;
+                }
+                std::memcpy(&section, contents.data() + offset, sizeof(section));
+
+                bool loaded = (section.sh_flags & SHF_ALLOC) != 0 && section.sh_type != SHT_NOBITS && section.sh_type != SHT_NOTE;
+                if (loaded && section.sh_offset + section.sh_size <= contents.size()) {
+                    hash = Hash(hash, contents.substr(section.sh_offset, section.sh_size));
+                }
+            }
+            return hash;
+        }
+
+        std::string m_path;
+        std::unique_ptr<CodeGraph> m_graph;
+        CodeGraph::NodeMap m_nodes;         // Shared by the test cases, as they reach much of the same code
+        uint64_t m_base;
+        std::unordered_set<uint64_t> m_passed;
+    };
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Redirects stdout and stderr into a file in memory while a test case runs (see --capture), so that its
+    // output is reported with its result rather than interleaved with the report.  The output is only read,
+    // through a memory mapping, when it is reported.  On Linux the file is a memfd sealed at the capture
+    // limit, so writes beyond the limit fail instead of growing it.  Elsewhere it is an unlinked temporary
+    // file and only the first [limit] bytes are reported.
+    struct OutputCapture;
+
+#if defined(CPPUTF_HAS_CAPTURE) && !defined(CPPUTF_DECLARATIONS_ONLY)
+    struct OutputCapture {
+        // Returns nullptr if the file could not be created.
+        static std::unique_ptr<OutputCapture> Create(size_t limit) {
+            std::unique_ptr<OutputCapture> capture{ new OutputCapture(limit) };
+#if defined(MFD_ALLOW_SEALING) && defined(F_ADD_SEALS)
+            capture->m_fd = memfd_create("cpputf_capture", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+            if (capture->m_fd >= 0) {
+                capture->m_sealed =
+                    ftruncate(capture->m_fd, static_cast<off_t>(limit)) == 0 &&
+                    fcntl(capture->m_fd, F_ADD_SEALS, F_SEAL_GROW | F_SEAL_SHRINK) == 0;
+                if (!capture->m_sealed) {
+                    close(capture->m_fd);
+                    capture->m_fd = -1;
+                }
+            }
+#endif
+            if (capture->m_fd < 0) {
+                std::error_code error;
+                auto path = (std::filesystem::temp_directory_path(error) / "cpputf_capture_XXXXXX").string();
+                capture->m_fd = mkstemp(path.data());
+                if (capture->m_fd < 0) {
+                    return nullptr;
+                }
+                unlink(path.c_str());
+                fcntl(capture->m_fd, F_SETFD, FD_CLOEXEC);
+            }
+            return capture;
+        }
+
+        OutputCapture(const OutputCapture&) = delete;
+        OutputCapture& operator = (const OutputCapture&) = delete;
+
+        ~OutputCapture() {
+            Restore();
+            Unmap();
+            close(m_fd);
+        }
+
+        // Discards the output of the previous test case.
+        void Rewind() {
+            Unmap();
+            m_write_failed = false;
+            lseek(m_fd, 0, SEEK_SET);
+            if (!m_sealed) {
+                [[maybe_unused]] auto result = ftruncate(m_fd, 0);
+            }
+        }
+
+        // Points stdout and stderr at the file until Restore().  A forked child calls this and never restores.
+        void Redirect() {
+            FlushStandardStreams();
+            for (int target : { STDOUT_FILENO, STDERR_FILENO }) {
+                m_saved[target - STDOUT_FILENO] = fcntl(target, F_DUPFD_CLOEXEC, 0);
+                dup2(m_fd, target);
+            }
+        }
+
+        void Restore() {
+            if (m_saved[0] < 0 && m_saved[1] < 0) {
+                return;
+            }
+
+            FlushStandardStreams();
+            m_write_failed = !std::cout || !std::cerr || std::ferror(stdout) || std::ferror(stderr);
+            for (int target : { STDOUT_FILENO, STDERR_FILENO }) {
+                int& saved = m_saved[target - STDOUT_FILENO];
+                if (saved >= 0) {
+                    dup2(saved, target);
+                    close(saved);
+                    saved = -1;
+                }
+            }
+
+            // Writes beyond the limit fail, which leaves the streams in an error state.
+            std::cout.clear();
+            std::cerr.clear();
+            std::clearerr(stdout);
+            std::clearerr(stderr);
+        }
+
+        // The output written since Rewind(), by this process or a forked child.  Valid until the next
+        // Rewind().
+        std::string_view Output() {
+            Unmap();
+
+            // The duplicated descriptors share the file offset, so it is the number of bytes written.
+            auto written = lseek(m_fd, 0, SEEK_CUR);
+            if (written <= 0) {
+                return {};
+            }
+
+            // A write that would cross the sealed limit fails, so the file need not be full when truncated.
+            m_size = std::min(static_cast<size_t>(written), m_limit);
+            m_truncated = m_write_failed || static_cast<size_t>(written) > m_limit || (m_sealed && m_size == m_limit);
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+            if (data == MAP_FAILED) {
+                m_size = 0;
+                return {};
+            }
+            m_data = static_cast<const char*>(data);
+            return std::string_view(m_data, m_size);
+        }
+
+        // Whether the output returned by Output() reached the limit.  Writes made by a forked child that failed
+        // at the limit are not detected unless the file filled up.
+        bool Truncated() const {
+            return m_truncated;
+        }
+
+    private:
+        explicit OutputCapture(size_t limit)
+          : m_limit(std::max<size_t>(limit, 1))
+        {}
+
+        void Unmap() {
+            if (m_data) {
+                munmap(const_cast<char*>(m_data), m_size);
+                m_data = nullptr;
+            }
+            m_size = 0;
+            m_truncated = false;
+        }
+
+        static void FlushStandardStreams() {
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(stdout);
+            std::fflush(stderr);
+        }
+
+    private:
+        const size_t m_limit;
+        int m_fd = -1;
+        bool m_sealed = false;
+        int m_saved[2] = { -1, -1 };
+        bool m_write_failed = false;
+        const char* m_data = nullptr;
+        size_t m_size = 0;
+        bool m_truncated = false;
+    };
+#elif !defined(CPPUTF_DECLARATIONS_ONLY)
+    struct OutputCapture {};
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+
+    enum class SharedScope {
+        Fixture,    // Shared by the test cases of one fixture
+        Tag,        // Shared by the test cases with a given tag
+        Process     // Shared by every test case in the run
+    };
+
+    // Owns the state created by FIXTURE_SETUP_ONCE.  State is constructed by the first test case that asks
+    // for it and released once no test case that is still to run falls within its scope.  Test cases hold
+    // a reference to the state, so it is never destroyed while in use.
+    struct SharedSetupRegistry {
+        using Creator = std::shared_ptr<const void> (*)();
+
+        // Called with the state that a forked child creates, so that the parent can create it for later
+        // test cases (see ForkedTestRunner).
+        using CreatedCallback = void (*)(const void* context, const std::string& key, const std::type_info& type, Creator create);
+
+        template <typename T>
+        static std::shared_ptr<const T> Acquire(SharedScope scope, std::string_view tag = {}) {
+            auto value = AcquireSlot(MakeKey(scope, tag), typeid(T), [] () -> std::shared_ptr<const void> {
+                return std::make_shared<const T>();
+            });
+            return std::static_pointer_cast<const T>(value);
+        }
+
+        // Creates the state reported by a forked child, unless it already exists.
+        static void Adopt(const std::string& key, const std::type_info& type, Creator create) {
+            AcquireSlot(key, type, create);
+        }
+
+        // Set in a forked child, where the state that it creates would otherwise be lost when it exits.
+        static std::pair<CreatedCallback, const void*>& OnCreated() {
+            static std::pair<CreatedCallback, const void*> s_on_created{ nullptr, nullptr };
+            return s_on_created;
+        }
+
+        // The scopes that a test case belongs to.
+        static std::vector<std::string> ScopeKeys(std::string_view fixture_name, const std::vector<std::string_view>& tags);
+
+        // Records a test case that will run.
+        static void AddPending(const std::vector<std::string>& scope_keys);
+
+        // Records a test case that has finished, releasing any state whose scope has no test cases left.
+        static void Complete(const std::vector<std::string>& scope_keys);
+
+        // Releases all remaining state.
+        static void ReleaseAll();
+
+        // Locks the registry.  Held across fork() so that the child cannot inherit a lock taken by another
+        // thread.
+        static std::unique_lock<std::mutex> Lock();
+
+        // The fixture of the test case running on this thread.
+        static std::string_view& CurrentFixture() {
+            static thread_local std::string_view s_current_fixture;
+            return s_current_fixture;
+        }
+
+    private:
+        struct Slot;
+        struct State;
+
+        static std::shared_ptr<const void> AcquireSlot(const std::string& key, const std::type_info& type, Creator create);
+
+        static State& GetState();
+        static std::string MakeKey(SharedScope scope, std::string_view name);
+        static void ReleaseScope(State& state, const std::string& key, std::vector<std::shared_ptr<Slot>>& released);
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    struct SharedSetupRegistry::Slot {
+        std::mutex Mutex;
+        std::shared_ptr<const void> Value;
+    };
+
+    struct SharedSetupRegistry::State {
+        std::mutex Mutex;
+        std::map<std::string, size_t> Pending;
+        std::map<std::pair<std::string, std::type_index>, std::shared_ptr<Slot>> Slots;
+    };
+
+    CPPUTF_INLINE std::shared_ptr<const void> SharedSetupRegistry::AcquireSlot(const std::string& key, const std::type_info& type, Creator create) {
+        std::shared_ptr<Slot> slot;
+        {
+            auto& state = GetState();
+            std::lock_guard lock(state.Mutex);
+
+            auto& entry = state.Slots[{ key, std::type_index(type) }];
+            if (!entry) {
+                entry = std::make_shared<Slot>();
+            }
+            slot = entry;
+        }
+
+        // Construct outside the registry lock so that unrelated state can be built concurrently.
+        std::lock_guard lock(slot->Mutex);
+        if (!slot->Value) {
+            slot->Value = create();
+            if (auto [callback, context] = OnCreated(); callback) {
+                callback(context, key, type, create);
+            }
+        }
+        return slot->Value;
+    }
+
+    CPPUTF_INLINE std::vector<std::string> SharedSetupRegistry::ScopeKeys(std::string_view fixture_name, const std::vector<std::string_view>& tags) {
+        std::vector<std::string> keys;
+        keys.push_back(MakeKey(SharedScope::Fixture, fixture_name));
+        for (auto& tag : tags) {
+            keys.push_back(MakeKey(SharedScope::Tag, tag));
+        }
+        keys.push_back(MakeKey(SharedScope::Process, {}));
+        return keys;
+    }
+
+    CPPUTF_INLINE void SharedSetupRegistry::AddPending(const std::vector<std::string>& scope_keys) {
+        auto& state = GetState();
+        std::lock_guard lock(state.Mutex);
+        for (auto& key : scope_keys) {
+            state.Pending[key]++;
+        }
+    }
+
+    CPPUTF_INLINE void SharedSetupRegistry::Complete(const std::vector<std::string>& scope_keys) {
+        std::vector<std::shared_ptr<Slot>> released;
+        {
+            auto& state = GetState();
+            std::lock_guard lock(state.Mutex);
+            for (auto& key : scope_keys) {
+                auto pending = state.Pending.find(key);
+                if (pending == state.Pending.end() || --pending->second != 0) {
+                    continue;
+                }
+                state.Pending.erase(pending);
+                ReleaseScope(state, key, released);
+            }
+        }
+        // Destroy outside the lock.
+        released.clear();
+    }
+
+    CPPUTF_INLINE void SharedSetupRegistry::ReleaseAll() {
+        decltype(State::Slots) released;
+        {
+            auto& state = GetState();
+            std::lock_guard lock(state.Mutex);
+            state.Pending.clear();
+            released.swap(state.Slots);
+        }
+    }
+
+    CPPUTF_INLINE std::unique_lock<std::mutex> SharedSetupRegistry::Lock() {
+        return std::unique_lock(GetState().Mutex);
+    }
+
+    CPPUTF_INLINE SharedSetupRegistry::State& SharedSetupRegistry::GetState() {
+        static State s_state;
+        return s_state;
+    }
+
+    CPPUTF_INLINE std::string SharedSetupRegistry::MakeKey(SharedScope scope, std::string_view name) {
+        switch (scope) {
+        case SharedScope::Fixture: return "fixture:" + std::string(name.empty() ? CurrentFixture() : name);
+        case SharedScope::Tag: return "tag:" + std::string(name);
+        case SharedScope::Process: break;
+        }
+        return "process";
+    }
+
+    CPPUTF_INLINE void SharedSetupRegistry::ReleaseScope(State& state, const std::string& key, std::vector<std::shared_ptr<Slot>>& released) {
+        for (auto it = state.Slots.begin(); it != state.Slots.end();) {
+            if (it->first.first == key) {
+                released.push_back(std::move(it->second));
+                it = state.Slots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // A data file returned by TEST_DATA.  Every TestData for the same file shares one read-only mapping, which
+    // stays valid while any of them is held.
+    struct TestData {
+        std::string_view Text() const {
+            return m_contents;
+        }
+
+        const std::byte* Data() const {
+            return reinterpret_cast<const std::byte*>(m_contents.data());
+        }
+
+        size_t Size() const {
+            return m_contents.size();
+        }
+
+    private:
+        TestData(std::shared_ptr<const void> lease, std::string_view contents)
+          : m_lease(std::move(lease)),
+            m_contents(contents)
+        {}
+
+        std::shared_ptr<const void> m_lease;
+        std::string_view m_contents;
+
+        friend struct TestDataRegistry;
+    };
+
+    // Maps each file used by TEST_DATA once per process, so that the test cases that read it (including those
+    // running in parallel) share the mapping instead of each reading the file.  Files that no TestData refers
+    // to stay mapped for later test cases, up to a limit, and the least recently used are unmapped first.
+    struct TestDataRegistry {
+        // Throws std::runtime_error if [path] cannot be read.  Relative paths are relative to the working
+        // directory.
+        static TestData Acquire(const std::string& path);
+
+        // Sets how many bytes of unused files stay mapped.  Set from RunOptions by TestRegistry::Run.
+        static void SetLimit(size_t bytes);
+
+        // The size of the unused files that are still mapped.
+        static size_t CachedBytes();
+
+        // Locks the registry.  Held across fork() so that the child cannot inherit a lock taken by another
+        // thread.
+        static std::unique_lock<std::mutex> Lock();
+
+    private:
+        struct Entry;
+        struct State;
+
+        static State& GetState();
+        static void Release(const std::string& key);
+        static void Trim(State& state, std::vector<std::shared_ptr<const void>>& released);
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    struct TestDataRegistry::Entry {
+        std::shared_ptr<MappedFile> File;
+        std::filesystem::file_time_type Modified;   // When the mapped file was last written
+        size_t Users = 0;
+        std::list<std::string>::iterator Unused;    // Position in State::Unused once Users is zero
+    };
+
+    struct TestDataRegistry::State {
+        std::mutex Mutex;
+        std::unordered_map<std::string, Entry> Entries;
+        std::list<std::string> Unused;              // Most recently used first
+        size_t CachedBytes = 0;
+        size_t Limit = size_t(512) << 20;
+    };
+
+    CPPUTF_INLINE TestData TestDataRegistry::Acquire(const std::string& path) {
+        auto key = std::filesystem::absolute(path).lexically_normal().string();
+        std::error_code error;
+        auto modified = std::filesystem::last_write_time(key, error);
+
+        std::shared_ptr<const void> stale;      // Unmapped outside the lock
+        auto& state = GetState();
+        std::lock_guard lock(state.Mutex);
+
+        auto entry = state.Entries.find(key);
+        if (entry != state.Entries.end() && entry->second.Users == 0) {
+            state.Unused.erase(entry->second.Unused);
+            state.CachedBytes -= entry->second.File->Contents().size();
+            if (entry->second.Modified != modified) {
+                // Rewritten since it was mapped.  A file in use keeps its mapping until released.
+                stale = std::move(entry->second.File);
+                state.Entries.erase(entry);
+                entry = state.Entries.end();
+            }
+        }
+        if (entry == state.Entries.end()) {
+            auto file = MappedFile::Open(key);
+            if (!file) {
+                throw std::runtime_error("Unable to read test data: " + path);
+            }
+            entry = state.Entries.emplace(key, Entry{ std::move(file), modified, 0, {} }).first;
+        }
+        entry->second.Users++;
+
+        auto& file = entry->second.File;
+        std::shared_ptr<const void> lease(file.get(), [key, file](const void*) { Release(key); });
+        return TestData(std::move(lease), file->Contents());
+    }
+
+    CPPUTF_INLINE void TestDataRegistry::SetLimit(size_t bytes) {
+        std::vector<std::shared_ptr<const void>> released;
+        {
+            auto& state = GetState();
+            std::lock_guard lock(state.Mutex);
+            state.Limit = bytes;
+            Trim(state, released);
+        }
+    }
+
+    CPPUTF_INLINE size_t TestDataRegistry::CachedBytes() {
+        auto& state = GetState();
+        std::lock_guard lock(state.Mutex);
+        return state.CachedBytes;
+    }
+
+    CPPUTF_INLINE std::unique_lock<std::mutex> TestDataRegistry::Lock() {
+        return std::unique_lock(GetState().Mutex);
+    }
+
+    CPPUTF_INLINE TestDataRegistry::State& TestDataRegistry::GetState() {
+        static State s_state;
+        return s_state;
+    }
+
+    CPPUTF_INLINE void TestDataRegistry::Release(const std::string& key) {
+        std::vector<std::shared_ptr<const void>> released;
+        {
+            auto& state = GetState();
+            std::lock_guard lock(state.Mutex);
+
+            auto& entry = state.Entries.at(key);
+            if (--entry.Users != 0) {
+                return;
+            }
+            entry.Unused = state.Unused.insert(state.Unused.begin(), key);
+            state.CachedBytes += entry.File->Contents().size();
+            Trim(state, released);
+        }
+        // Unmap outside the lock.
+        released.clear();
+    }
+
+    CPPUTF_INLINE void TestDataRegistry::Trim(State& state, std::vector<std::shared_ptr<const void>>& released) {
+        while (state.CachedBytes > state.Limit) {
+            auto entry = state.Entries.find(state.Unused.back());
+            state.CachedBytes -= entry->second.File->Contents().size();
+            released.push_back(std::move(entry->second.File));
+            state.Entries.erase(entry);
+            state.Unused.pop_back();
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_FORK)
+    // Forwards to a logger that can be replaced after construction.  Forked test cases are constructed
+    // before the fork, so the child redirects its fixture's logger through this.
+    struct ForwardingLogger :
+        ILogger
+    {
+        static std::shared_ptr<ForwardingLogger> Create(ILoggerPtr target) {
+            return std::shared_ptr<ForwardingLogger>{ new ForwardingLogger(std::move(target)) };
+        }
+
+        virtual ~ForwardingLogger() = default;
+
+        void SetTarget(ILoggerPtr target) {
+            m_target = std::move(target);
+        }
+
+        void BeginRun(size_t test_count) override { m_target->BeginRun(test_count); }
+        void EndRun(size_t pass_count, size_t fail_count, size_t skip_count) override { m_target->EndRun(pass_count, fail_count, skip_count); }
+
+        void SkipTest(const std::string_view& name) override { m_target->SkipTest(name); }
+        void EnterTest(const std::string_view& name) override { m_target->EnterTest(name); }
+        void ExitTest(bool failed) override { m_target->ExitTest(failed); }
+        void CachedTest(const std::string_view& name) override { m_target->CachedTest(name); }
+
+        void SkipSection(const std::string_view& name) override { m_target->SkipSection(name); }
+        void PushSection(const std::string_view& name) override { m_target->PushSection(name); }
+        void PopSection() override { m_target->PopSection(); }
+
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            m_target->AssertFailed(type, location, message);
+        }
+        void UnhandledException(const std::string_view& message) override { m_target->UnhandledException(message); }
+
+        void TestOutput(const std::string_view& output, bool truncated) override { m_target->TestOutput(output, truncated); }
+        void TestMetric(const std::string_view& name, double value) override { m_target->TestMetric(name, value); }
+
+        void Flush() override { m_target->Flush(); }
+
+    private:
+        ForwardingLogger(ILoggerPtr target)
+          : m_target(std::move(target))
+        {}
+
+    private:
+        ILoggerPtr m_target;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // The wire format for log calls made in another process: each event is a type byte followed by a
+    // length-prefixed payload.  Used by forked test cases and by distributed runs.
+    struct EventStream {
+        enum class EventType : char {
+            SkipSection = 'S',
+            PushSection = 'P',
+            PopSection = 'O',
+            AssertFailed = 'A',
+            UnhandledException = 'U',
+            TestOutput = 'C',
+            TestMetric = 'M',
+
+            // Forked test cases only
+            SharedSetup = 'H',
+
+            // Distributed runs only
+            EnterTest = 'T',
+            ExitTest = 'X',
+            RequestWork = 'R',
+            Batch = 'B',
+            EndOfWork = 'E'
+        };
+
+        // Writes the log calls made while a test case runs to a file descriptor.
+        struct Logger;
+
+        static void AppendNumber(std::string& out, uint64_t value);
+        static void AppendString(std::string& out, std::string_view value);
+        static void AppendEvent(std::string& out, EventType type, std::string_view payload);
+
+        static bool ReadNumber(std::string_view& in, uint64_t& value);
+        static bool ReadString(std::string_view& in, std::string_view& value);
+
+        // Removes the next event from the front of [events].  Returns std::nullopt if it is incomplete.
+        static std::optional<std::pair<EventType, std::string_view>> NextEvent(std::string_view& events);
+
+        // Returns false if the other end has gone away.
+        static bool WriteAll(int fd, std::string_view data);
+        static std::string ReadAll(int fd);
+
+        // Replays a test case event on [logger].  [section_depth] tracks the sections left open.
+        static void Replay(EventType type, std::string_view payload, ILogger& logger, size_t& section_depth);
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    struct EventStream::Logger :
+        ILogger
+    {
+        explicit Logger(int fd)
+          : m_fd(fd)
+        {}
+
+        virtual ~Logger() = default;
+
+        void BeginRun(size_t /*test_count*/) override {}
+        void EndRun(size_t /*pass_count*/, size_t /*fail_count*/, size_t /*skip_count*/) override {}
+
+        void SkipTest(const std::string_view& /*name*/) override {}
+        void EnterTest(const std::string_view& /*name*/) override {}
+        void ExitTest(bool /*failed*/) override {}
+
+        void SkipSection(const std::string_view& name) override {
+            Send(EventType::SkipSection, name);
+        }
+        void PushSection(const std::string_view& name) override {
+            Send(EventType::PushSection, name);
+        }
+        void PopSection() override {
+            Send(EventType::PopSection, {});
+        }
+
+        void AssertFailed(
+            AssertType type,
+            const AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            std::string event;
+            AppendString(event, location.SourceFile);
+            AppendNumber(event, location.LineNumber);
+            AppendNumber(event, (type == AssertType::Throw) ? 1 : 0);
+            AppendString(event, message);
+            Send(EventType::AssertFailed, event);
+        }
+        void UnhandledException(const std::string_view& message) override {
+            Send(EventType::UnhandledException, message);
+        }
+
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            std::string event;
+            AppendNumber(event, truncated ? 1 : 0);
+            AppendString(event, output);
+            Send(EventType::TestOutput, event);
+        }
+        void TestMetric(const std::string_view& name, double value) override {
+            uint64_t bits = 0;
+            std::memcpy(&bits, &value, sizeof(bits));
+            std::string event;
+            AppendNumber(event, bits);
+            AppendString(event, name);
+            Send(EventType::TestMetric, event);
+        }
+
+    private:
+        void Send(EventType type, std::string_view payload) {
+            std::string event;
+            AppendEvent(event, type, payload);
+            WriteAll(m_fd, event);
+        }
+
+    private:
+        int m_fd;
+    };
+
+    CPPUTF_INLINE void EventStream::AppendNumber(std::string& out, uint64_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+    CPPUTF_INLINE void EventStream::AppendString(std::string& out, std::string_view value) {
+        AppendNumber(out, value.size());
+        out += value;
+    }
+    CPPUTF_INLINE void EventStream::AppendEvent(std::string& out, EventType type, std::string_view payload) {
+        out += static_cast<char>(type);
+        AppendString(out, payload);
+    }
+
+    CPPUTF_INLINE bool EventStream::ReadNumber(std::string_view& in, uint64_t& value) {
+        if (in.size() < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, in.data(), sizeof(value));
+        in.remove_prefix(sizeof(value));
+        return true;
+    }
+    CPPUTF_INLINE bool EventStream::ReadString(std::string_view& in, std::string_view& value) {
+        uint64_t size = 0;
+        if (!ReadNumber(in, size) || in.size() < size) {
+            return false;
+        }
+        value = in.substr(0, static_cast<size_t>(size));
+        in.remove_prefix(static_cast<size_t>(size));
+        return true;
+    }
+
+    CPPUTF_INLINE std::optional<std::pair<EventStream::EventType, std::string_view>> EventStream::NextEvent(std::string_view& events) {
+        if (events.empty()) {
+            return std::nullopt;
+        }
+
+        auto remaining = events.substr(1);
+        std::string_view payload;
+        if (!ReadString(remaining, payload)) {
+            return std::nullopt;
+        }
+
+        auto type = static_cast<EventType>(events.front());
+        events = remaining;
+        return std::make_pair(type, payload);
+    }
+
+    CPPUTF_INLINE bool EventStream::WriteAll(int fd, std::string_view data) {
+        while (!data.empty()) {
+            // Sockets are written with send() so that a closed connection is an error rather than SIGPIPE.
+#if defined(MSG_NOSIGNAL)
+            auto written = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (written < 0 && errno == ENOTSOCK) {
+                written = write(fd, data.data(), data.size());
+            }
+#else
+            auto written = write(fd, data.data(), data.size());
+#endif
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data.remove_prefix(static_cast<size_t>(written));
+        }
+        return true;
+    }
+
+    CPPUTF_INLINE std::string EventStream::ReadAll(int fd) {
+        std::string data;
+        char buffer[4096];
+        for (;;) {
+            auto count = read(fd, buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                return data;
+            }
+            data.append(buffer, static_cast<size_t>(count));
+        }
+    }
+
+    CPPUTF_INLINE void EventStream::Replay(EventType type, std::string_view payload, ILogger& logger, size_t& section_depth) {
+        switch (type) {
+        case EventType::SkipSection:
+            logger.SkipSection(payload);
+            break;
+        case EventType::PushSection:
+            logger.PushSection(payload);
+            section_depth++;
+            break;
+        case EventType::PopSection:
+            if (section_depth > 0) {
+                logger.PopSection();
+                section_depth--;
+            }
+            break;
+        case EventType::AssertFailed: {
+            std::string_view source_file;
+            uint64_t line_number = 0;
+            uint64_t is_require = 0;
+            std::string_view message;
+            if (ReadString(payload, source_file) && ReadNumber(payload, line_number) && ReadNumber(payload, is_require) && ReadString(payload, message)) {
+                logger.AssertFailed(
+                    is_require ? AssertType::Throw : AssertType::Continue,
+                    AssertLocation{ source_file, static_cast<size_t>(line_number) },
+                    message
+                );
+            }
+            break;
+        }
+        case EventType::UnhandledException:
+            logger.UnhandledException(payload);
+            break;
+        case EventType::TestOutput: {
+            uint64_t truncated = 0;
+            std::string_view output;
+            if (ReadNumber(payload, truncated) && ReadString(payload, output)) {
+                logger.TestOutput(output, truncated != 0);
+            }
+            break;
+        }
+        case EventType::TestMetric: {
+            uint64_t bits = 0;
+            std::string_view name;
+            if (ReadNumber(payload, bits) && ReadString(payload, name)) {
+                double value = 0;
+                std::memcpy(&value, &bits, sizeof(value));
+                logger.TestMetric(name, value);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Runs test case bodies in a forked child process, so that every test case gets its own address space.
+    // The child's log calls are sent back to the parent over a pipe, along with the FIXTURE_SETUP_ONCE state
+    // that it created.  The parent then creates that state as well, so that the children of later test
+    // cases share it copy-on-write instead of each building their own.
+    struct ForkedTestRunner {
+        // Runs [body] in a child process.  Returns true if the test case failed.  The child's stdout and stderr
+        // are redirected to [capture], if given.
+        template <typename TBody>
+        static bool Run(ForwardingLogger& fixture_logger, const ILoggerPtr& logger, const TBody& body, OutputCapture* capture = nullptr) {
+            auto invoke = [](const void* context) {
+                return static_cast<bool>((*static_cast<const TBody*>(context))());
+            };
+            return Run(fixture_logger, logger, invoke, &body, capture);
+        }
+
+        static bool Run(ForwardingLogger& fixture_logger, const ILoggerPtr& logger, bool (*body)(const void*), const void* context, OutputCapture* capture);
+
+    private:
+        [[noreturn]] static void RunChild(ForwardingLogger& fixture_logger, int fd, bool (*body)(const void*), const void* context, OutputCapture* capture);
+
+        // Sends the shared state created by the child to the parent.
+        static void SendSharedSetup(const void* context, const std::string& key, const std::type_info& type, SharedSetupRegistry::Creator create);
+
+        // Replays the events sent by a child on [logger], and creates the shared state that it created.
+        static void Replay(std::string_view events, const ILoggerPtr& logger);
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE bool ForkedTestRunner::Run(ForwardingLogger& fixture_logger, const ILoggerPtr& logger, bool (*body)(const void*), const void* context, OutputCapture* capture) {
+        // With --jobs, a child forked by another thread would inherit the write end of this pipe, and the read
+        // below would wait for that child to exit too.  So only one thread at a time creates a pipe and forks,
+        // until the parent has closed its write end.
+        static std::mutex s_fork_mutex;
+        std::unique_lock fork_lock(s_fork_mutex);
+
+        int fds[2];
+        if (pipe(fds) != 0) {
+            throw std::runtime_error("Unable to create a pipe for the test process");
+        }
+
+        // Anything left in the stdio buffers would otherwise be written by both processes.
+        AsyncLogger::FlushActive();
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+
+        pid_t pid;
+        {
+            auto registry_lock = SharedSetupRegistry::Lock();
+            auto data_lock = TestDataRegistry::Lock();
+            pid = fork();
+        }
+        if (pid < 0) {
+            close(fds[0]);
+            close(fds[1]);
+            throw std::runtime_error("Unable to fork the test process");
+        }
+
+        if (pid == 0) {
+            fork_lock.unlock();
+            close(fds[0]);
+            RunChild(fixture_logger, fds[1], body, context, capture);
+        }
+
+        close(fds[1]);
+        fork_lock.unlock();
+        auto events = EventStream::ReadAll(fds[0]);
+        close(fds[0]);
+
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+        Replay(events, logger);
+        if (WIFSIGNALED(status)) {
+            logger->UnhandledException("Test process terminated by signal " + std::to_string(WTERMSIG(status)));
+            return true;
+        }
+        return !WIFEXITED(status) || (WEXITSTATUS(status) != 0);
+    }
+
+    CPPUTF_INLINE void ForkedTestRunner::RunChild(ForwardingLogger& fixture_logger, int fd, bool (*body)(const void*), const void* context, OutputCapture* capture) {
+        AsyncLogger::DetachFromChild();
+        auto pipe_logger = std::make_shared<EventStream::Logger>(fd);
+        fixture_logger.SetTarget(pipe_logger);
+        SharedSetupRegistry::OnCreated() = { &SendSharedSetup, &fd };
+        if (capture) {
+            capture->Redirect();
+        }
+
+        int exit_code = 1;
+        try {
+            exit_code = body(context) ? 1 : 0;
+        } catch (const AssertException&) {
+            // REQUIRE* statement failed.  Already reported.
+        } catch (const std::exception& e) {
+            pipe_logger->UnhandledException(e.what());
+        } catch (...) {
+            pipe_logger->UnhandledException("<unstructured>");
+        }
+
+        // Skip static destructors, which belong to the parent.
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+        _exit(exit_code);
+    }
+
+    CPPUTF_INLINE void ForkedTestRunner::SendSharedSetup(
+        const void* context,
+        const std::string& key,
+        const std::type_info& type,
+        SharedSetupRegistry::Creator create
+    ) {
+        // The parent has the same image, so the addresses of the type and its creator are valid there too.
+        std::string payload;
+        EventStream::AppendString(payload, key);
+        EventStream::AppendNumber(payload, reinterpret_cast<uintptr_t>(&type));
+        EventStream::AppendNumber(payload, reinterpret_cast<uintptr_t>(create));
+
+        std::string event;
+        EventStream::AppendEvent(event, EventStream::EventType::SharedSetup, payload);
+        EventStream::WriteAll(*static_cast<const int*>(context), event);
+    }
+
+    CPPUTF_INLINE void ForkedTestRunner::Replay(std::string_view events, const ILoggerPtr& logger) {
+        size_t section_depth = 0;
+        while (auto event = EventStream::NextEvent(events)) {
+            if (event->first != EventStream::EventType::SharedSetup) {
+                EventStream::Replay(event->first, event->second, *logger, section_depth);
+                continue;
+            }
+
+            std::string_view key;
+            uint64_t type = 0;
+            uint64_t create = 0;
+            auto payload = event->second;
+            if (EventStream::ReadString(payload, key) && EventStream::ReadNumber(payload, type) && EventStream::ReadNumber(payload, create)) {
+                try {
+                    SharedSetupRegistry::Adopt(
+                        std::string(key),
+                        *reinterpret_cast<const std::type_info*>(static_cast<uintptr_t>(type)),
+                        reinterpret_cast<SharedSetupRegistry::Creator>(static_cast<uintptr_t>(create))
+                    );
+                } catch (...) {
+                    // The child that needs it next will create it again, and report why it cannot.
+                }
+            }
+        }
+
+        // A crashed child may have left sections open.
+        for (; section_depth > 0; --section_depth) {
+            logger->PopSection();
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    // Stream sockets for distributed runs.  Addresses are "unix:<path>" or "[tcp:]<host>:<port>".  Failures
+    // throw std::runtime_error.
+    struct Socket {
+        // Listens on [address].  Returns the socket and the address that local workers should connect to,
+        // which differs from [address] when the host is a wildcard or port 0 lets the system choose.
+        static std::pair<int, std::string> Listen(const std::string& address) {
+            if (auto path = UnixPath(address)) {
+                auto unix_address = MakeUnixAddress(*path);
+                int fd = Open(AF_UNIX);
+                unlink(path->c_str());    // Left behind by an earlier run
+                if (bind(fd, reinterpret_cast<const sockaddr*>(&unix_address), sizeof(unix_address)) != 0 || listen(fd, SOMAXCONN) != 0) {
+                    close(fd);
+                    throw std::runtime_error("Unable to listen on " + address);
+                }
+                return { fd, address };
+            }
+
+            auto [host, port] = SplitHostPort(address);
+            bool any_host = host.empty() || host == "*";
+            auto info = Resolve(any_host ? std::string() : host, port, AI_PASSIVE);
+            int fd = Open(info->ai_family);
+            int reuse = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            bool bound = bind(fd, info->ai_addr, info->ai_addrlen) == 0 && listen(fd, SOMAXCONN) == 0;
+            freeaddrinfo(info);
+            if (!bound) {
+                close(fd);
+                throw std::runtime_error("Unable to listen on " + address);
+            }
+
+            sockaddr_storage bound_address{};
+            socklen_t length = sizeof(bound_address);
+            getsockname(fd, reinterpret_cast<sockaddr*>(&bound_address), &length);
+            auto bound_port = ntohs(
+                (bound_address.ss_family == AF_INET6)
+                    ? reinterpret_cast<const sockaddr_in6*>(&bound_address)->sin6_port
+                    : reinterpret_cast<const sockaddr_in*>(&bound_address)->sin_port
+            );
+            if (any_host) {
+                host = (bound_address.ss_family == AF_INET6) ? "::1" : "127.0.0.1";
+            }
+            return { fd, "tcp:" + (host.find(':') != std::string::npos ? "[" + host + "]" : host) + ":" + std::to_string(bound_port) };
+        }
+
+        // Connects to [address], retrying for up to [timeout] while the coordinator starts.
+        static int Connect(const std::string& address, std::chrono::milliseconds timeout) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            for (;;) {
+                int fd = TryConnect(address);
+                if (fd >= 0) {
+                    return fd;
+                }
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    throw std::runtime_error("Unable to connect to " + address);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+
+        static int Accept(int listen_fd) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd >= 0) {
+                Configure(fd);
+            }
+            return fd;
+        }
+
+        // Removes the file created for a Unix domain socket.
+        static void Remove(const std::string& address) {
+            if (auto path = UnixPath(address)) {
+                unlink(path->c_str());
+            }
+        }
+
+    private:
+        static std::optional<std::string> UnixPath(const std::string& address) {
+            constexpr std::string_view unix_prefix = "unix:";
+            if (address.compare(0, unix_prefix.size(), unix_prefix) != 0) {
+                return std::nullopt;
+            }
+            return address.substr(unix_prefix.size());
+        }
+
+        static sockaddr_un MakeUnixAddress(const std::string& path) {
+            sockaddr_un unix_address{};
+            if (path.empty() || path.size() >= sizeof(unix_address.sun_path)) {
+                throw std::runtime_error("Invalid Unix socket path: " + path);
+            }
+            unix_address.sun_family = AF_UNIX;
+            std::memcpy(unix_address.sun_path, path.data(), path.size());
+            return unix_address;
+        }
+
+        static std::pair<std::string, std::string> SplitHostPort(const std::string& address) {
+            constexpr std::string_view tcp_prefix = "tcp:";
+            std::string host_port = (address.compare(0, tcp_prefix.size(), tcp_prefix) == 0) ? address.substr(tcp_prefix.size()) : address;
+
+            auto split = host_port.rfind(':');
+            if (split == std::string::npos || split + 1 == host_port.size()) {
+                throw std::runtime_error("Invalid socket address: " + address);
+            }
+
+            auto host = host_port.substr(0, split);
+            if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+                host = host.substr(1, host.size() - 2);    // "[::1]:1234"
+            }
+            return { host, host_port.substr(split + 1) };
+        }
+
+        static addrinfo* Resolve(const std::string& host, const std::string& port, int flags) {
+            addrinfo hints{};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = flags;
+
+            addrinfo* info = nullptr;
+            if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &info) != 0 || info == nullptr) {
+                throw std::runtime_error("Unable to resolve " + host + ":" + port);
+            }
+            return info;
+        }
+
+        static int Open(int family) {
+            int fd = socket(family, SOCK_STREAM, 0);
+            if (fd < 0) {
+                throw std::runtime_error("Unable to create a socket");
+            }
+            Configure(fd);
+            return fd;
+        }
+
+        static void Configure(int fd) {
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+            int enable = 1;
+#if defined(SO_NOSIGPIPE)
+            setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+            // Requests and results are small messages that should not wait for Nagle's algorithm.
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+
+        static int TryConnect(const std::string& address) {
+            if (auto path = UnixPath(address)) {
+                auto unix_address = MakeUnixAddress(*path);
+                int fd = Open(AF_UNIX);
+                if (connect(fd, reinterpret_cast<const sockaddr*>(&unix_address), sizeof(unix_address)) != 0) {
+                    close(fd);
+                    return -1;
+                }
+                return fd;
+            }
+
+            auto [host, port] = SplitHostPort(address);
+            auto info = Resolve(host, port, 0);
+            int fd = -1;
+            for (auto entry = info; entry != nullptr && fd < 0; entry = entry->ai_next) {
+                fd = Open(entry->ai_family);
+                if (connect(fd, entry->ai_addr, entry->ai_addrlen) != 0) {
+                    close(fd);
+                    fd = -1;
+                }
+            }
+            freeaddrinfo(info);
+            return fd;
+        }
+    };
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+#endif
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    // Decides which test cases may run concurrently.  Test cases are started in registration order, skipping
+    // over any whose constraints cannot be met yet so that free slots stay busy.  Constraints come from tags:
+    //   "exclusive"            - the test case runs on its own
+    //   "exclusive:<resource>" - no other test case holding <resource> runs at the same time
+    //   "weight:<count>"       - the test case occupies <count> of the parallel slots
+    struct TestScheduler {
+        struct Constraints {
+            size_t Weight = 1;
+            std::vector<std::string_view> Exclusive;
+        };
+
+        static Constraints ParseConstraints(const std::vector<std::string_view>& tags) {
+            constexpr std::string_view exclusive_prefix = "exclusive:";
+            constexpr std::string_view weight_prefix = "weight:";
+
+            Constraints constraints;
+            for (auto& tag : tags) {
+                if (tag == exclusive_prefix.substr(0, exclusive_prefix.size() - 1)) {
+                    constraints.Weight = std::numeric_limits<size_t>::max();
+                } else if (tag.substr(0, exclusive_prefix.size()) == exclusive_prefix) {
+                    constraints.Exclusive.push_back(tag.substr(exclusive_prefix.size()));
+                } else if (tag.substr(0, weight_prefix.size()) == weight_prefix) {
+                    auto value = tag.substr(weight_prefix.size());
+                    size_t weight = 0;
+                    auto end = value.data() + value.size();
+                    if (std::from_chars(value.data(), end, weight).ptr == end && weight > 0) {
+                        constraints.Weight = weight;
+                    }
+                }
+            }
+            return constraints;
+        }
+
+        explicit TestScheduler(size_t slots)
+          : m_free_slots(std::max<size_t>(slots, 1)),
+            m_slots(m_free_slots)
+        {}
+
+        void Add(size_t id, Constraints constraints) {
+            std::lock_guard lock(m_mutex);
+            // A test case heavier than the whole pool runs on its own.
+            constraints.Weight = std::min(constraints.Weight, m_slots);
+            m_pending.push_back({ id, std::move(constraints) });
+        }
+
+        // Takes the first pending test case that can start now, if any.
+        std::optional<size_t> TryTake() {
+            std::lock_guard lock(m_mutex);
+            return TakeLocked();
+        }
+
+        // Waits for a pending test case that can start.  Returns std::nullopt once none remain.
+        std::optional<size_t> Take() {
+            std::unique_lock lock(m_mutex);
+            for (;;) {
+                if (auto id = TakeLocked()) {
+                    return id;
+                }
+                if (m_pending.empty()) {
+                    return std::nullopt;
+                }
+                m_released.wait(lock);
+            }
+        }
+
+        // Returns the resources held by a test case taken earlier.
+        void Release(size_t id) {
+            {
+                std::lock_guard lock(m_mutex);
+                auto running = std::find_if(m_running.begin(), m_running.end(), [id](const Entry& entry) { return entry.Id == id; });
+                if (running == m_running.end()) {
+                    return;
+                }
+
+                m_free_slots += running->Required.Weight;
+                for (auto& resource : running->Required.Exclusive) {
+                    m_held.erase(m_held.find(resource));
+                }
+                m_running.erase(running);
+            }
+            m_released.notify_all();
+        }
+
+    private:
+        struct Entry {
+            size_t Id;
+            Constraints Required;
+        };
+
+        std::optional<size_t> TakeLocked() {
+            for (auto entry = m_pending.begin(); entry != m_pending.end(); ++entry) {
+                if (entry->Required.Weight > m_free_slots) {
+                    continue;
+                }
+                bool blocked = std::any_of(
+                    entry->Required.Exclusive.begin(),
+                    entry->Required.Exclusive.end(),
+                    [this](std::string_view resource) { return m_held.count(resource) != 0; }
+                );
+                if (blocked) {
+                    continue;
+                }
+
+                m_free_slots -= entry->Required.Weight;
+                m_held.insert(entry->Required.Exclusive.begin(), entry->Required.Exclusive.end());
+                auto id = entry->Id;
+                m_running.push_back(std::move(*entry));
+                m_pending.erase(entry);
+                return id;
+            }
+            return std::nullopt;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_released;
+        size_t m_free_slots;
+        const size_t m_slots;
+        std::vector<Entry> m_pending;
+        std::vector<Entry> m_running;
+        std::multiset<std::string_view> m_held;
+    };
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+
+    // A callable that runs once, when the operation it continues has completed.  Unlike std::function it only
+    // has to be movable.
+    struct Task {
+        Task() = default;
+
+        template <typename TCallable, std::enable_if_t<!std::is_same_v<std::decay_t<TCallable>, Task>, int> = 0>
+        explicit Task(TCallable callable)
+          : m_callable(std::make_unique<Callable<TCallable>>(std::move(callable)))
+        {}
+
+        explicit operator bool() const {
+            return m_callable != nullptr;
+        }
+
+        void operator () () {
+            m_callable->Run();
+        }
+
+    private:
+        struct ICallable {
+            virtual ~ICallable() = default;
+            virtual void Run() = 0;
+        };
+
+        template <typename TCallable>
+        struct Callable : ICallable {
+            explicit Callable(TCallable callable)
+              : Value(std::move(callable))
+            {}
+
+            void Run() override {
+                Value();
+            }
+
+            TCallable Value;
+        };
+
+        std::unique_ptr<ICallable> m_callable;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Runs tasks on the calling thread when a timer expires or a file descriptor becomes ready.  Every task has
+    // an owner, so that an async test case that has failed can drop the rest of its tasks.
+    struct EventLoop {
+        using Clock = std::chrono::steady_clock;
+
+        // Returns nullptr if the loop's system resources could not be created.
+        static std::unique_ptr<EventLoop> Create();
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator = (const EventLoop&) = delete;
+        ~EventLoop();
+
+        // Runs [task] once [delay] has passed.  Tasks that are due together run in the order they were added.
+        void After(const void* owner, Clock::duration delay, Task task);
+
+#if defined(CPPUTF_HAS_ASYNC_IO)
+        // Runs [task] once [fd] is readable, or writable, or has an error or hang-up.  A descriptor that cannot
+        // be waited for, such as a regular file, counts as ready.
+        void WhenReady(const void* owner, int fd, bool writable, Task task);
+#endif
+
+        // Drops the tasks of [owner] that are still waiting.  Returns how many there were.
+        size_t Cancel(const void* owner);
+
+        bool Empty() const;
+
+        // Waits until a task is due, or until [deadline], and runs the tasks that are due.
+        void RunOnce(Clock::time_point deadline);
+
+    private:
+        struct State;
+
+        explicit EventLoop(std::unique_ptr<State> state);
+
+        std::unique_ptr<State> m_state;
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    struct EventLoop::State {
+        struct Timer {
+            Clock::time_point Due;
+            uint64_t Sequence;
+            const void* Owner;
+            Task Callback;
+        };
+
+        struct Watch {
+            int Fd;
+            bool Writable;
+            const void* Owner;
+            Task Callback;
+        };
+
+        std::vector<Timer> Timers;      // A heap, earliest first
+        uint64_t NextSequence = 0;
+        std::vector<Watch> Watches;
+#if defined(__linux__)
+        int EpollFd = -1;
+        std::unordered_map<int, uint32_t> Registered;   // The events that each watched descriptor is registered for
+#endif
+
+        State() = default;
+        State(const State&) = delete;
+        State& operator = (const State&) = delete;
+
+        ~State() {
+#if defined(__linux__)
+            if (EpollFd >= 0) {
+                close(EpollFd);
+            }
+#endif
+        }
+
+        static bool Later(const Timer& left, const Timer& right) {
+            return std::tie(left.Due, left.Sequence) > std::tie(right.Due, right.Sequence);
+        }
+
+        // Moves the tasks waiting for [fd] that are satisfied to [ready].
+        void TakeReady(int fd, bool readable, bool writable, std::vector<Task>& ready) {
+            for (auto watch = Watches.begin(); watch != Watches.end();) {
+                if (watch->Fd == fd && (watch->Writable ? writable : readable)) {
+                    ready.push_back(std::move(watch->Callback));
+                    watch = Watches.erase(watch);
+                } else {
+                    ++watch;
+                }
+            }
+        }
+
+#if defined(__linux__)
+        // Registers [fd] with epoll for the events that its remaining watches need.  Returns false on failure.
+        bool UpdateRegistration(int fd) {
+            uint32_t events = 0;
+            for (auto& watch : Watches) {
+                if (watch.Fd == fd) {
+                    events |= watch.Writable ? EPOLLOUT : EPOLLIN;
+                }
+            }
+
+            auto registered = Registered.find(fd);
+            if (events == 0) {
+                if (registered != Registered.end()) {
+                    // Fails harmlessly if the test case has already closed the descriptor.
+                    epoll_ctl(EpollFd, EPOLL_CTL_DEL, fd, nullptr);
+                    Registered.erase(registered);
+                }
+                return true;
+            }
+            if (registered != Registered.end() && registered->second == events) {
+                return true;
+            }
+
+            epoll_event event{};
+            event.events = events;
+            event.data.fd = fd;
+            int operation = (registered == Registered.end()) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+            if (epoll_ctl(EpollFd, operation, fd, &event) != 0) {
+                return false;
+            }
+            Registered[fd] = events;
+            return true;
+        }
+#endif
+    };
+
+    CPPUTF_INLINE std::unique_ptr<EventLoop> EventLoop::Create() {
+        auto state = std::make_unique<State>();
+#if defined(__linux__)
+        state->EpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (state->EpollFd < 0) {
+            return nullptr;
+        }
+#endif
+        return std::unique_ptr<EventLoop>{ new EventLoop(std::move(state)) };
+    }
+
+    CPPUTF_INLINE EventLoop::EventLoop(std::unique_ptr<State> state)
+      : m_state(std::move(state))
+    {}
+
+    CPPUTF_INLINE EventLoop::~EventLoop() = default;
+
+    CPPUTF_INLINE void EventLoop::After(const void* owner, Clock::duration delay, Task task) {
+        auto& timers = m_state->Timers;
+        timers.push_back({ Clock::now() + delay, m_state->NextSequence++, owner, std::move(task) });
+        std::push_heap(timers.begin(), timers.end(), State::Later);
+    }
+
+#if defined(CPPUTF_HAS_ASYNC_IO)
+    CPPUTF_INLINE void EventLoop::WhenReady(const void* owner, int fd, bool writable, Task task) {
+        m_state->Watches.push_back({ fd, writable, owner, std::move(task) });
+#if defined(__linux__)
+        if (!m_state->UpdateRegistration(fd)) {
+            // Let the task find out what is wrong with the descriptor.
+            auto watch = std::move(m_state->Watches.back());
+            m_state->Watches.pop_back();
+            After(owner, Clock::duration::zero(), std::move(watch.Callback));
+        }
+#endif
+    }
+#endif
+
+    CPPUTF_INLINE size_t EventLoop::Cancel(const void* owner) {
+        auto& state = *m_state;
+        auto owned_by = [owner](auto& entry) { return entry.Owner == owner; };
+
+        auto timers_end = std::remove_if(state.Timers.begin(), state.Timers.end(), owned_by);
+        size_t cancelled = static_cast<size_t>(state.Timers.end() - timers_end);
+        state.Timers.erase(timers_end, state.Timers.end());
+        std::make_heap(state.Timers.begin(), state.Timers.end(), State::Later);
+
+        std::vector<int> fds;
+        for (auto& watch : state.Watches) {
+            if (watch.Owner == owner) {
+                fds.push_back(watch.Fd);
+            }
+        }
+        cancelled += fds.size();
+        state.Watches.erase(std::remove_if(state.Watches.begin(), state.Watches.end(), owned_by), state.Watches.end());
+#if defined(__linux__)
+        for (int fd : fds) {
+            state.UpdateRegistration(fd);
+        }
+#endif
+        return cancelled;
+    }
+
+    CPPUTF_INLINE bool EventLoop::Empty() const {
+        return m_state->Timers.empty() && m_state->Watches.empty();
+    }
+
+    CPPUTF_INLINE void EventLoop::RunOnce(Clock::time_point deadline) {
+        auto& state = *m_state;
+
+        auto wake = deadline;
+        if (!state.Timers.empty()) {
+            wake = std::min(wake, state.Timers.front().Due);
+        }
+        // Rounded up, so that the wait never ends before a timer is due.
+        int timeout = 0;
+        if (auto now = Clock::now(); wake > now) {
+            auto milliseconds = std::chrono::ceil<std::chrono::milliseconds>(wake - now).count();
+            timeout = static_cast<int>(std::min<decltype(milliseconds)>(milliseconds, std::numeric_limits<int>::max()));
+        }
+
+        std::vector<Task> ready;
+#if defined(__linux__)
+        std::array<epoll_event, 64> events;
+        int count = epoll_wait(state.EpollFd, events.data(), static_cast<int>(events.size()), timeout);
+        for (int index = 0; index < count; ++index) {
+            int fd = events[index].data.fd;
+            auto flags = events[index].events;
+            bool error = (flags & (EPOLLERR | EPOLLHUP)) != 0;
+            state.TakeReady(fd, error || (flags & EPOLLIN) != 0, error || (flags & EPOLLOUT) != 0, ready);
+            state.UpdateRegistration(fd);
+        }
+#elif defined(CPPUTF_HAS_ASYNC_IO)
+        std::vector<pollfd> fds;
+        for (auto& watch : state.Watches) {
+            fds.push_back({ watch.Fd, static_cast<short>(watch.Writable ? POLLOUT : POLLIN), 0 });
+        }
+        if (poll(fds.data(), static_cast<nfds_t>(fds.size()), timeout) > 0) {
+            for (auto& entry : fds) {
+                bool error = (entry.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+                if (entry.revents != 0) {
+                    state.TakeReady(entry.fd, error || (entry.revents & POLLIN) != 0, error || (entry.revents & POLLOUT) != 0, ready);
+                }
+            }
+        }
+#else
+        std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+#endif
+
+        auto now = Clock::now();
+        while (!state.Timers.empty() && state.Timers.front().Due <= now) {
+            std::pop_heap(state.Timers.begin(), state.Timers.end(), State::Later);
+            ready.push_back(std::move(state.Timers.back().Callback));
+            state.Timers.pop_back();
+        }
+
+        for (auto& task : ready) {
+            task();
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // The base of ASYNC_TEST_CASE test cases.  Run() starts operations and returns, and the test case completes
+    // once every continuation that it scheduled has run.  A REQUIRE or an exception in a continuation fails the
+    // test case and drops the continuations that have not run.  A test case that has not completed by its
+    // deadline fails the same way.
+    struct AsyncTestCase {
+        using Clock = EventLoop::Clock;
+
+        virtual ~AsyncTestCase() = default;
+
+        // Runs Run(), with [loop] running the continuations it schedules.  [logger] receives the exceptions
+        // that end the test case.
+        void Start(const ILoggerPtr& logger, EventLoop* loop);
+
+        bool IsComplete() const {
+            return m_pending == 0;
+        }
+
+        bool HasFailed() const {
+            return m_failed || ChecksFailed();
+        }
+
+        Clock::time_point Deadline() const {
+            return m_started + m_timeout;
+        }
+
+        // Fails the test case if it is still running at its deadline.
+        void CheckDeadline(Clock::time_point now);
+
+        // Runs [test_case] on an event loop of its own.  Returns true if it failed.
+        static bool RunAlone(AsyncTestCase& test_case, const ILoggerPtr& logger);
+
+        // Schedules [callback] to run after [delay].
+        template <typename TRep, typename TPeriod, typename TCallback>
+        void After(const std::chrono::duration<TRep, TPeriod>& delay, TCallback callback) {
+            Schedule(std::chrono::duration_cast<Clock::duration>(delay), -1, false, Task(std::move(callback)));
+        }
+
+        // Schedules [callback] to run after the continuations that are already due.
+        template <typename TCallback>
+        void Post(TCallback callback) {
+            Schedule(Clock::duration::zero(), -1, false, Task(std::move(callback)));
+        }
+
+#if defined(CPPUTF_HAS_ASYNC_IO)
+        template <typename TCallback>
+        void WhenReadable(int fd, TCallback callback) {
+            Schedule({}, fd, false, Task(std::move(callback)));
+        }
+
+        template <typename TCallback>
+        void WhenWritable(int fd, TCallback callback) {
+            Schedule({}, fd, true, Task(std::move(callback)));
+        }
+#endif
+
+        // Replaces the default limit of 30 seconds, counted from the start of the test case.
+        template <typename TRep, typename TPeriod>
+        void SetTimeout(const std::chrono::duration<TRep, TPeriod>& timeout) {
+            m_timeout = std::chrono::duration_cast<Clock::duration>(timeout);
+        }
+
+    protected:
+        virtual void Run() = 0;
+
+    private:
+        virtual bool ChecksFailed() const = 0;
+
+        void Schedule(Clock::duration delay, int fd, bool writable, Task callback);
+        void Invoke(Task& callback);
+        void Stop();
+
+        ILoggerPtr m_logger;
+        EventLoop* m_loop = nullptr;
+        size_t m_pending = 0;
+        bool m_failed = false;
+        bool m_stopped = false;
+        Clock::time_point m_started;
+        Clock::duration m_timeout = std::chrono::seconds(30);
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE void AsyncTestCase::Start(const ILoggerPtr& logger, EventLoop* loop) {
+        m_logger = logger;
+        m_loop = loop;
+        m_started = Clock::now();
+        m_pending = 1;
+
+        Task body([this]() { Run(); });
+        Invoke(body);
+    }
+
+    CPPUTF_INLINE void AsyncTestCase::CheckDeadline(Clock::time_point now) {
+        if (IsComplete() || now < Deadline()) {
+            return;
+        }
+
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(m_timeout).count();
+        m_logger->UnhandledException(
+            "Timed out after " + std::to_string(milliseconds) + " ms with " + std::to_string(m_pending) + " operations pending"
+        );
+        Stop();
+    }
+
+    CPPUTF_INLINE bool AsyncTestCase::RunAlone(AsyncTestCase& test_case, const ILoggerPtr& logger) {
+        auto loop = EventLoop::Create();
+        if (!loop) {
+            logger->UnhandledException("Unable to create an event loop");
+            return true;
+        }
+
+        test_case.Start(logger, loop.get());
+        while (!test_case.IsComplete()) {
+            loop->RunOnce(test_case.Deadline());
+            test_case.CheckDeadline(Clock::now());
+        }
+        return test_case.HasFailed();
+    }
+
+    CPPUTF_INLINE void AsyncTestCase::Schedule(
+        [[maybe_unused]] Clock::duration delay,
+        [[maybe_unused]] int fd,
+        [[maybe_unused]] bool writable,
+        Task callback
+    ) {
+        if (m_stopped) {
+            return;
+        }
+
+        m_pending++;
+        Task continuation([this, callback = std::move(callback)]() mutable {
+            Invoke(callback);
+        });
+#if defined(CPPUTF_HAS_ASYNC_IO)
+        if (fd >= 0) {
+            m_loop->WhenReady(this, fd, writable, std::move(continuation));
+            return;
+        }
+#endif
+        m_loop->After(this, delay, std::move(continuation));
+    }
+
+    CPPUTF_INLINE void AsyncTestCase::Invoke(Task& callback) {
+        m_pending--;
+        if (m_stopped) {
+            // Already taken from the loop when the test case failed.
+            return;
+        }
+
+        try {
+            callback();
+        } catch (const AssertException&) {
+            // REQUIRE* statement failed, and has been reported.
+            Stop();
+        } catch (const std::exception& e) {
+            m_logger->UnhandledException(e.what());
+            Stop();
+        } catch (...) {
+            m_logger->UnhandledException("<unstructured>");
+            Stop();
+        }
+    }
+
+    CPPUTF_INLINE void AsyncTestCase::Stop() {
+        m_failed = true;
+        m_stopped = true;
+        m_pending -= m_loop->Cancel(this);
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // The source of time for code under test.  Code that takes an IClock, rather than reading steady_clock
+    // and sleeping directly, can be given a VirtualClock by its tests.
+    struct IClock {
+        using Duration = std::chrono::steady_clock::duration;
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        virtual ~IClock() = default;
+
+        virtual TimePoint Now() const = 0;
+        virtual void SleepFor(Duration duration) = 0;
+    };
+    using IClockPtr = std::shared_ptr<IClock>;
+
+    // The real time, from std::chrono::steady_clock.
+    struct SystemClock :
+        IClock
+    {
+        static IClockPtr Create() {
+            return std::make_shared<SystemClock>();
+        }
+
+        TimePoint Now() const override {
+            return std::chrono::steady_clock::now();
+        }
+
+        void SleepFor(Duration duration) override;
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE void SystemClock::SleepFor(Duration duration) {
+        std::this_thread::sleep_for(duration);
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // A clock that only moves when told to.  Timers scheduled with After() run when the clock passes them, in
+    // the order they are due, with Now() reporting their due time.  Sleeping moves the clock forward at once,
+    // so code that waits for seconds of virtual time finishes without waiting.  The clock may be read from
+    // any thread.  Timers run on the thread that moves the clock.
+    struct VirtualClock :
+        IClock
+    {
+        using TimerId = uint64_t;
+
+        static std::shared_ptr<VirtualClock> Create(TimePoint start = {}) {
+            return std::unique_ptr<VirtualClock>{ new VirtualClock(start) };
+        }
+
+        TimePoint Now() const override;
+
+        // Same as Advance(), so that code under test sleeping on the test's thread does not block it.
+        void SleepFor(Duration duration) override {
+            Advance(duration);
+        }
+
+        // Schedules [callback] to run once the clock has moved [delay] past the current time.
+        template <typename TRep, typename TPeriod, typename TCallback>
+        TimerId After(const std::chrono::duration<TRep, TPeriod>& delay, TCallback callback) {
+            return Schedule(std::chrono::duration_cast<Duration>(delay), Task(std::move(callback)));
+        }
+
+        // Returns false if the timer has already run or been cancelled.
+        bool Cancel(TimerId id);
+
+        size_t PendingTimers() const;
+
+        // Moves the clock forward by [duration], running the timers that fall due on the way.  Includes the
+        // timers that those timers schedule.
+        void Advance(Duration duration);
+
+        // Moves the clock to each timer in turn until none are left or [limit] have run, so that timers
+        // that keep rescheduling themselves cannot run forever.  Returns false if timers are left.
+        bool RunAll(size_t limit = 100000);
+
+    private:
+        struct Timer {
+            TimePoint Due;
+            TimerId Id;
+            Task Callback;
+        };
+
+        explicit VirtualClock(TimePoint start)
+          : m_now(start)
+        {}
+
+        TimerId Schedule(Duration delay, Task task);
+
+        // Takes the earliest timer if it is due by [until], and moves the clock to it.
+        Task TakeDue(TimePoint until);
+
+        static bool Later(const Timer& left, const Timer& right) {
+            return std::tie(left.Due, left.Id) > std::tie(right.Due, right.Id);
+        }
+
+        mutable std::mutex m_mutex;
+        TimePoint m_now;
+        TimerId m_next_id = 0;
+        std::vector<Timer> m_timers;    // A heap, earliest first
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE IClock::TimePoint VirtualClock::Now() const {
+        std::lock_guard lock(m_mutex);
+        return m_now;
+    }
+
+    CPPUTF_INLINE VirtualClock::TimerId VirtualClock::Schedule(Duration delay, Task task) {
+        std::lock_guard lock(m_mutex);
+        auto id = m_next_id++;
+        m_timers.push_back({ m_now + std::max(delay, Duration::zero()), id, std::move(task) });
+        std::push_heap(m_timers.begin(), m_timers.end(), Later);
+        return id;
+    }
+
+    CPPUTF_INLINE bool VirtualClock::Cancel(TimerId id) {
+        std::lock_guard lock(m_mutex);
+        auto timer = std::find_if(m_timers.begin(), m_timers.end(), [id](auto& entry) { return entry.Id == id; });
+        if (timer == m_timers.end()) {
+            return false;
+        }
+        m_timers.erase(timer);
+        std::make_heap(m_timers.begin(), m_timers.end(), Later);
+        return true;
+    }
+
+    CPPUTF_INLINE size_t VirtualClock::PendingTimers() const {
+        std::lock_guard lock(m_mutex);
+        return m_timers.size();
+    }
+
+    CPPUTF_INLINE void VirtualClock::Advance(Duration duration) {
+        auto until = Now() + std::max(duration, Duration::zero());
+        // The lock is not held while a timer runs, as timers may read the clock or schedule other timers.
+        while (auto task = TakeDue(until)) {
+            task();
+        }
+
+        std::lock_guard lock(m_mutex);
+        m_now = std::max(m_now, until);
+    }
+
+    CPPUTF_INLINE bool VirtualClock::RunAll(size_t limit) {
+        for (size_t count = 0; count != limit; ++count) {
+            auto task = TakeDue(TimePoint::max());
+            if (!task) {
+                return true;
+            }
+            task();
+        }
+        return PendingTimers() == 0;
+    }
+
+    CPPUTF_INLINE Task VirtualClock::TakeDue(TimePoint until) {
+        std::lock_guard lock(m_mutex);
+        if (m_timers.empty() || m_timers.front().Due > until) {
+            return {};
+        }
+
+        std::pop_heap(m_timers.begin(), m_timers.end(), Later);
+        auto timer = std::move(m_timers.back());
+        m_timers.pop_back();
+        m_now = std::max(m_now, timer.Due);
+        return std::move(timer.Callback);
+    }
+#endif
+
+    // A fixture mixin that gives test cases a VirtualClock to pass to the code under test.
+    //     struct RetryFixture : CppUnitTestFramework::VirtualClockFixture {
+    //         RetryPolicy Policy{ TestClock };
+    //     };
+    struct VirtualClockFixture {
+        const std::shared_ptr<VirtualClock> TestClock = VirtualClock::Create();
+
+        template <typename TRep, typename TPeriod>
+        void AdvanceClock(const std::chrono::duration<TRep, TPeriod>& duration) {
+            TestClock->Advance(std::chrono::duration_cast<IClock::Duration>(duration));
+        }
+
+        bool RunAllTimers(size_t limit = 100000) {
+            return TestClock->RunAll(limit);
+        }
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+
+    struct TestRegistry {
+    private:
+        using TestCallback = bool (*)(const ILoggerPtr& logger, const RunOptions* options, OutputCapture* capture);
+        using AsyncCallback = std::unique_ptr<AsyncTestCase> (*)(const ILoggerPtr& logger, EventLoop* loop);
+        struct TestDetails {
+            std::string_view Name;
+            std::string_view FixtureName;
+            std::string_view SourceFile;
+            size_t SourceLine;
+            std::vector<std::string_view> Tags;
+            TestCallback Callback;
+            AsyncCallback StartAsync = nullptr;     // Set for async test cases, which Callback runs on their own
+        };
+
+    public:
+        template <typename TTestCase>
+        struct AutoReg {
+            AutoReg() {
+                TestRegistry::Add<TTestCase>();
+            }
+        };
+
+    public:
+        template <typename TTestCase>
+        static void Add() {
+            TestDetails details;
+            details.Name = TTestCase::Name;
+            details.FixtureName = details.Name.substr(0, details.Name.rfind("::"));
+            details.SourceFile = TTestCase::SourceFile;
+            details.SourceLine = TTestCase::SourceLine;
+            details.Tags.assign(std::begin(TTestCase::Tags), std::end(TTestCase::Tags));
+            details.Callback = [](
+                const ILoggerPtr& logger,
+                [[maybe_unused]] const RunOptions* options,
+                [[maybe_unused]] OutputCapture* capture
+            ) -> bool {
+                auto run = [](TTestCase& test_case, [[maybe_unused]] const ILoggerPtr& test_logger) {
+                    if constexpr (std::is_base_of_v<AsyncTestCase, TTestCase>) {
+                        return AsyncTestCase::RunAlone(test_case, test_logger);
+                    } else {
+                        test_case.Run();
+                        return test_case.HaveChecksFailed();
+                    }
+                };
+
+#if defined(CPPUTF_HAS_FORK)
+                if (options->Isolate) {
+                    // The fixture is constructed in the child, so that a crash or side effect of its constructor
+                    // is isolated as well.  Only FIXTURE_SETUP_ONCE state is shared with later test cases.
+                    auto fixture_logger = ForwardingLogger::Create(logger);
+                    return ForkedTestRunner::Run(*fixture_logger, logger, [&]() {
+                        ILoggerPtr test_logger = fixture_logger;
+                        TTestCase test_case(test_logger);
+                        return run(test_case, test_logger);
+                    }, capture);
+                }
+#endif
+                TTestCase test_case(logger);
+                return run(test_case, logger);
+            };
+
+            if constexpr (std::is_base_of_v<AsyncTestCase, TTestCase>) {
+                details.StartAsync = [](const ILoggerPtr& logger, EventLoop* loop) -> std::unique_ptr<AsyncTestCase> {
+                    auto test_case = std::make_unique<TTestCase>(logger);
+                    test_case->Start(logger, loop);
+                    return test_case;
+                };
+            }
+
+            GetTestVector().push_back(std::move(details));
+        }
+
+        static bool Run(const RunOptions* options, const ILoggerPtr& logger);
+
+    private:
+        // Runs a single test case.  Returns true if it failed.  With [capture], the test case's output is reported
+        // to [logger] too.  Unless the test case is isolated, stdout is redirected while it runs, so [logger]
+        // must not write to it.  With [trace], the test case is also recorded on its track.
+        static bool RunTest(
+            const RunOptions* options,
+            const ILoggerPtr& logger,
+            const TestDetails& test_case,
+            OutputCapture* capture = nullptr,
+            const std::shared_ptr<TraceLogger>& trace = nullptr
+        );
+
+        // Runs the async test cases [indices] together on [loop], with at most [limit] in flight.  Each test case
+        // is reported as a whole once it completes, so reports are in completion order rather than registration
+        // order.
+        static void RunAsync(
+            const ILoggerPtr& logger,
+            EventLoop& loop,
+            size_t limit,
+            const std::vector<size_t>& indices,
+            std::vector<bool>& passed,
+            size_t& pass_count,
+            size_t& fail_count,
+            const std::shared_ptr<TraceLogger>& trace
+        );
+
+        // Runs the selected test cases on [options->Jobs] threads.  Each test case is reported as a whole once
+        // it completes, so reports are in completion order rather than registration order.
+        static void RunParallel(
+            const RunOptions* options,
+            const ILoggerPtr& logger,
+            const std::vector<bool>& selected,
+            std::vector<bool>& passed,
+            size_t& pass_count,
+            size_t& fail_count,
+            TraceRecorder* trace
+        );
+
+#if defined(CPPUTF_HAS_FORK)
+        // Hands the selected test cases out in batches to worker processes that connect to the coordinator
+        // address, and reports each test case as its worker completes it.
+        static bool RunCoordinator(const RunOptions* options, const ILoggerPtr& logger, TraceRecorder* trace);
+
+        // Runs the test cases handed out by the coordinator connected to [fd] until it has no more.  Returns false
+        // if the coordinator went away.
+        static bool RunWorker(const RunOptions* options, int fd);
+#endif
+
+        // Returns nullptr unless output is to be captured.
+        static std::unique_ptr<OutputCapture> CreateCapture(const RunOptions* options);
+
+        static std::vector<TestDetails>& GetTestVector() {
+            static std::vector<TestDetails> s_test_vector;
+            return s_test_vector;
+        }
+
+        static bool ShouldRunTest(
+            const RunOptions* options,
+            const std::string_view& test_name,
+            const std::vector<std::string_view> test_tags
+        );
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE bool TestRegistry::Run(const RunOptions* options, const ILoggerPtr& logger) {
+        const auto& all_test_cases = GetTestVector();
+
+        if (options->DiscoveryMode) {
+            for (auto& test_case : all_test_cases) {
+                // Output the test name.
+                std::cout << test_case.Name;
+
+                if (options->AdapterInfo) {
+                    // Output the source file and line number.
+                    std::cout << "," << test_case.SourceFile << "," << test_case.SourceLine;
+                }
+
+                std::cout << std::endl;
+            }
+            return true;
+        }
+
+#if defined(CPPUTF_HAS_FORK)
+        if (!options->Worker.empty()) {
+            int fd = -1;
+            try {
+                // Allow for workers that are started before the coordinator.
+                fd = Socket::Connect(options->Worker, std::chrono::seconds(30));
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+                return false;
+            }
+            return RunWorker(options, fd);
+        }
+#endif
+
+        std::unique_ptr<TraceRecorder> trace;
+        if (!options->TraceFile.empty()) {
+            trace = TraceRecorder::Create(options->TraceFile);
+            if (!trace) {
+                std::cerr << "Unable to open trace file: " << options->TraceFile << std::endl;
+                return false;
+            }
+        }
+        auto write_trace = [&]() {
+            if (trace && !trace->Write()) {
+                std::cerr << "Unable to write the trace file: " << options->TraceFile << std::endl;
+            }
+        };
+
+#if defined(CPPUTF_HAS_FORK)
+        if (!options->Coordinator.empty() || options->LocalWorkers > 0) {
+            bool passed = RunCoordinator(options, logger, trace.get());
+            write_trace();
+            return passed;
+        }
+#endif
+
+        Snapshot::CurrentSettings() = { options->SnapshotDirectory, options->UpdateSnapshots };
+        TestDataRegistry::SetLimit(options->TestDataLimit);
+        logger->BeginRun(all_test_cases.size());
+
+        // Test cases that passed last time with the same fingerprint are reported without being run.
+        std::vector<bool> cached(all_test_cases.size(), false);
+#if defined(CPPUTF_HAS_RESULT_CACHE)
+        std::optional<ResultCache> cache;
+        std::vector<uint64_t> fingerprints;
+        if (!options->CacheFile.empty()) {
+            std::vector<std::vector<uintptr_t>> entry_points;
+            std::vector<uintptr_t> all_entry_points;
+            for (auto& test_case : all_test_cases) {
+                auto& test_entry_points = entry_points.emplace_back(1, reinterpret_cast<uintptr_t>(test_case.Callback));
+                if (test_case.StartAsync) {
+                    test_entry_points.push_back(reinterpret_cast<uintptr_t>(test_case.StartAsync));
+                }
+                all_entry_points.insert(all_entry_points.end(), test_entry_points.begin(), test_entry_points.end());
+            }
+
+            cache.emplace(options, all_entry_points);
+            for (size_t index = 0; index != all_test_cases.size(); ++index) {
+                fingerprints.push_back(cache->Fingerprint(all_test_cases[index].Name, all_test_cases[index].Tags, entry_points[index]));
+            }
+        }
+#endif
+
+        // Count the test cases in each shared setup scope so that shared state can be released early.
+        std::vector<bool> selected;
+        for (size_t index = 0; index != all_test_cases.size(); ++index) {
+            auto& test_case = all_test_cases[index];
+            selected.push_back(ShouldRunTest(options, test_case.Name, test_case.Tags));
+#if defined(CPPUTF_HAS_RESULT_CACHE)
+            if (cache && selected.back() && !options->NoCache && cache->Passed(fingerprints[index])) {
+                cached[index] = true;
+                selected.back() = false;
+            }
+#endif
+            if (selected.back()) {
+                SharedSetupRegistry::AddPending(SharedSetupRegistry::ScopeKeys(test_case.FixtureName, test_case.Tags));
+            }
+        }
+
+        std::vector<bool> passed(all_test_cases.size(), false);
+        size_t pass_count = 0;
+        size_t fail_count = 0;
+        size_t skip_count = 0;
+
+        // Reports a test case that is not run.  Returns false if it is to be run.
+        auto report_not_run = [&](size_t index) {
+            if (cached[index]) {
+                logger->CachedTest(all_test_cases[index].Name);
+                passed[index] = true;
+                pass_count++;
+            } else if (!selected[index]) {
+                logger->SkipTest(all_test_cases[index].Name);
+                skip_count++;
+            }
+            return !selected[index];
+        };
+
+        if (options->Jobs > 1) {
+            for (size_t index = 0; index != all_test_cases.size(); ++index) {
+                report_not_run(index);
+            }
+            RunParallel(options, logger, selected, passed, pass_count, fail_count, trace.get());
+        } else {
+            auto capture = CreateCapture(options);
+            auto main_trace = trace ? TraceLogger::Create(trace->AddTrack("Main thread")) : nullptr;
+
+            // Async test cases share one event loop, and run when the first of them is reached.  Those that must
+            // run on their own, or in their own process, are run like any other test case.
+            std::vector<size_t> async_indices;
+            std::unique_ptr<EventLoop> async_loop;
+            if (!capture && !options->Isolate) {
+                for (size_t index = 0; index != all_test_cases.size(); ++index) {
+                    auto& test_case = all_test_cases[index];
+                    auto constraints = TestScheduler::ParseConstraints(test_case.Tags);
+                    bool exclusive = constraints.Weight == std::numeric_limits<size_t>::max() || !constraints.Exclusive.empty();
+                    if (selected[index] && test_case.StartAsync && !exclusive) {
+                        async_indices.push_back(index);
+                    }
+                }
+                if (!async_indices.empty()) {
+                    async_loop = EventLoop::Create();
+                }
+            }
+
+            for (size_t index = 0; index != all_test_cases.size(); ++index) {
+                auto& test_case = all_test_cases[index];
+                if (report_not_run(index)) {
+                    continue;
+                }
+
+                if (async_loop && std::binary_search(async_indices.begin(), async_indices.end(), index)) {
+                    if (index == async_indices.front()) {
+                        RunAsync(logger, *async_loop, options->AsyncLimit, async_indices, passed, pass_count, fail_count, main_trace);
+                    }
+                    continue;
+                }
+
+                bool test_failed = false;
+                if (capture) {
+                    // Reported once stdout is restored.
+                    auto buffer = BufferedLogger::Create();
+                    test_failed = RunTest(options, buffer, test_case, capture.get(), main_trace);
+                    logger->EnterTest(test_case.Name);
+                    buffer->Replay(*logger);
+                } else {
+                    logger->EnterTest(test_case.Name);
+                    test_failed = RunTest(options, logger, test_case, nullptr, main_trace);
+                }
+                logger->ExitTest(test_failed);
+
+                if (test_failed) {
+                    fail_count++;
+                } else {
+                    passed[index] = true;
+                    pass_count++;
+                }
+            }
+        }
+
+        SharedSetupRegistry::ReleaseAll();
+
+#if defined(CPPUTF_HAS_RESULT_CACHE)
+        if (cache) {
+            // Passes from this run, plus earlier passes of the test cases that were not selected.
+            std::vector<uint64_t> cache_passed;
+            for (size_t index = 0; index != all_test_cases.size(); ++index) {
+                bool not_selected = !selected[index] && !cached[index];
+                if (passed[index] || (not_selected && cache->Passed(fingerprints[index]))) {
+                    cache_passed.push_back(fingerprints[index]);
+                }
+            }
+            if (!cache->Save(cache_passed)) {
+                std::cerr << "Unable to write the result cache: " << options->CacheFile << std::endl;
+            }
+        }
+#endif
+
+        logger->EndRun(pass_count, fail_count, skip_count);
+        write_trace();
+
+        return (fail_count == 0);
+    }
+
+    CPPUTF_INLINE bool TestRegistry::RunTest(
+        const RunOptions* options,
+        const ILoggerPtr& logger,
+        const TestDetails& test_case,
+        OutputCapture* capture,
+        const std::shared_ptr<TraceLogger>& trace
+    ) {
+        auto test_logger = logger;
+        if (trace) {
+            trace->EnterTest(test_case.Name);
+            test_logger = MultiLogger::Create({ logger, trace });
+        }
+        SharedSetupRegistry::CurrentFixture() = test_case.FixtureName;
+
+#if defined(CPPUTF_HAS_CAPTURE)
+        if (capture) {
+            // An isolated test case redirects its own process.
+            capture->Rewind();
+            if (!options->Isolate) {
+                capture->Redirect();
+            }
+        }
+#endif
+
+        bool test_failed = true;
+        try {
+            test_failed = test_case.Callback(test_logger, options, capture);
+        } catch (const AssertException&) {
+            // REQUIRE* statement failed.  No need to do anything else.
+        } catch (const std::exception& e) {
+            test_logger->UnhandledException(e.what());
+        } catch (...) {
+            test_logger->UnhandledException("<unstructured>");
+        }
+
+#if defined(CPPUTF_HAS_CAPTURE)
+        if (capture) {
+            // The output of passing test cases is never read.
+            capture->Restore();
+            if (test_failed || options->Verbose) {
+                if (auto output = capture->Output(); !output.empty()) {
+                    logger->TestOutput(output, capture->Truncated());
+                }
+            }
+        }
+#endif
+
+        SharedSetupRegistry::CurrentFixture() = {};
+        SharedSetupRegistry::Complete(SharedSetupRegistry::ScopeKeys(test_case.FixtureName, test_case.Tags));
+        if (trace) {
+            trace->ExitTest(test_failed);
+        }
+        return test_failed;
+    }
+
+    CPPUTF_INLINE std::unique_ptr<OutputCapture> TestRegistry::CreateCapture([[maybe_unused]] const RunOptions* options) {
+#if defined(CPPUTF_HAS_CAPTURE)
+        if (options->Capture) {
+            if (auto capture = OutputCapture::Create(options->CaptureLimit)) {
+                return capture;
+            }
+            std::cerr << "Unable to create a file to capture output" << std::endl;
+        }
+#endif
+        return nullptr;
+    }
+
+    CPPUTF_INLINE void TestRegistry::RunAsync(
+        const ILoggerPtr& logger,
+        EventLoop& loop,
+        size_t limit,
+        const std::vector<size_t>& indices,
+        std::vector<bool>& passed,
+        size_t& pass_count,
+        size_t& fail_count,
+        const std::shared_ptr<TraceLogger>& trace
+    ) {
+        const auto& all_test_cases = GetTestVector();
+
+        auto report = [&](size_t index, BufferedLogger& buffer, bool test_failed) {
+            auto& test_case = all_test_cases[index];
+            logger->EnterTest(test_case.Name);
+            buffer.Replay(*logger);
+            logger->ExitTest(test_failed);
+            SharedSetupRegistry::Complete(SharedSetupRegistry::ScopeKeys(test_case.FixtureName, test_case.Tags));
+
+            if (test_failed) {
+                fail_count++;
+            } else {
+                passed[index] = true;
+                pass_count++;
+            }
+        };
+
+        struct Running {
+            size_t Index;
+            std::shared_ptr<BufferedLogger> Buffer;
+            std::unique_ptr<AsyncTestCase> TestCase;
+            std::shared_ptr<TraceLogger> Trace;
+        };
+        std::vector<Running> running;
+
+        // Starts the next test cases until [limit] are in flight.  Those that fail to start are reported at once.
+        auto next = indices.begin();
+        auto start_next = [&]() {
+            for (; next != indices.end() && running.size() < limit; ++next) {
+                auto index = *next;
+                auto& test_case = all_test_cases[index];
+                auto buffer = BufferedLogger::Create();
+                std::unique_ptr<AsyncTestCase> started;
+
+                // The test cases overlap on the thread's track.
+                ILoggerPtr test_logger = buffer;
+                std::shared_ptr<TraceLogger> test_trace;
+                if (trace) {
+                    test_trace = TraceLogger::Create(trace->Track(), index);
+                    test_trace->EnterTest(test_case.Name);
+                    test_logger = MultiLogger::Create({ buffer, test_trace });
+                }
+
+                SharedSetupRegistry::CurrentFixture() = test_case.FixtureName;
+                try {
+                    started = test_case.StartAsync(test_logger, &loop);
+                } catch (const AssertException&) {
+                    // REQUIRE* statement failed in the fixture's constructor.
+                } catch (const std::exception& e) {
+                    test_logger->UnhandledException(e.what());
+                } catch (...) {
+                    test_logger->UnhandledException("<unstructured>");
+                }
+                SharedSetupRegistry::CurrentFixture() = {};
+
+                if (started) {
+                    running.push_back({ index, std::move(buffer), std::move(started), std::move(test_trace) });
+                } else {
+                    if (test_trace) {
+                        test_trace->ExitTest(true);
+                    }
+                    report(index, *buffer, true);
+                }
+            }
+        };
+
+        start_next();
+        while (!running.empty()) {
+            auto deadline = running.front().TestCase->Deadline();
+            for (auto& entry : running) {
+                deadline = std::min(deadline, entry.TestCase->Deadline());
+            }
+            loop.RunOnce(deadline);
+
+            auto now = AsyncTestCase::Clock::now();
+            for (auto entry = running.begin(); entry != running.end();) {
+                entry->TestCase->CheckDeadline(now);
+                if (!entry->TestCase->IsComplete()) {
+                    ++entry;
+                    continue;
+                }
+
+                bool test_failed = entry->TestCase->HasFailed();
+                entry->TestCase.reset();
+                if (entry->Trace) {
+                    entry->Trace->ExitTest(test_failed);
+                }
+                report(entry->Index, *entry->Buffer, test_failed);
+                entry = running.erase(entry);
+            }
+            start_next();
+        }
+    }
+
+    CPPUTF_INLINE void TestRegistry::RunParallel(
+        const RunOptions* options,
+        const ILoggerPtr& logger,
+        const std::vector<bool>& selected,
+        std::vector<bool>& passed,
+        size_t& pass_count,
+        size_t& fail_count,
+        TraceRecorder* trace
+    ) {
+        const auto& all_test_cases = GetTestVector();
+
+        TestScheduler scheduler(options->Jobs);
+        for (size_t index = 0; index != all_test_cases.size(); ++index) {
+            if (selected[index]) {
+                scheduler.Add(index, TestScheduler::ParseConstraints(all_test_cases[index].Tags));
+            }
+        }
+
+        std::mutex logger_mutex;
+        auto worker = [&](std::shared_ptr<TraceLogger> thread_trace) {
+            // Threads share stdout, so only isolated test cases can be captured.
+            auto capture = options->Isolate ? CreateCapture(options) : nullptr;
+            while (auto index = scheduler.Take()) {
+                auto& test_case = all_test_cases[*index];
+                auto buffer = BufferedLogger::Create();
+                bool test_failed = RunTest(options, buffer, test_case, capture.get(), thread_trace);
+                scheduler.Release(*index);
+
+                std::lock_guard lock(logger_mutex);
+                logger->EnterTest(test_case.Name);
+                buffer->Replay(*logger);
+                logger->ExitTest(test_failed);
+
+                if (test_failed) {
+                    fail_count++;
+                } else {
+                    passed[*index] = true;
+                    pass_count++;
+                }
+            }
+        };
+
+        // No more threads than test cases.  If the system runs out of threads, the ones already started are
+        // enough, or else the test cases run on this thread.
+        auto thread_count = std::min<size_t>(options->Jobs, std::count(selected.begin(), selected.end(), true));
+        std::vector<std::thread> threads;
+        for (size_t thread = 0; thread != thread_count; ++thread) {
+            auto thread_trace = trace ? TraceLogger::Create(trace->AddTrack("Thread " + std::to_string(thread + 1))) : nullptr;
+            try {
+                threads.emplace_back(worker, thread_trace);
+            } catch (const std::system_error& e) {
+                std::cerr << "Unable to start test thread " << (thread + 1) << ": " << e.what() << std::endl;
+                if (threads.empty()) {
+                    worker(thread_trace);
+                }
+                break;
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+#if defined(CPPUTF_HAS_FORK)
+    CPPUTF_INLINE bool TestRegistry::RunCoordinator(const RunOptions* options, const ILoggerPtr& logger, TraceRecorder* trace) {
+        const auto& all_test_cases = GetTestVector();
+
+        // Without an address, the local workers connect over a private Unix domain socket.
+        static std::atomic<unsigned> s_run_count = 0;
+        auto address = options->Coordinator;
+        if (address.empty()) {
+            auto name = "cpputf-" + std::to_string(getpid()) + "-" + std::to_string(s_run_count++) + ".sock";
+            address = "unix:" + (std::filesystem::temp_directory_path() / name).string();
+        }
+
+        int listen_fd = -1;
+        std::string connect_address;
+        try {
+            std::tie(listen_fd, connect_address) = Socket::Listen(address);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return false;
+        }
+
+        logger->BeginRun(all_test_cases.size());
+
+        std::deque<size_t> pending;
+        std::vector<TestScheduler::Constraints> constraints(all_test_cases.size());
+        size_t skip_count = 0;
+        for (size_t index = 0; index != all_test_cases.size(); ++index) {
+            if (ShouldRunTest(options, all_test_cases[index].Name, all_test_cases[index].Tags)) {
+                pending.push_back(index);
+                constraints[index] = TestScheduler::ParseConstraints(all_test_cases[index].Tags);
+            } else {
+                logger->SkipTest(all_test_cases[index].Name);
+                skip_count++;
+            }
+        }
+
+        struct Connection {
+            int Fd;
+            std::string Input;
+            std::vector<size_t> Assigned;       // Handed out but not started yet
+            std::optional<size_t> Running;
+            std::string Events;                 // Logged so far by the running test case
+            bool Waiting = false;               // Asked for work while none was pending
+            std::shared_ptr<TraceLogger> Trace; // Records the events as they arrive
+            size_t TraceSections;               // Open in Trace
+        };
+        std::vector<Connection> connections;
+        std::vector<pid_t> local_workers;
+        size_t worker_count = 0;
+
+        size_t remaining = pending.size();
+        size_t pass_count = 0;
+        size_t fail_count = 0;
+
+        auto start_local_worker = [&]() {
+            AsyncLogger::FlushActive();
+            std::cout.flush();
+            std::cerr.flush();
+            std::fflush(nullptr);
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                AsyncLogger::DetachFromChild();
+
+                // A worker holding the other connections open would hide a crashed worker from the coordinator.
+                close(listen_fd);
+                for (auto& connection : connections) {
+                    close(connection.Fd);
+                }
+                // The coordinator is already listening, so a failure to connect means that the run is over.
+                bool completed = false;
                 try {
-                    test_failed = test_case.Callback(logger);
-                } catch (const AssertException&) {
-                    // REQUIRE* statement failed.  No need to do anything else.
-                } catch (const std::exception& e) {
-                    logger->UnhandledException(e.what());
-                } catch (...) {
-                    logger->UnhandledException("<unstructured>");
+                    completed = RunWorker(options, Socket::Connect(connect_address, std::chrono::milliseconds(0)));
+                } catch (const std::exception&) {
+                    completed = true;
+                }
+                std::cout.flush();
+                std::cerr.flush();
+                std::fflush(nullptr);
+                _exit(completed ? 0 : 1);
+            }
+            if (pid > 0) {
+                local_workers.push_back(pid);
+            }
+        };
+
+        auto send = [](const Connection& connection, EventStream::EventType type, std::string_view payload) {
+            std::string event;
+            EventStream::AppendEvent(event, type, payload);
+            EventStream::WriteAll(connection.Fd, event);    // A failure shows up as a disconnection
+        };
+
+        // Batches shrink as the run progresses, so that the last test cases are spread over the workers
+        // rather than queued behind a slow one.
+        //
+        // The tag constraints apply as they do to parallel runs, with a slot per worker.  A worker runs its batch
+        // one test case at a time, so a connection fills the slots of the heaviest test case that it holds, and
+        // holds the resources of them all until they complete.  Test cases that can't start yet are left for a
+        // later batch.
+        auto hand_out = [&](Connection& connection) {
+            size_t workers = std::max<size_t>({ connections.size(), options->LocalWorkers, 1 });
+            size_t batch_size = std::clamp<size_t>(pending.size() / (4 * workers), 1, 64);
+
+            size_t held_slots = 0;
+            std::set<std::string_view> held_resources;
+            for (auto& other : connections) {
+                if (&other == &connection) {
+                    continue;
+                }
+                size_t slots = 0;
+                auto hold = [&](size_t index) {
+                    slots = std::max(slots, std::min(constraints[index].Weight, workers));
+                    held_resources.insert(constraints[index].Exclusive.begin(), constraints[index].Exclusive.end());
+                };
+                if (other.Running) {
+                    hold(*other.Running);
+                }
+                std::for_each(other.Assigned.begin(), other.Assigned.end(), hold);
+                held_slots += slots;
+            }
+
+            std::string batch;
+            size_t batch_slots = 0;
+            size_t count = 0;
+            for (auto position = pending.begin(); position != pending.end() && count != batch_size;) {
+                auto& required = constraints[*position];
+                auto weight = std::min(required.Weight, workers);
+                bool blocked = held_slots + std::max(batch_slots, weight) > workers ||
+                    // A test case that runs alone isn't held up behind the rest of a batch, nor holds them up.
+                    (weight == workers && workers > 1 && count > 0) ||
+                    std::any_of(
+                        required.Exclusive.begin(),
+                        required.Exclusive.end(),
+                        [&](std::string_view resource) { return held_resources.count(resource) != 0; }
+                    );
+                if (blocked) {
+                    ++position;
+                    continue;
+                }
+
+                batch_slots = std::max(batch_slots, weight);
+                connection.Assigned.push_back(*position);
+                EventStream::AppendNumber(batch, *position);
+                EventStream::AppendString(batch, all_test_cases[*position].Name);
+                position = pending.erase(position);
+                count++;
+
+                if (weight == workers && workers > 1) {
+                    break;
+                }
+            }
+
+            connection.Waiting = (count == 0);
+            if (count > 0) {
+                std::string header;
+                EventStream::AppendNumber(header, count);
+                send(connection, EventStream::EventType::Batch, header + batch);
+            }
+        };
+
+        auto report = [&](Connection& connection, bool failed, std::string_view error) {
+            logger->EnterTest(all_test_cases[*connection.Running].Name);
+
+            size_t section_depth = 0;
+            std::string_view events = connection.Events;
+            while (auto event = EventStream::NextEvent(events)) {
+                EventStream::Replay(event->first, event->second, *logger, section_depth);
+            }
+            for (; section_depth > 0; --section_depth) {
+                logger->PopSection();
+            }
+            if (!error.empty()) {
+                logger->UnhandledException(error);
+            }
+
+            logger->ExitTest(failed);
+            if (connection.Trace) {
+                connection.Trace->ExitTest(failed);
+            }
+            if (failed) {
+                fail_count++;
+            } else {
+                pass_count++;
+            }
+            remaining--;
+
+            connection.Running.reset();
+            connection.Events.clear();
+        };
+
+        auto receive = [&](Connection& connection) {
+            std::string_view input = connection.Input;
+            while (auto event = EventStream::NextEvent(input)) {
+                auto payload = event->second;
+                switch (event->first) {
+                case EventStream::EventType::RequestWork:
+                    hand_out(connection);
+                    break;
+                case EventStream::EventType::EnterTest: {
+                    uint64_t index = 0;
+                    auto assigned = EventStream::ReadNumber(payload, index)
+                        ? std::find(connection.Assigned.begin(), connection.Assigned.end(), index)
+                        : connection.Assigned.end();
+                    if (assigned != connection.Assigned.end()) {
+                        connection.Assigned.erase(assigned);
+                        connection.Running = static_cast<size_t>(index);
+                        connection.Events.clear();
+                        if (connection.Trace) {
+                            connection.Trace->EnterTest(all_test_cases[*connection.Running].Name);
+                            connection.TraceSections = 0;
+                        }
+                    }
+                    break;
+                }
+                case EventStream::EventType::ExitTest: {
+                    uint64_t failed = 1;
+                    EventStream::ReadNumber(payload, failed);
+                    if (connection.Running) {
+                        report(connection, failed != 0, {});
+                    }
+                    break;
+                }
+                default:
+                    if (connection.Running) {
+                        EventStream::AppendEvent(connection.Events, event->first, payload);
+                        if (connection.Trace) {
+                            EventStream::Replay(event->first, payload, *connection.Trace, connection.TraceSections);
+                        }
+                    }
+                    break;
+                }
+            }
+            connection.Input.erase(0, connection.Input.size() - input.size());
+        };
+
+        // The test case that was running fails.  Those handed out but not started go back to the front of the queue.
+        auto disconnect = [&](size_t position) {
+            auto& connection = connections[position];
+            if (connection.Running) {
+                report(connection, true, "Worker disconnected while running the test case");
+            }
+            pending.insert(pending.begin(), connection.Assigned.begin(), connection.Assigned.end());
+            close(connection.Fd);
+            connections.erase(connections.begin() + static_cast<std::ptrdiff_t>(position));
+        };
+
+        for (size_t worker = 0; worker != options->LocalWorkers; ++worker) {
+            start_local_worker();
+        }
+
+        while (remaining > 0) {
+            std::vector<pollfd> fds{ { listen_fd, POLLIN, 0 } };
+            for (auto& connection : connections) {
+                fds.push_back({ connection.Fd, POLLIN, 0 });
+            }
+
+            if (poll(fds.data(), static_cast<nfds_t>(fds.size()), 100) > 0) {
+                // In reverse, so that a disconnection does not move the connections still to be read.
+                for (size_t position = fds.size() - 1; position > 0; --position) {
+                    if (fds[position].revents == 0) {
+                        continue;
+                    }
+
+                    auto& connection = connections[position - 1];
+                    char buffer[4096];
+                    auto received = read(connection.Fd, buffer, sizeof(buffer));
+                    if (received < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (received <= 0) {
+                        disconnect(position - 1);
+                        continue;
+                    }
+                    connection.Input.append(buffer, static_cast<size_t>(received));
+                    receive(connection);
+                }
+
+                if (fds[0].revents & POLLIN) {
+                    int fd = Socket::Accept(listen_fd);
+                    if (fd >= 0) {
+                        auto worker_trace = trace ? TraceLogger::Create(trace->AddTrack("Worker " + std::to_string(++worker_count))) : nullptr;
+                        connections.push_back({ fd, {}, {}, {}, {}, false, std::move(worker_trace), 0 });
+                    }
+                }
+            }
+
+            // A local worker killed by a crashing test case is replaced while there is work left.
+            for (auto worker = local_workers.begin(); worker != local_workers.end();) {
+                int status = 0;
+                if (waitpid(*worker, &status, WNOHANG) != *worker) {
+                    ++worker;
+                    continue;
+                }
+                worker = local_workers.erase(worker);
+                if (WIFSIGNALED(status) && remaining > 0) {
+                    start_local_worker();
+                    worker = local_workers.begin();
+                }
+            }
+
+            for (auto& connection : connections) {
+                if (connection.Waiting && !pending.empty()) {
+                    hand_out(connection);
+                }
+            }
+
+            // Only remote workers can arrive later, and only if they were told where to connect.
+            if (remaining > 0 && connections.empty() && local_workers.empty() && options->Coordinator.empty()) {
+                for (auto index : pending) {
+                    logger->EnterTest(all_test_cases[index].Name);
+                    logger->UnhandledException("No worker left to run the test case");
+                    logger->ExitTest(true);
+                    fail_count++;
+                }
+                remaining = 0;
+            }
+        }
+
+        // Closing the listening socket also turns away workers that connected after the last batch.
+        for (auto& connection : connections) {
+            send(connection, EventStream::EventType::EndOfWork, {});
+            close(connection.Fd);
+        }
+        close(listen_fd);
+        Socket::Remove(address);
+        for (auto worker : local_workers) {
+            int status = 0;
+            while (waitpid(worker, &status, 0) < 0 && errno == EINTR) {}
+        }
+
+        logger->EndRun(pass_count, fail_count, skip_count);
+        return (fail_count == 0);
+    }
+
+    CPPUTF_INLINE bool TestRegistry::RunWorker(const RunOptions* options, int fd) {
+        const auto& all_test_cases = GetTestVector();
+        Snapshot::CurrentSettings() = { options->SnapshotDirectory, options->UpdateSnapshots };
+        TestDataRegistry::SetLimit(options->TestDataLimit);
+        auto remote_logger = std::make_shared<EventStream::Logger>(fd);
+        auto capture = CreateCapture(options);
+        auto send = [fd](EventStream::EventType type, std::string_view payload) {
+            std::string event;
+            EventStream::AppendEvent(event, type, payload);
+            EventStream::WriteAll(fd, event);
+        };
+
+        std::string input;
+        bool finished = false;
+        send(EventStream::EventType::RequestWork, {});
+        while (!finished) {
+            char buffer[4096];
+            auto received = read(fd, buffer, sizeof(buffer));
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                break;  // The coordinator went away
+            }
+            input.append(buffer, static_cast<size_t>(received));
+
+            std::string_view events = input;
+            while (auto event = EventStream::NextEvent(events)) {
+                if (event->first == EventStream::EventType::EndOfWork) {
+                    finished = true;
+                    break;
+                }
+                if (event->first != EventStream::EventType::Batch) {
+                    continue;
+                }
+
+                auto batch = event->second;
+                uint64_t batch_size = 0;
+                EventStream::ReadNumber(batch, batch_size);
+                for (uint64_t count = 0; count != batch_size; ++count) {
+                    uint64_t index = 0;
+                    std::string_view name;
+                    if (!EventStream::ReadNumber(batch, index) || !EventStream::ReadString(batch, name)) {
+                        break;
+                    }
+
+                    std::string number;
+                    EventStream::AppendNumber(number, index);
+                    send(EventStream::EventType::EnterTest, number);
+
+                    bool test_failed = true;
+                    if (index < all_test_cases.size() && all_test_cases[static_cast<size_t>(index)].Name == name) {
+                        test_failed = RunTest(options, remote_logger, all_test_cases[static_cast<size_t>(index)], capture.get());
+                    } else {
+                        // The worker was built from different sources to the coordinator.
+                        remote_logger->UnhandledException("Test case not found in the worker: " + std::string(name));
+                    }
+
+                    std::string result;
+                    EventStream::AppendNumber(result, test_failed ? 1 : 0);
+                    send(EventStream::EventType::ExitTest, result);
+                }
+                send(EventStream::EventType::RequestWork, {});
+            }
+            input.erase(0, input.size() - events.size());
+        }
+
+        SharedSetupRegistry::ReleaseAll();
+        close(fd);
+        return finished;
+    }
+#endif
+
+    CPPUTF_INLINE bool TestRegistry::ShouldRunTest(
+        const RunOptions* options,
+        const std::string_view& test_name,
+        const std::vector<std::string_view> test_tags
+    ) {
+        if (options->SelectedTests && options->SelectedTests->Contains(test_name)) {
+            return true;
+        }
+        if (options->Keywords.empty()) {
+            // No keywords.  All tests match, unless a list of them was given.
+            return !options->SelectedTests;
+        }
+
+        for (auto& keyword : options->Keywords) {
+            if (test_name.find(keyword) != std::string_view::npos) {
+                return true;
+            }
+
+            for (auto& tag : test_tags) {
+                if (tag == keyword) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+
+    namespace Ext {
+        // The maximum number of container elements included by ToString().  Larger containers are truncated
+        // so that failure messages stay bounded.
+        inline size_t& MaxContainerElements() {
+            static size_t s_max_container_elements = 100;
+            return s_max_container_elements;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename T, typename = void>
+        struct IsRange : std::false_type {};
+        template <typename T>
+        struct IsRange<T, std::void_t<
+            decltype(std::begin(std::declval<const T&>())),
+            decltype(std::end(std::declval<const T&>()))
+        >> : std::true_type {};
+
+        template <typename T, typename = void>
+        struct HasSize : std::false_type {};
+        template <typename T>
+        struct HasSize<T, std::void_t<decltype(std::size(std::declval<const T&>()))>> : std::true_type {};
+
+        template <typename T, typename = void>
+        struct HasStreamOperator : std::false_type {};
+        template <typename T>
+        struct HasStreamOperator<T, std::void_t<
+            decltype(std::declval<std::ostream&>() << std::declval<const T&>())
+        >> : std::true_type {};
+
+        template <typename T, typename = void>
+        struct IsContiguousRange : std::false_type {};
+        template <typename T>
+        struct IsContiguousRange<T, std::void_t<
+            decltype(std::data(std::declval<const T&>())),
+            decltype(std::size(std::declval<const T&>()))
+        >> : std::true_type {};
+
+        template <typename T>
+        struct IsUnsupported : std::false_type {};
+
+        //----------------------------------------------------------------------------------------------------
+
+        // Appends the string form of a value to an output buffer.  Specialize this for user types to control
+        // how they appear in assertion messages, including when they are elements of a container.
+        template <typename T, typename = void>
+        struct Formatter {
+            // Absent from specializations.  See IsFormattable.
+            static constexpr bool IsGeneric = true;
+
+            static void Append(std::string& out, [[maybe_unused]] const T& value) {
+                if constexpr (std::is_null_pointer_v<T>) {
+                    // std::nullptr_t
+                    out += "nullptr";
+
+                } else if constexpr (std::is_same_v<std::nullopt_t, T>) {
+                    // std::nullopt
+                    out += "?";
+
+                } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                    // Strings are appended without a copy.
+                    if constexpr (std::is_pointer_v<T>) {
+                        if (value == nullptr) {
+                            out += "nullptr";
+                            return;
+                        }
+                    }
+                    out += std::string_view(value);
+
+                } else if constexpr (std::is_constructible_v<std::string, const T&>) {
+                    // std::string(const T&)
+                    out += std::string(value);
+
+                } else if constexpr (std::is_pointer_v<T>) {
+                    // <pointer> -> Hex address
+                    AppendHex(out, reinterpret_cast<std::uintptr_t>(value), sizeof(size_t) * 2);
+
+                } else if constexpr (std::is_enum_v<T>) {
+                    // Enum -> [<name>] <number>
+                    out += '[';
+                    out += TypeName();
+                    out += "] ";
+                    if constexpr (sizeof(std::underlying_type_t<T>) == sizeof(char)) {
+                        AppendNumber(out, static_cast<int>(value));
+                    } else {
+                        AppendNumber(out, static_cast<std::underlying_type_t<T>>(value));
+                    }
+
+                } else if constexpr (std::is_same_v<bool, T>) {
+                    // Matches std::to_string(bool)
+                    out += value ? '1' : '0';
+
+                } else if constexpr (std::is_arithmetic_v<T>) {
+                    // Integers and floating point -> <number>
+                    AppendNumber(out, value);
+
+                } else if constexpr (IsRange<T>::value) {
+                    // Containers -> { <element>, <element>, ... }
+                    AppendRange(out, value);
+
+                } else if constexpr (HasStreamOperator<T>::value) {
+                    // operator << (std::ostream&, const T&)
+                    std::ostringstream ss;
+                    ss << value;
+                    out += ss.str();
+
+                } else {
+                    static_assert(IsUnsupported<T>::value,
+                        "No string conversion for this type.  Specialize CppUnitTestFramework::Ext::Formatter.");
+                }
+            }
+
+        private:
+            template <typename TNumber>
+            static void AppendNumber(std::string& out, TNumber value) {
+                // Large enough for the shortest round-trip form of any floating point value.
+                char buffer[128];
+                auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+                out.append(buffer, result.ptr);
+            }
+
+            static void AppendHex(std::string& out, std::uintptr_t value, size_t width) {
+                char buffer[sizeof(std::uintptr_t) * 2];
+                auto result = std::to_chars(std::begin(buffer), std::end(buffer), value, 16);
+                auto length = static_cast<size_t>(result.ptr - buffer);
+
+                out += "0x";
+                if (length < width) {
+                    out.append(width - length, '0');
+                }
+                out.append(buffer, length);
+            }
+
+            static const std::string& TypeName() {
+                // typeid().name() can be slow on some platforms.  Look it up once per type.
+                static const std::string s_type_name = typeid(T).name();
+                return s_type_name;
+            }
+
+            static void AppendRange(std::string& out, const T& value) {
+                using TElement = std::decay_t<decltype(*std::begin(value))>;
+
+                const auto limit = MaxContainerElements();
+                size_t count = 0;
+                auto it = std::begin(value);
+                auto end = std::end(value);
+
+                out += '{';
+                for (; it != end && count != limit; ++it, ++count) {
+                    out += (count == 0) ? " " : ", ";
+                    Formatter<TElement>::Append(out, *it);
+                }
+
+                if (it != end) {
+                    // Report the full size rather than formatting the remaining elements.
+                    size_t total = count;
+                    if constexpr (HasSize<T>::value) {
+                        total = static_cast<size_t>(std::size(value));
+                    } else {
+                        total += static_cast<size_t>(std::distance(it, end));
+                    }
+
+                    out += ", ... (";
+                    AppendNumber(out, total);
+                    out += " elements)";
+                }
+                out += (count == 0) ? "}" : " }";
+            }
+        };
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename T>
+        struct Formatter<std::optional<T>> {
+            static void Append(std::string& out, const std::optional<T>& value) {
+                if (!value.has_value()) {
+                    Formatter<std::nullopt_t>::Append(out, std::nullopt);
+                    return;
+                }
+
+                Formatter<T>::Append(out, value.value());
+            }
+        };
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename TFirst, typename TSecond>
+        struct Formatter<std::pair<TFirst, TSecond>> {
+            static void Append(std::string& out, const std::pair<TFirst, TSecond>& value) {
+                out += '(';
+                Formatter<std::decay_t<TFirst>>::Append(out, value.first);
+                out += ", ";
+                Formatter<std::decay_t<TSecond>>::Append(out, value.second);
+                out += ')';
+            }
+        };
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename... TElements>
+        struct Formatter<std::tuple<TElements...>> {
+            static void Append(std::string& out, const std::tuple<TElements...>& value) {
+                out += '(';
+                AppendElements(out, value, std::index_sequence_for<TElements...>());
+                out += ')';
+            }
+
+        private:
+            template <size_t... Indices>
+            static void AppendElements(
+                [[maybe_unused]] std::string& out,
+                [[maybe_unused]] const std::tuple<TElements...>& value,
+                std::index_sequence<Indices...>
+            ) {
+                ((out += (Indices == 0) ? "" : ", ",
+                  Formatter<std::decay_t<TElements>>::Append(out, std::get<Indices>(value))), ...);
+            }
+        };
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename T>
+        std::string ToString(const T& value) {
+            std::string out;
+            Formatter<T>::Append(out, value);
+            return out;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        // Whether ToString() accepts a T, for output that is left out rather than failing to compile when it
+        // does not.  Specializations of Formatter are assumed to accept their types.
+        template <typename T, typename = void>
+        struct IsFormattable : std::true_type {};
+        template <typename T>
+        struct IsFormattable<T, std::enable_if_t<Formatter<T>::IsGeneric>> {
+            static constexpr bool Check() {
+                if constexpr (
+                    std::is_null_pointer_v<T> ||
+                    std::is_same_v<std::nullopt_t, T> ||
+                    std::is_convertible_v<const T&, std::string_view> ||
+                    std::is_constructible_v<std::string, const T&> ||
+                    std::is_pointer_v<T> ||
+                    std::is_enum_v<T> ||
+                    std::is_arithmetic_v<T>
+                ) {
+                    return true;
+                } else if constexpr (IsRange<T>::value) {
+                    using TElement = std::decay_t<decltype(*std::begin(std::declval<const T&>()))>;
+                    if constexpr (!std::is_same_v<TElement, T>) {
+                        return IsFormattable<TElement>::value;
+                    } else {
+                        return HasStreamOperator<T>::value;
+                    }
+                } else {
+                    return HasStreamOperator<T>::value;
                 }
+            }
+
+            static constexpr bool value = Check();
+        };
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+    //--------------------------------------------------------------------------------------------------------
+
+    namespace Simd {
+        // Returns the index of the first byte at or after [start] that differs, or [size] if none do.
+        CPPUTF_INLINE size_t FindMismatch(const unsigned char* left, const unsigned char* right, size_t size, size_t start = 0);
+
+        // Returns the index of the first element at or after [start] where [abs(left - right) > tolerance],
+        // or [size] if there are none.  NaN values are never close.
+        template <typename T>
+        size_t FindNotClose(const T* left, const T* right, size_t size, T tolerance, size_t start = 0);
+
+        // Returns the index of the first element at or after [start] where the ULP distance between [left] and
+        // [right] exceeds [max_ulps], or [size] if there are none.
+        template <typename T>
+        size_t FindNotWithinUlps(const T* left, const T* right, size_t size, uint64_t max_ulps, size_t start = 0);
+
+        // Returns the index of the first element at or after [start] where
+        // [abs(left - right) > max(absolute, relative * max(abs(left), abs(right)))], or [size] if there are
+        // none.  NaN values are never close.
+        template <typename T>
+        size_t FindNotCloseRelative(const T* left, const T* right, size_t size, T relative, T absolute, size_t start = 0);
 
-                logger->ExitTest(test_failed);
+        //----------------------------------------------------------------------------------------------------
 
-                if (test_failed) {
-                    fail_count++;
-                } else {
-                    pass_count++;
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE size_t FindMismatch(const unsigned char* left, const unsigned char* right, size_t size, size_t start) {
+            size_t index = start;
+
+#ifdef CPPUTF_SIMD_AVX2
+            for (; index + 32 <= size; index += 32) {
+                auto l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + index));
+                auto r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + index));
+                if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(l, r)) != -1) {
+                    break;
                 }
             }
+#endif
+#ifdef CPPUTF_SIMD_SSE2
+            for (; index + 16 <= size; index += 16) {
+                auto l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + index));
+                auto r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + index));
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(l, r)) != 0xFFFF) {
+                    break;
+                }
+            }
+#endif
+
+            // Handles the tail, and locates the exact byte within a block that failed above.
+            for (; index < size; ++index) {
+                if (left[index] != right[index]) {
+                    return index;
+                }
+            }
+            return size;
+        }
+#endif
+
+        //----------------------------------------------------------------------------------------------------
 
-            logger->EndRun(pass_count, fail_count, skip_count);
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        template <typename T>
+        size_t FindNotClose(const T* left, const T* right, size_t size, T tolerance, size_t start) {
+            size_t index = start;
+
+            if constexpr (std::is_same_v<T, float>) {
+#ifdef CPPUTF_SIMD_AVX2
+                const auto sign_mask8 = _mm256_set1_ps(-0.0f);
+                const auto tolerance8 = _mm256_set1_ps(tolerance);
+                for (; index + 8 <= size; index += 8) {
+                    auto l = _mm256_loadu_ps(left + index);
+                    auto r = _mm256_loadu_ps(right + index);
+                    auto diff = _mm256_andnot_ps(sign_mask8, _mm256_sub_ps(l, r));
+                    auto close = _mm256_or_ps(
+                        _mm256_cmp_ps(l, r, _CMP_EQ_OQ),
+                        _mm256_cmp_ps(diff, tolerance8, _CMP_LE_OQ)
+                    );
+                    if (_mm256_movemask_ps(close) != 0xFF) {
+                        break;
+                    }
+                }
+#endif
+#ifdef CPPUTF_SIMD_SSE2
+                const auto sign_mask = _mm_set1_ps(-0.0f);
+                const auto tolerance4 = _mm_set1_ps(tolerance);
+                for (; index + 4 <= size; index += 4) {
+                    auto l = _mm_loadu_ps(left + index);
+                    auto r = _mm_loadu_ps(right + index);
+                    auto diff = _mm_andnot_ps(sign_mask, _mm_sub_ps(l, r));
+                    auto close = _mm_or_ps(_mm_cmpeq_ps(l, r), _mm_cmple_ps(diff, tolerance4));
+                    if (_mm_movemask_ps(close) != 0xF) {
+                        break;
+                    }
+                }
+#endif
+            } else if constexpr (std::is_same_v<T, double>) {
+#ifdef CPPUTF_SIMD_AVX2
+                const auto sign_mask4 = _mm256_set1_pd(-0.0);
+                const auto tolerance4 = _mm256_set1_pd(tolerance);
+                for (; index + 4 <= size; index += 4) {
+                    auto l = _mm256_loadu_pd(left + index);
+                    auto r = _mm256_loadu_pd(right + index);
+                    auto diff = _mm256_andnot_pd(sign_mask4, _mm256_sub_pd(l, r));
+                    auto close = _mm256_or_pd(
+                        _mm256_cmp_pd(l, r, _CMP_EQ_OQ),
+                        _mm256_cmp_pd(diff, tolerance4, _CMP_LE_OQ)
+                    );
+                    if (_mm256_movemask_pd(close) != 0xF) {
+                        break;
+                    }
+                }
+#endif
+#ifdef CPPUTF_SIMD_SSE2
+                const auto sign_mask = _mm_set1_pd(-0.0);
+                const auto tolerance2 = _mm_set1_pd(tolerance);
+                for (; index + 2 <= size; index += 2) {
+                    auto l = _mm_loadu_pd(left + index);
+                    auto r = _mm_loadu_pd(right + index);
+                    auto diff = _mm_andnot_pd(sign_mask, _mm_sub_pd(l, r));
+                    auto close = _mm_or_pd(_mm_cmpeq_pd(l, r), _mm_cmple_pd(diff, tolerance2));
+                    if (_mm_movemask_pd(close) != 0x3) {
+                        break;
+                    }
+                }
+#endif
+            }
 
-            return (fail_count == 0);
+            // Handles the tail, other types, and locates the exact element within a block that failed above.
+            for (; index < size; ++index) {
+                if (!(left[index] == right[index] || std::abs(left[index] - right[index]) <= tolerance)) {
+                    return index;
+                }
+            }
+            return size;
         }
+#endif
 
-    private:
-        static std::vector<TestDetails>& GetTestVector() {
-            static std::vector<TestDetails> s_test_vector;
-            return s_test_vector;
+        //----------------------------------------------------------------------------------------------------
+
+        // Returns the distance between two values in units in the last place, i.e. the number of representable
+        // values between them.  +0 and -0 are equal, and a NaN is infinitely far from everything.
+        template <typename T>
+        uint64_t UlpDistance(T left, T right) {
+            static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>, "UlpDistance requires float or double");
+
+            if (std::isnan(left) || std::isnan(right)) {
+                return std::numeric_limits<uint64_t>::max();
+            }
+
+            // Map the sign-magnitude representation onto a monotonic unsigned scale.
+            using TBits = std::conditional_t<sizeof(T) == sizeof(uint32_t), uint32_t, uint64_t>;
+            constexpr TBits sign_bit = TBits(1) << (sizeof(TBits) * 8 - 1);
+            auto to_ordered = [](T value) {
+                TBits bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return (bits & sign_bit) ? TBits(sign_bit - (bits & ~sign_bit)) : TBits(sign_bit + bits);
+            };
+
+            auto l = to_ordered(left);
+            auto r = to_ordered(right);
+            return (l > r) ? (l - r) : (r - l);
         }
 
-        static bool ShouldRunTest(
-            const RunOptions* options,
-            const std::string_view& test_name,
-            const std::vector<std::string_view> test_tags
-        ) {
-            if (options->Keywords.empty()) {
-                // No keywords.  All tests match.
-                return true;
+        //----------------------------------------------------------------------------------------------------
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        template <typename T>
+        size_t FindNotWithinUlps(const T* left, const T* right, size_t size, uint64_t max_ulps, size_t start) {
+            size_t index = start;
+
+            // The vector paths compare signed, sign-magnitude-corrected integers.  The difference is computed
+            // with wrap-around and rejected if it overflowed.
+            if constexpr (std::is_same_v<T, float>) {
+                [[maybe_unused]] const auto max32 = static_cast<int32_t>(std::min<uint64_t>(max_ulps, std::numeric_limits<int32_t>::max()));
+#ifdef CPPUTF_SIMD_AVX2
+                const auto magnitude_mask8 = _mm256_set1_epi32(std::numeric_limits<int32_t>::max());
+                const auto max8 = _mm256_set1_epi32(max32);
+                const auto min8 = _mm256_set1_epi32(-max32);
+                auto to_signed8 = [&](__m256 value) {
+                    auto bits = _mm256_castps_si256(value);
+                    auto negative = _mm256_srai_epi32(bits, 31);
+                    auto magnitude = _mm256_and_si256(bits, magnitude_mask8);
+                    return _mm256_sub_epi32(_mm256_xor_si256(magnitude, negative), negative);
+                };
+                for (; index + 8 <= size; index += 8) {
+                    auto l = _mm256_loadu_ps(left + index);
+                    auto r = _mm256_loadu_ps(right + index);
+                    auto ml = to_signed8(l);
+                    auto mr = to_signed8(r);
+                    auto diff = _mm256_sub_epi32(ml, mr);
+                    auto overflow = _mm256_srai_epi32(
+                        _mm256_and_si256(_mm256_xor_si256(ml, mr), _mm256_xor_si256(ml, diff)), 31
+                    );
+                    auto bad = _mm256_or_si256(
+                        _mm256_or_si256(overflow, _mm256_castps_si256(_mm256_cmp_ps(l, r, _CMP_UNORD_Q))),
+                        _mm256_or_si256(_mm256_cmpgt_epi32(diff, max8), _mm256_cmpgt_epi32(min8, diff))
+                    );
+                    if (_mm256_movemask_epi8(bad) != 0) {
+                        break;
+                    }
+                }
+#endif
+#ifdef CPPUTF_SIMD_SSE2
+                const auto magnitude_mask4 = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+                const auto max4 = _mm_set1_epi32(max32);
+                const auto min4 = _mm_set1_epi32(-max32);
+                auto to_signed4 = [&](__m128 value) {
+                    auto bits = _mm_castps_si128(value);
+                    auto negative = _mm_srai_epi32(bits, 31);
+                    auto magnitude = _mm_and_si128(bits, magnitude_mask4);
+                    return _mm_sub_epi32(_mm_xor_si128(magnitude, negative), negative);
+                };
+                for (; index + 4 <= size; index += 4) {
+                    auto l = _mm_loadu_ps(left + index);
+                    auto r = _mm_loadu_ps(right + index);
+                    auto ml = to_signed4(l);
+                    auto mr = to_signed4(r);
+                    auto diff = _mm_sub_epi32(ml, mr);
+                    auto overflow = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(ml, mr), _mm_xor_si128(ml, diff)), 31);
+                    auto bad = _mm_or_si128(
+                        _mm_or_si128(overflow, _mm_castps_si128(_mm_cmpunord_ps(l, r))),
+                        _mm_or_si128(_mm_cmpgt_epi32(diff, max4), _mm_cmplt_epi32(diff, min4))
+                    );
+                    if (_mm_movemask_epi8(bad) != 0) {
+                        break;
+                    }
+                }
+#endif
+            } else if constexpr (std::is_same_v<T, double>) {
+#ifdef CPPUTF_SIMD_AVX2
+                const auto max64 = static_cast<int64_t>(std::min<uint64_t>(max_ulps, std::numeric_limits<int64_t>::max()));
+                const auto zero4 = _mm256_setzero_si256();
+                const auto magnitude_mask4 = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+                const auto max4 = _mm256_set1_epi64x(max64);
+                const auto min4 = _mm256_set1_epi64x(-max64);
+                auto to_signed4 = [&](__m256d value) {
+                    auto bits = _mm256_castpd_si256(value);
+                    auto negative = _mm256_cmpgt_epi64(zero4, bits);
+                    auto magnitude = _mm256_and_si256(bits, magnitude_mask4);
+                    return _mm256_sub_epi64(_mm256_xor_si256(magnitude, negative), negative);
+                };
+                for (; index + 4 <= size; index += 4) {
+                    auto l = _mm256_loadu_pd(left + index);
+                    auto r = _mm256_loadu_pd(right + index);
+                    auto ml = to_signed4(l);
+                    auto mr = to_signed4(r);
+                    auto diff = _mm256_sub_epi64(ml, mr);
+                    auto overflow = _mm256_cmpgt_epi64(
+                        zero4, _mm256_and_si256(_mm256_xor_si256(ml, mr), _mm256_xor_si256(ml, diff))
+                    );
+                    auto bad = _mm256_or_si256(
+                        _mm256_or_si256(overflow, _mm256_castpd_si256(_mm256_cmp_pd(l, r, _CMP_UNORD_Q))),
+                        _mm256_or_si256(_mm256_cmpgt_epi64(diff, max4), _mm256_cmpgt_epi64(min4, diff))
+                    );
+                    if (_mm256_movemask_epi8(bad) != 0) {
+                        break;
+                    }
+                }
+#endif
+#ifdef CPPUTF_SIMD_SSE2
+                // SSE2 has no 64-bit compare.  Skip identical pairs in bulk and measure the rest individually.
+                for (; index + 2 <= size; index += 2) {
+                    auto l = _mm_loadu_pd(left + index);
+                    auto r = _mm_loadu_pd(right + index);
+                    if (_mm_movemask_pd(_mm_cmpeq_pd(l, r)) == 0x3) {
+                        continue;
+                    }
+                    for (size_t lane = index; lane != index + 2; ++lane) {
+                        if (UlpDistance(left[lane], right[lane]) > max_ulps) {
+                            return lane;
+                        }
+                    }
+                }
+#endif
             }
 
-            for (auto& keyword : options->Keywords) {
-                if (test_name.find(keyword) != std::string_view::npos) {
-                    return true;
+            // Handles the tail and locates the exact element within a block that failed above.
+            for (; index < size; ++index) {
+                if (UlpDistance(left[index], right[index]) > max_ulps) {
+                    return index;
                 }
+            }
+            return size;
+        }
+#endif
+
+        //----------------------------------------------------------------------------------------------------
 
-                for (auto& tag : test_tags) {
-                    if (tag == keyword) {
-                        return true;
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        template <typename T>
+        size_t FindNotCloseRelative(const T* left, const T* right, size_t size, T relative, T absolute, size_t start) {
+            size_t index = start;
+
+            if constexpr (std::is_same_v<T, float>) {
+#ifdef CPPUTF_SIMD_AVX2
+                const auto sign_mask8 = _mm256_set1_ps(-0.0f);
+                const auto relative8 = _mm256_set1_ps(relative);
+                const auto absolute8 = _mm256_set1_ps(absolute);
+                for (; index + 8 <= size; index += 8) {
+                    auto l = _mm256_loadu_ps(left + index);
+                    auto r = _mm256_loadu_ps(right + index);
+                    auto diff = _mm256_andnot_ps(sign_mask8, _mm256_sub_ps(l, r));
+                    auto scale = _mm256_max_ps(_mm256_andnot_ps(sign_mask8, l), _mm256_andnot_ps(sign_mask8, r));
+                    auto tolerance = _mm256_max_ps(absolute8, _mm256_mul_ps(relative8, scale));
+                    auto close = _mm256_or_ps(
+                        _mm256_cmp_ps(l, r, _CMP_EQ_OQ),
+                        _mm256_cmp_ps(diff, tolerance, _CMP_LE_OQ)
+                    );
+                    if (_mm256_movemask_ps(close) != 0xFF) {
+                        break;
                     }
                 }
+#endif
+#ifdef CPPUTF_SIMD_SSE2
+                const auto sign_mask4 = _mm_set1_ps(-0.0f);
+                const auto relative4 = _mm_set1_ps(relative);
+                const auto absolute4 = _mm_set1_ps(absolute);
+                for (; index + 4 <= size; index += 4) {
+                    auto l = _mm_loadu_ps(left + index);
+                    auto r = _mm_loadu_ps(right + index);
+                    auto diff = _mm_andnot_ps(sign_mask4, _mm_sub_ps(l, r));
+                    auto scale = _mm_max_ps(_mm_andnot_ps(sign_mask4, l), _mm_andnot_ps(sign_mask4, r));
+                    auto tolerance = _mm_max_ps(absolute4, _mm_mul_ps(relative4, scale));
+                    auto close = _mm_or_ps(_mm_cmpeq_ps(l, r), _mm_cmple_ps(diff, tolerance));
+                    if (_mm_movemask_ps(close) != 0xF) {
+                        break;
+                    }
+                }
+#endif
+            } else if constexpr (std::is_same_v<T, double>) {
+#ifdef CPPUTF_SIMD_AVX2
+                const auto sign_mask4 = _mm256_set1_pd(-0.0);
+                const auto relative4 = _mm256_set1_pd(relative);
+                const auto absolute4 = _mm256_set1_pd(absolute);
+                for (; index + 4 <= size; index += 4) {
+                    auto l = _mm256_loadu_pd(left + index);
+                    auto r = _mm256_loadu_pd(right + index);
+                    auto diff = _mm256_andnot_pd(sign_mask4, _mm256_sub_pd(l, r));
+                    auto scale = _mm256_max_pd(_mm256_andnot_pd(sign_mask4, l), _mm256_andnot_pd(sign_mask4, r));
+                    auto tolerance = _mm256_max_pd(absolute4, _mm256_mul_pd(relative4, scale));
+                    auto close = _mm256_or_pd(
+                        _mm256_cmp_pd(l, r, _CMP_EQ_OQ),
+                        _mm256_cmp_pd(diff, tolerance, _CMP_LE_OQ)
+                    );
+                    if (_mm256_movemask_pd(close) != 0xF) {
+                        break;
+                    }
+                }
+#endif
+#ifdef CPPUTF_SIMD_SSE2
+                const auto sign_mask2 = _mm_set1_pd(-0.0);
+                const auto relative2 = _mm_set1_pd(relative);
+                const auto absolute2 = _mm_set1_pd(absolute);
+                for (; index + 2 <= size; index += 2) {
+                    auto l = _mm_loadu_pd(left + index);
+                    auto r = _mm_loadu_pd(right + index);
+                    auto diff = _mm_andnot_pd(sign_mask2, _mm_sub_pd(l, r));
+                    auto scale = _mm_max_pd(_mm_andnot_pd(sign_mask2, l), _mm_andnot_pd(sign_mask2, r));
+                    auto tolerance = _mm_max_pd(absolute2, _mm_mul_pd(relative2, scale));
+                    auto close = _mm_or_pd(_mm_cmpeq_pd(l, r), _mm_cmple_pd(diff, tolerance));
+                    if (_mm_movemask_pd(close) != 0x3) {
+                        break;
+                    }
+                }
+#endif
             }
 
-            return false;
+            // Handles the tail, other types, and locates the exact element within a block that failed above.
+            for (; index < size; ++index) {
+                T l = left[index];
+                T r = right[index];
+                T tolerance = std::max(absolute, relative * std::max(std::abs(l), std::abs(r)));
+                if (!(l == r || std::abs(l - r) <= tolerance)) {
+                    return index;
+                }
+            }
+            return size;
         }
-    };
+#endif
+
+#if defined(CPPUTF_SPLIT_COMPILATION)
+        // The floating point kernels are compiled once, for each element type accepted by AllClose().
+    #if defined(CPPUTF_DECLARATIONS_ONLY)
+        #define _CPPUTF_INSTANTIATE extern template
+    #else
+        #define _CPPUTF_INSTANTIATE template
+    #endif
+        #define _CPPUTF_INSTANTIATE_SIMD(T)                                                                   \
+        _CPPUTF_INSTANTIATE size_t FindNotClose<T>(const T*, const T*, size_t, T, size_t);                   \
+        _CPPUTF_INSTANTIATE size_t FindNotWithinUlps<T>(const T*, const T*, size_t, uint64_t, size_t);       \
+        _CPPUTF_INSTANTIATE size_t FindNotCloseRelative<T>(const T*, const T*, size_t, T, T, size_t);
+
+        _CPPUTF_INSTANTIATE_SIMD(float)
+        _CPPUTF_INSTANTIATE_SIMD(double)
+        _CPPUTF_INSTANTIATE size_t FindNotClose<long double>(const long double*, const long double*, size_t, long double, size_t);
+        _CPPUTF_INSTANTIATE size_t FindNotCloseRelative<long double>(const long double*, const long double*, size_t, long double, long double, size_t);
+
+        #undef _CPPUTF_INSTANTIATE_SIMD
+        #undef _CPPUTF_INSTANTIATE
+#endif
+    }
 
     //--------------------------------------------------------------------------------------------------------
     //--------------------------------------------------------------------------------------------------------
     //--------------------------------------------------------------------------------------------------------
 
-    namespace Ext {
-        template <typename T>
-        std::string ToString([[maybe_unused]] const T& value) {
-            if constexpr (std::is_null_pointer_v<T>) {
-                // std::nullptr_t
-                return "nullptr";
+    namespace Diff {
+        // Limits that keep failure messages small for very large inputs.
+        struct Limits {
+            size_t ContextLines = 3;        // Unchanged lines shown around each change
+            size_t MaxOutputLines = 100;    // Diff lines printed before the output is truncated
+            size_t MaxLineLength = 200;     // Characters printed per line
+            size_t MaxEdits = 1000;         // Myers search depth before falling back to a coarse diff
+            size_t MaxLines = 10000;        // Lines compared from the first difference before the rest is summarized
+        };
+
+        inline Limits& DefaultLimits() {
+            static Limits s_limits;
+            return s_limits;
+        }
 
-            } else if constexpr (std::is_same_v<std::nullopt_t, T>) {
-                // std::nullopt
-                return "?";
+        //----------------------------------------------------------------------------------------------------
 
-            } else if constexpr (std::is_constructible_v<std::string, const T&>) {
-                // std::string(const T&)
-                return std::string(value);
+        enum class EditType { Equal, Delete, Insert };
 
-            } else if constexpr (std::is_pointer_v<T>) {
-                // <pointer> -> Hex address
-                std::ostringstream ss;
-                ss << "0x" << std::hex << std::setfill('0') << std::setw(sizeof(size_t) * 2)
-                    << reinterpret_cast<std::uintptr_t>(value);
-                return ss.str();
+        struct Edit {
+            EditType Type;
+            size_t LeftLine;    // 0-based line index into the left text
+            size_t RightLine;   // 0-based line index into the right text
+        };
 
-            } else if constexpr (std::is_enum_v<T>) {
-                // Enum -> [<name>] <number>
-                std::ostringstream ss;
-                if constexpr (sizeof(std::underlying_type_t<T>) == sizeof(char)) {
-                    ss << "[" << typeid(T).name() << "] " << static_cast<int>(value);    
-                } else {
-                    ss << "[" << typeid(T).name() << "] " << static_cast<std::underlying_type_t<T>>(value);
+        //----------------------------------------------------------------------------------------------------
+
+        // Splits the first [max_lines] lines of text, keeping each line's terminating '\n' so that a missing
+        // final line break is reported as a difference.
+        CPPUTF_INLINE std::vector<std::string_view> SplitLines(
+            std::string_view text,
+            size_t max_lines = std::numeric_limits<size_t>::max()
+        );
+
+        // Myers' O(ND) shortest edit script between two sequences of line ids.  Returns std::nullopt if more
+        // than [max_edits] insertions and deletions are required.  Memory use is O(D^2).
+        CPPUTF_INLINE std::optional<std::vector<Edit>> ShortestEditScript(
+            const std::vector<uint32_t>& left,
+            const std::vector<uint32_t>& right,
+            size_t max_edits
+        );
+
+        // Produces a unified diff of two texts that is bounded in size regardless of the input size.  Common
+        // leading and trailing text is skipped without splitting it into lines.  The rest is diffed forward
+        // from the first difference, one window of lines at a time, until the output is full or MaxLines
+        // lines have been compared.  Lines are hashed so that the edit search compares integers rather than
+        // strings.
+        CPPUTF_INLINE std::string UnifiedDiff(
+            std::string_view left,
+            std::string_view right,
+            std::string_view left_name = "left",
+            std::string_view right_name = "right",
+            const Limits& limits = DefaultLimits()
+        );
+
+        //----------------------------------------------------------------------------------------------------
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE std::vector<std::string_view> SplitLines(std::string_view text, size_t max_lines) {
+            std::vector<std::string_view> lines;
+            size_t start = 0;
+            while (start < text.size() && lines.size() < max_lines) {
+                auto end = text.find('\n', start);
+                end = (end == std::string_view::npos) ? text.size() : end + 1;
+                lines.push_back(text.substr(start, end - start));
+                start = end;
+            }
+            return lines;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        CPPUTF_INLINE std::optional<std::vector<Edit>> ShortestEditScript(
+            const std::vector<uint32_t>& left,
+            const std::vector<uint32_t>& right,
+            size_t max_edits
+        ) {
+            const auto n = static_cast<std::ptrdiff_t>(left.size());
+            const auto m = static_cast<std::ptrdiff_t>(right.size());
+            const auto max_d = static_cast<std::ptrdiff_t>(std::min(max_edits, left.size() + right.size()));
+            const std::ptrdiff_t offset = max_d + 1;
+
+            std::vector<std::ptrdiff_t> v(static_cast<size_t>(2 * max_d + 3), 0);
+            std::vector<std::vector<std::ptrdiff_t>> trace;   // trace[d] holds v[-d-1 .. d+1] before step d
+            auto at = [&](std::vector<std::ptrdiff_t>& values, std::ptrdiff_t k) -> std::ptrdiff_t& {
+                return values[static_cast<size_t>(k + offset)];
+            };
+
+            for (std::ptrdiff_t d = 0; d <= max_d; ++d) {
+                trace.emplace_back(v.begin() + (offset - d - 1), v.begin() + (offset + d + 2));
+
+                for (std::ptrdiff_t k = -d; k <= d; k += 2) {
+                    std::ptrdiff_t x = (k == -d || (k != d && at(v, k - 1) < at(v, k + 1))) ? at(v, k + 1) : at(v, k - 1) + 1;
+                    std::ptrdiff_t y = x - k;
+                    while (x < n && y < m && left[static_cast<size_t>(x)] == right[static_cast<size_t>(y)]) {
+                        ++x;
+                        ++y;
+                    }
+                    at(v, k) = x;
+
+                    if (x < n || y < m) {
+                        continue;
+                    }
+
+                    // Reached the end.  Walk the trace backwards to recover the edits.
+                    std::vector<Edit> edits;
+                    for (std::ptrdiff_t step = d; step >= 0; --step) {
+                        auto& previous = trace[static_cast<size_t>(step)];
+                        auto prev_at = [&](std::ptrdiff_t index) { return previous[static_cast<size_t>(index + step + 1)]; };
+
+                        std::ptrdiff_t diagonal = x - y;
+                        std::ptrdiff_t prev_k = (diagonal == -step || (diagonal != step && prev_at(diagonal - 1) < prev_at(diagonal + 1)))
+                            ? diagonal + 1
+                            : diagonal - 1;
+                        std::ptrdiff_t prev_x = (step == 0) ? 0 : prev_at(prev_k);
+                        std::ptrdiff_t prev_y = (step == 0) ? 0 : prev_x - prev_k;
+
+                        while (x > prev_x && y > prev_y) {
+                            --x;
+                            --y;
+                            edits.push_back({ EditType::Equal, static_cast<size_t>(x), static_cast<size_t>(y) });
+                        }
+                        if (step > 0) {
+                            if (x == prev_x) {
+                                edits.push_back({ EditType::Insert, static_cast<size_t>(x), static_cast<size_t>(y - 1) });
+                            } else {
+                                edits.push_back({ EditType::Delete, static_cast<size_t>(x - 1), static_cast<size_t>(y) });
+                            }
+                        }
+                        x = prev_x;
+                        y = prev_y;
+                    }
+
+                    std::reverse(edits.begin(), edits.end());
+                    return edits;
                 }
-                return ss.str();
+            }
 
-            } else if constexpr (std::is_floating_point_v<T>) {
-                // float|double -> <number>
-                std::ostringstream ss;
-                ss << value;
-                return ss.str();
+            return std::nullopt;
+        }
 
-            } else {
-                // std::to_string(const T&)
-                return std::to_string(value);
+        //----------------------------------------------------------------------------------------------------
+
+        // Numbers the distinct lines of a diff window with an open-addressing table of line hashes.
+        class LineIds {
+        public:
+            explicit LineIds(size_t max_lines) {
+                size_t capacity = 16;
+                while (capacity < 2 * max_lines) {
+                    capacity *= 2;
+                }
+                m_slots.resize(capacity);
+            }
+
+            void Clear() {
+                std::fill(m_slots.begin(), m_slots.end(), 0u);
+                m_lines.clear();
+            }
+
+            uint32_t operator()(std::string_view line) {
+                const size_t hash = std::hash<std::string_view>()(line);
+                for (size_t slot = hash & (m_slots.size() - 1);; slot = (slot + 1) & (m_slots.size() - 1)) {
+                    if (m_slots[slot] == 0) {
+                        m_lines.push_back({ hash, line });
+                        m_slots[slot] = static_cast<uint32_t>(m_lines.size());
+                        return m_slots[slot] - 1;
+                    }
+                    auto& entry = m_lines[m_slots[slot] - 1];
+                    if (entry.first == hash && entry.second == line) {
+                        return m_slots[slot] - 1;
+                    }
+                }
+            }
+
+        private:
+            std::vector<uint32_t> m_slots;      // 1-based index into m_lines, or 0 for an empty slot
+            std::vector<std::pair<size_t, std::string_view>> m_lines;
+        };
+
+        //----------------------------------------------------------------------------------------------------
+
+        CPPUTF_INLINE std::string UnifiedDiff(
+            std::string_view left,
+            std::string_view right,
+            std::string_view left_name,
+            std::string_view right_name,
+            const Limits& limits
+        ) {
+            // Common prefix, backed up to the start of a line.
+            const size_t common_size = std::min(left.size(), right.size());
+            size_t prefix = Simd::FindMismatch(
+                reinterpret_cast<const unsigned char*>(left.data()),
+                reinterpret_cast<const unsigned char*>(right.data()),
+                common_size
+            );
+            const size_t first_difference = prefix;
+            auto line_start = left.substr(0, prefix).rfind('\n');
+            prefix = (line_start == std::string_view::npos) ? 0 : line_start + 1;
+
+            // Common suffix, moved forward to the start of a line.
+            size_t suffix = 0;
+            while (suffix < common_size - prefix && left[left.size() - suffix - 1] == right[right.size() - suffix - 1]) {
+                ++suffix;
             }
+            while (suffix > 0 && (left[left.size() - suffix - 1] != '\n' || right[right.size() - suffix - 1] != '\n')) {
+                --suffix;
+            }
+
+            const auto prefix_lines = static_cast<size_t>(std::count(left.begin(), left.begin() + static_cast<std::ptrdiff_t>(prefix), '\n'));
+
+            // Add context from the common prefix.
+            std::vector<std::string_view> before_lines;
+            size_t before_end = prefix;
+            while (before_lines.size() < limits.ContextLines && before_end > 0) {
+                auto start = left.substr(0, before_end - 1).rfind('\n');
+                start = (start == std::string_view::npos) ? 0 : start + 1;
+                before_lines.insert(before_lines.begin(), left.substr(start, before_end - start));
+                before_end = start;
+            }
+
+            const auto base_line = static_cast<std::ptrdiff_t>(prefix_lines) - static_cast<std::ptrdiff_t>(before_lines.size());
+
+            struct Line {
+                EditType Type;
+                size_t LeftLine;    // 0-based line in the full text
+                size_t RightLine;
+                std::string_view Text;
+            };
+            std::vector<Line> lines;
+            for (size_t i = 0; i != before_lines.size(); ++i) {
+                auto line = static_cast<size_t>(base_line) + i;
+                lines.push_back({ EditType::Equal, line, line, before_lines[i] });
+            }
+
+            // Diff the differing region a window at a time.  A window is wide enough for any edit script that
+            // the search accepts, and stops once enough changes have been found to fill the output.
+            auto left_rest = left.substr(prefix, left.size() - prefix - suffix);
+            auto right_rest = right.substr(prefix, right.size() - prefix - suffix);
+            size_t left_done = 0;
+            size_t right_done = 0;
+            size_t change_count = 0;
+            bool coarse = false;
+            const size_t window_size = std::max<size_t>(limits.MaxEdits + limits.MaxOutputLines, 1);
+            LineIds line_ids(window_size);
+            while ((!left_rest.empty() || !right_rest.empty()) && change_count < limits.MaxOutputLines) {
+                const size_t compared = std::max(left_done, right_done);
+                if (compared >= limits.MaxLines) {
+                    break;
+                }
+                auto left_lines = SplitLines(left_rest, std::min(window_size, limits.MaxLines - compared));
+                auto right_lines = SplitLines(right_rest, std::min(window_size, limits.MaxLines - compared));
+                auto covers = [](const std::vector<std::string_view>& window, std::string_view rest) {
+                    return window.empty() || (window.back().data() + window.back().size() == rest.data() + rest.size());
+                };
+                const bool last_window = covers(left_lines, left_rest) && covers(right_lines, right_rest);
+
+                line_ids.Clear();
+                std::vector<uint32_t> left_ids;
+                std::vector<uint32_t> right_ids;
+                left_ids.reserve(left_lines.size());
+                right_ids.reserve(right_lines.size());
+                for (auto& line : left_lines) {
+                    left_ids.push_back(line_ids(line));
+                }
+                for (auto& line : right_lines) {
+                    right_ids.push_back(line_ids(line));
+                }
+
+                auto edits = ShortestEditScript(left_ids, right_ids, limits.MaxEdits);
+                if (!edits) {
+                    // Too many differences for a minimal diff.  Report the whole window as replaced.
+                    coarse = true;
+                    edits.emplace();
+                    for (size_t i = 0; i != left_lines.size(); ++i) {
+                        edits->push_back({ EditType::Delete, i, 0 });
+                    }
+                    for (size_t i = 0; i != right_lines.size(); ++i) {
+                        edits->push_back({ EditType::Insert, left_lines.size(), i });
+                    }
+                } else if (!last_window) {
+                    // The edits after the last matching line might match lines beyond the window.  Leave them
+                    // to the next window.  If no line matches at all, the whole window is taken as it is.
+                    auto last_equal = std::find_if(edits->rbegin(), edits->rend(), [](const Edit& edit) {
+                        return edit.Type == EditType::Equal;
+                    });
+                    if (last_equal != edits->rend()) {
+                        edits->erase(last_equal.base(), edits->end());
+                    }
+                }
+
+                size_t left_used = 0;
+                size_t right_used = 0;
+                for (auto& edit : *edits) {
+                    auto& text = (edit.Type == EditType::Insert) ? right_lines[edit.RightLine] : left_lines[edit.LeftLine];
+                    lines.push_back({ edit.Type, prefix_lines + left_done + edit.LeftLine, prefix_lines + right_done + edit.RightLine, text });
+                    change_count += (edit.Type != EditType::Equal) ? 1 : 0;
+                    left_used += (edit.Type != EditType::Insert) ? 1 : 0;
+                    right_used += (edit.Type != EditType::Delete) ? 1 : 0;
+                }
+
+                auto skip_lines = [](std::string_view& rest, const std::vector<std::string_view>& window, size_t count) {
+                    rest.remove_prefix(count == 0 ? 0 : static_cast<size_t>(window[count - 1].data() + window[count - 1].size() - rest.data()));
+                };
+                skip_lines(left_rest, left_lines, left_used);
+                skip_lines(right_rest, right_lines, right_used);
+                left_done += left_used;
+                right_done += right_used;
+            }
+
+            // Add context from the common suffix once the whole differing region has been diffed.
+            const bool complete = left_rest.empty() && right_rest.empty();
+            if (complete && suffix > 0) {
+                auto suffix_lines = SplitLines(left.substr(left.size() - suffix), limits.ContextLines);
+                for (size_t i = 0; i != suffix_lines.size(); ++i) {
+                    lines.push_back({ EditType::Equal, prefix_lines + left_done + i, prefix_lines + right_done + i, suffix_lines[i] });
+                }
+            }
+
+            // Group the lines into hunks separated by more than 2 * ContextLines unchanged lines.
+            std::string out;
+            out += "--- ";
+            out += left_name;
+            out += "\n+++ ";
+            out += right_name;
+
+            size_t printed = 0;
+            size_t index = 0;
+            while (index < lines.size() && printed < limits.MaxOutputLines) {
+                // Find the next change.
+                size_t change = index;
+                while (change < lines.size() && lines[change].Type == EditType::Equal) {
+                    ++change;
+                }
+                if (change == lines.size()) {
+                    break;
+                }
+
+                size_t hunk_begin = (change - index > limits.ContextLines) ? change - limits.ContextLines : index;
+                size_t hunk_end = change;
+                size_t equal_run = 0;
+                for (size_t i = change; i != lines.size(); ++i) {
+                    if (lines[i].Type == EditType::Equal) {
+                        if (++equal_run > 2 * limits.ContextLines) {
+                            break;
+                        }
+                    } else {
+                        equal_run = 0;
+                        hunk_end = i + 1;
+                    }
+                }
+                hunk_end = std::min(lines.size(), hunk_end + limits.ContextLines);
+
+                size_t left_count = 0;
+                size_t right_count = 0;
+                for (size_t i = hunk_begin; i != hunk_end; ++i) {
+                    left_count += (lines[i].Type != EditType::Insert) ? 1 : 0;
+                    right_count += (lines[i].Type != EditType::Delete) ? 1 : 0;
+                }
+
+                // An empty range is numbered by the line before it, as in diff(1).
+                size_t left_first = lines[hunk_begin].LeftLine + 1;
+                size_t right_first = lines[hunk_begin].RightLine + 1;
+                out += "\n@@ -" + std::to_string(left_count ? left_first : left_first - 1) + "," + std::to_string(left_count);
+                out += " +" + std::to_string(right_count ? right_first : right_first - 1) + "," + std::to_string(right_count) + " @@";
+
+                for (size_t i = hunk_begin; i != hunk_end && printed < limits.MaxOutputLines; ++i, ++printed) {
+                    switch (lines[i].Type) {
+                    case EditType::Equal: out += "\n "; break;
+                    case EditType::Delete: out += "\n-"; break;
+                    case EditType::Insert: out += "\n+"; break;
+                    }
+
+                    auto text = lines[i].Text;
+                    bool terminated = !text.empty() && (text.back() == '\n');
+                    if (terminated) {
+                        text.remove_suffix(1);
+                    }
+                    if (text.size() > limits.MaxLineLength) {
+                        out += text.substr(0, limits.MaxLineLength);
+                        out += "... (" + std::to_string(text.size()) + " characters)";
+                    } else {
+                        out += text;
+                    }
+                    if (!terminated) {
+                        out += "\n\\ No newline at end of file";
+                    }
+                }
+
+                index = hunk_end;
+            }
+
+            auto count_lines = [](std::string_view text) {
+                auto count = static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+                return count + ((!text.empty() && text.back() != '\n') ? 1 : 0);
+            };
+            if (printed >= limits.MaxOutputLines) {
+                out += "\n... (diff truncated)";
+            } else if (!complete) {
+                out += "\n... (" + std::to_string(count_lines(left_rest)) + " more left lines and " +
+                    std::to_string(count_lines(right_rest)) + " more right lines differ)";
+            } else if (coarse) {
+                out += "\n... (too many differences for a line-by-line diff)";
+            }
+
+            // Locate the first difference, which matters for very long lines.
+            std::string header = "Texts differ at offset " + std::to_string(first_difference) + " (line " +
+                std::to_string(prefix_lines + 1) + ", column " + std::to_string(first_difference - prefix + 1) + ")";
+            header += "; sizes [" + std::to_string(left.size()) + "] and [" + std::to_string(right.size()) + "]\n";
+
+            return header + out;
         }
+#endif
 
         //----------------------------------------------------------------------------------------------------
 
+        // Returns the text of string-like values.  Null C strings have no text.
         template <typename T>
-        std::string ToString(const std::optional<T>& value) {
-            if (!value.has_value()) {
-                return ToString(std::nullopt);
+        std::optional<std::string_view> AsText([[maybe_unused]] const T& value) {
+            if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                if constexpr (std::is_pointer_v<T>) {
+                    if (value == nullptr) {
+                        return std::nullopt;
+                    }
+                }
+                return std::string_view(value);
+            } else {
+                return std::nullopt;
+            }
+        }
+
+        // Texts at least this long, or containing a line break, are reported as a diff.
+        constexpr size_t MinDiffSize = 80;
+
+        template <typename TLeft, typename TRight>
+        std::optional<std::string> DescribeTextDifference(const TLeft& left, const TRight& right) {
+            auto left_text = AsText(left);
+            auto right_text = AsText(right);
+            if (!left_text || !right_text) {
+                return std::nullopt;
             }
 
-            return ToString(value.value());
+            bool multi_line = (left_text->find('\n') != std::string_view::npos) || (right_text->find('\n') != std::string_view::npos);
+            if (!multi_line && left_text->size() < MinDiffSize && right_text->size() < MinDiffSize) {
+                return std::nullopt;
+            }
+
+            return UnifiedDiff(*left_text, *right_text);
         }
     }
 
@@ -440,6 +6731,20 @@ namespace CppUnitTestFramework {
     //--------------------------------------------------------------------------------------------------------
 
     namespace Assert {
+        CPPUTF_INLINE std::optional<AssertException> AreEqual(const char* left, const char* right);
+        CPPUTF_INLINE std::optional<AssertException> FilesEqual(const std::string& left_path, const std::string& right_path);
+        CPPUTF_INLINE std::optional<AssertException> MatchesSnapshotText(std::string_view name, std::string_view contents);
+        CPPUTF_INLINE std::optional<AssertException> IsTrue(bool value, const char* expression);
+        CPPUTF_INLINE std::optional<AssertException> IsFalse(bool value, const char* expression);
+        CPPUTF_INLINE std::optional<AssertException> Close(float left, float right, float percentage_tolerance);
+        CPPUTF_INLINE std::optional<AssertException> Close(double left, double right, double percentage_tolerance);
+        CPPUTF_INLINE std::optional<AssertException> CloseFraction(float left, float right, float fraction);
+        CPPUTF_INLINE std::optional<AssertException> CloseFraction(double left, double right, double fraction);
+        CPPUTF_INLINE std::optional<AssertException> BufferEqual(const void* left, const void* right, size_t size);
+        CPPUTF_INLINE std::optional<AssertException> CompareSizes(size_t left_size, size_t right_size);
+
+        //----------------------------------------------------------------------------------------------------
+
         template <typename TLeft, typename TRight>
         std::optional<AssertException> AreEqual(TLeft&& left, TRight&& right) {
             bool equal = static_cast<bool>(left == right);
@@ -447,20 +6752,230 @@ namespace CppUnitTestFramework {
                 return std::nullopt;
             }
 
+            if (auto diff = Diff::DescribeTextDifference(left, right)) {
+                return AssertException(std::move(*diff));
+            }
+
+            auto msg = "[" + Ext::ToString(left) + "] == [" + Ext::ToString(right) + "]";
+            return AssertException(msg.c_str());
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        // REQUIRE(a < b) expands to IsTrue(Decomposer() <= a < b, "a < b").  The <= binds before any other
+        // comparison, so the left operand is captured first and ExpressionLhs then captures the right operand
+        // along with the result.  A passing check costs the comparison and a branch; the operands are only
+        // converted to strings on failure.  Other operators (&&, ||, ?:) use the result of the comparison and
+        // report the expression text alone.
+        struct Decomposer {};
+
+        // Arithmetic operands are copied, which also allows bit-fields.
+        template <typename T>
+        using Operand = std::conditional_t<std::is_arithmetic_v<T>, T, const T&>;
+
+        template <typename TLeft, typename TRight>
+        struct BinaryExpression {
+            Operand<TLeft> Left;
+            const char* Operator;
+            Operand<TRight> Right;
+            bool Result;
+
+            explicit operator bool() const {
+                return Result;
+            }
+        };
+
+#if defined(__GNUC__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wsign-compare"
+#elif defined(_MSC_VER)
+    #pragma warning(push)
+    #pragma warning(disable: 4018 4389)     // Signed/unsigned mismatch
+#endif
+        // Comparisons such as REQUIRE(v.size() == 3) would otherwise warn once the constant is a parameter.
+        template <typename T>
+        struct ExpressionLhs {
+            Operand<T> Value;
+
+            explicit operator bool() const {
+                return static_cast<bool>(Value);
+            }
+
+            template <typename TRight>
+            BinaryExpression<T, TRight> operator == (const TRight& right) const {
+                return { Value, "==", right, static_cast<bool>(Value == right) };
+            }
+            template <typename TRight>
+            BinaryExpression<T, TRight> operator != (const TRight& right) const {
+                return { Value, "!=", right, static_cast<bool>(Value != right) };
+            }
+            template <typename TRight>
+            BinaryExpression<T, TRight> operator < (const TRight& right) const {
+                return { Value, "<", right, static_cast<bool>(Value < right) };
+            }
+            template <typename TRight>
+            BinaryExpression<T, TRight> operator <= (const TRight& right) const {
+                return { Value, "<=", right, static_cast<bool>(Value <= right) };
+            }
+            template <typename TRight>
+            BinaryExpression<T, TRight> operator > (const TRight& right) const {
+                return { Value, ">", right, static_cast<bool>(Value > right) };
+            }
+            template <typename TRight>
+            BinaryExpression<T, TRight> operator >= (const TRight& right) const {
+                return { Value, ">=", right, static_cast<bool>(Value >= right) };
+            }
+
+            // These bind more loosely than <=, as in REQUIRE(flags & mask).
+            template <typename TRight>
+            auto operator & (const TRight& right) const { return Value & right; }
+            template <typename TRight>
+            auto operator | (const TRight& right) const { return Value | right; }
+            template <typename TRight>
+            auto operator ^ (const TRight& right) const { return Value ^ right; }
+        };
+#if defined(__GNUC__)
+    #pragma GCC diagnostic pop
+#elif defined(_MSC_VER)
+    #pragma warning(pop)
+#endif
+
+        template <typename T, std::enable_if_t<!std::is_arithmetic_v<T>, int> = 0>
+        ExpressionLhs<T> operator <= (Decomposer, const T& value) {
+            return { value };
+        }
+        template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+        ExpressionLhs<T> operator <= (Decomposer, T value) {
+            return { value };
+        }
+
+        // "<assertion>(<expression>): [<left>] <operator> [<right>]", leaving out the values if they cannot be
+        // converted to strings.
+        template <typename TLeft, typename TRight>
+        AssertException DescribeExpression(const char* assertion, const char* expression, const BinaryExpression<TLeft, TRight>& decomposed) {
+            std::string message = assertion;
+            message += '(';
+            message += expression;
+            message += ')';
+            if constexpr (Ext::IsFormattable<TLeft>::value && Ext::IsFormattable<TRight>::value) {
+                message += ": [" + Ext::ToString(decomposed.Left) + "] " + decomposed.Operator + " [" + Ext::ToString(decomposed.Right) + "]";
+            }
+            return AssertException(std::move(message));
+        }
+
+        template <typename TLeft, typename TRight>
+        std::optional<AssertException> IsTrue(const BinaryExpression<TLeft, TRight>& decomposed, const char* expression) {
+            if (decomposed.Result) {
+                return std::nullopt;
+            }
+            return DescribeExpression("IsTrue", expression, decomposed);
+        }
+        template <typename T>
+        std::optional<AssertException> IsTrue(const ExpressionLhs<T>& value, const char* expression) {
+            return IsTrue(static_cast<bool>(value), expression);
+        }
+
+        template <typename TLeft, typename TRight>
+        std::optional<AssertException> IsFalse(const BinaryExpression<TLeft, TRight>& decomposed, const char* expression) {
+            if (!decomposed.Result) {
+                return std::nullopt;
+            }
+            return DescribeExpression("IsFalse", expression, decomposed);
+        }
+        template <typename T>
+        std::optional<AssertException> IsFalse(const ExpressionLhs<T>& value, const char* expression) {
+            return IsFalse(static_cast<bool>(value), expression);
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE std::optional<AssertException> AreEqual(const char* left, const char* right) {
+            bool equal = (std::strcmp(left, right) == 0);
+            if (equal) {
+                return std::nullopt;
+            }
+
+            if (auto diff = Diff::DescribeTextDifference(left, right)) {
+                return AssertException(std::move(*diff));
+            }
+
             auto msg = "[" + Ext::ToString(left) + "] == [" + Ext::ToString(right) + "]";
             return AssertException(msg.c_str());
         }
 
+
+        //----------------------------------------------------------------------------------------------------
+
+        CPPUTF_INLINE std::optional<AssertException> FilesEqual(const std::string& left_path, const std::string& right_path) {
+            auto left = MappedFile::Open(left_path);
+            if (!left) {
+                return AssertException("Unable to read file: " + left_path);
+            }
+            auto right = MappedFile::Open(right_path);
+            if (!right) {
+                return AssertException("Unable to read file: " + right_path);
+            }
+
+            if (left->Contents() == right->Contents()) {
+                return std::nullopt;
+            }
+            return AssertException(Diff::UnifiedDiff(left->Contents(), right->Contents(), left_path, right_path));
+        }
+#endif
+
         //----------------------------------------------------------------------------------------------------
 
-        inline std::optional<AssertException> AreEqual(const char* left, const char* right) {
-            bool equal = (std::strcmp(left, right) == 0);
-            if (equal) {
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE std::optional<AssertException> MatchesSnapshotText(std::string_view name, std::string_view contents) {
+            auto path = Snapshot::PathFor(name);
+            std::error_code error;
+            auto file_size = std::filesystem::file_size(path, error);
+
+            std::shared_ptr<MappedFile> file;
+            if (!error && file_size == contents.size()) {
+                file = MappedFile::Open(path.string());
+                if (file && file->Contents() == contents) {
+                    return std::nullopt;
+                }
+            }
+
+            if (Snapshot::CurrentSettings().Update) {
+                file.reset();
+                if (!Snapshot::Write(path, contents)) {
+                    return AssertException("Unable to write snapshot: " + path.string());
+                }
                 return std::nullopt;
             }
 
-            auto msg = "[" + Ext::ToString(left) + "] == [" + Ext::ToString(right) + "]";
-            return AssertException(msg.c_str());
+            if (error) {
+                return AssertException("Snapshot not found: " + path.string() + " (run with --update_snapshots to create it)");
+            }
+            if (!file) {
+                file = MappedFile::Open(path.string());
+                if (!file) {
+                    return AssertException("Unable to read snapshot: " + path.string());
+                }
+            }
+            return AssertException(Diff::UnifiedDiff(file->Contents(), contents, path.string(), "actual"));
+        }
+#endif
+
+        // Compares [value] against the snapshot file [name].  Strings are stored as-is and other values are
+        // converted with Ext::ToString().  The file is only read when its size matches, and then directly
+        // from a memory mapping.
+        template <typename T>
+        std::optional<AssertException> MatchesSnapshot(std::string_view name, const T& value) {
+            std::string converted;
+            std::string_view contents;
+            if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+                contents = std::string_view(value);
+            } else {
+                converted = Ext::ToString(value);
+                contents = converted;
+            }
+
+            return MatchesSnapshotText(name, contents);
         }
 
         //----------------------------------------------------------------------------------------------------
@@ -491,7 +7006,8 @@ namespace CppUnitTestFramework {
 
         //----------------------------------------------------------------------------------------------------
 
-        inline std::optional<AssertException> IsTrue(bool value, const char* expression) {
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE std::optional<AssertException> IsTrue(bool value, const char* expression) {
             if (!value) {
                 std::ostringstream ss;
                 ss << "IsTrue(" << expression << ")";
@@ -502,7 +7018,7 @@ namespace CppUnitTestFramework {
 
         //----------------------------------------------------------------------------------------------------
 
-        inline std::optional<AssertException> IsFalse(bool value, const char* expression) {
+        CPPUTF_INLINE std::optional<AssertException> IsFalse(bool value, const char* expression) {
             if (value) {
                 std::ostringstream ss;
                 ss << "IsFalse(" << expression << ")";
@@ -510,6 +7026,7 @@ namespace CppUnitTestFramework {
             }
             return std::nullopt;
         }
+#endif
 
         //----------------------------------------------------------------------------------------------------
 
@@ -554,7 +7071,8 @@ namespace CppUnitTestFramework {
 
         //----------------------------------------------------------------------------------------------------
 
-        inline std::optional<AssertException> Close(float left, float right, float percentage_tolerance) {
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE std::optional<AssertException> Close(float left, float right, float percentage_tolerance) {
             // Code based on BOOST_CHECK_CLOSE
             auto safe_div = [](float a, float b) -> float {
                 // Avoid overflow.
@@ -588,12 +7106,12 @@ namespace CppUnitTestFramework {
 
         //----------------------------------------------------------------------------------------------------
 
-        inline std::optional<AssertException> Close(double left, double right, double percentage_tolerance) {
+        CPPUTF_INLINE std::optional<AssertException> Close(double left, double right, double percentage_tolerance) {
             // Code based on BOOST_CHECK_CLOSE
             auto safe_div = [](double a, double b) -> double {
                 // Avoid overflow.
                 if ((b < 1.0) && (a > b*std::numeric_limits<double>::max())) {
-                    return std::numeric_limits<float>::max();
+                    return std::numeric_limits<double>::max();
                 }
 
                 // Avoid underflow.
@@ -622,7 +7140,7 @@ namespace CppUnitTestFramework {
 
         //----------------------------------------------------------------------------------------------------
 
-        inline std::optional<AssertException> CloseFraction(float left, float right, float fraction) {
+        CPPUTF_INLINE std::optional<AssertException> CloseFraction(float left, float right, float fraction) {
             float diff = std::abs(left - right);
             if (diff <= fraction) {
                 return std::nullopt;
@@ -636,7 +7154,7 @@ namespace CppUnitTestFramework {
 
         //----------------------------------------------------------------------------------------------------
 
-        inline std::optional<AssertException> CloseFraction(double left, double right, double fraction) {
+        CPPUTF_INLINE std::optional<AssertException> CloseFraction(double left, double right, double fraction) {
             double diff = std::abs(left - right);
             if (diff <= fraction) {
                 return std::nullopt;
@@ -647,6 +7165,399 @@ namespace CppUnitTestFramework {
             ss << "[" << diff << "] exceeds " << fraction;
             return AssertException(ss.str());
         }
+#endif
+
+        //----------------------------------------------------------------------------------------------------
+
+        // The maximum number of individual mismatches listed by RangeEqual(), BufferEqual() and AllClose().
+        inline size_t& MaxReportedMismatches() {
+            static size_t s_max_reported_mismatches = 10;
+            return s_max_reported_mismatches;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        // Lists the first few mismatches found by [find_next] followed by the total count.  [find_next(index)]
+        // returns the next mismatching index at or after [index], or [size] if there are none.
+        template <typename TFindNext, typename TDescribe>
+        std::string DescribeMismatches(
+            size_t first,
+            size_t size,
+            const char* element_name,
+            const TFindNext& find_next,
+            const TDescribe& describe
+        ) {
+            std::string details;
+            size_t count = 0;
+            for (size_t index = first; index < size; index = find_next(index + 1)) {
+                if (count < MaxReportedMismatches()) {
+                    details += "\n    ";
+                    describe(details, index);
+                }
+                count++;
+            }
+
+            if (count > MaxReportedMismatches()) {
+                details += "\n    ... (" + std::to_string(count - MaxReportedMismatches()) + " more)";
+            }
+
+            return std::to_string(count) + " of " + std::to_string(size) + " " + element_name + " differ:" + details;
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE std::optional<AssertException> BufferEqual(const void* left, const void* right, size_t size) {
+            auto left_bytes = static_cast<const unsigned char*>(left);
+            auto right_bytes = static_cast<const unsigned char*>(right);
+
+            auto first = Simd::FindMismatch(left_bytes, right_bytes, size);
+            if (first == size) {
+                return std::nullopt;
+            }
+
+            static constexpr char s_hex[] = "0123456789abcdef";
+            auto append_hex = [](std::string& out, size_t value, size_t digits) {
+                for (size_t digit = digits; digit-- > 0;) {
+                    out += s_hex[(value >> (digit * 4)) & 0xF];
+                }
+            };
+
+            std::string msg = "Buffers differ: " + DescribeMismatches(
+                first,
+                size,
+                "bytes",
+                [&](size_t index) { return Simd::FindMismatch(left_bytes, right_bytes, size, index); },
+                [&](std::string& out, size_t index) {
+                    out += "@0x";
+                    append_hex(out, index, 8);
+                    out += ": [0x";
+                    append_hex(out, left_bytes[index], 2);
+                    out += "] != [0x";
+                    append_hex(out, right_bytes[index], 2);
+                    out += "]";
+                }
+            );
+
+            // Hex dump of the rows around the first mismatch.  Rows that differ are marked with '*'.
+            constexpr size_t row_size = 16;
+            size_t row_begin = (first / row_size > 0) ? (first / row_size - 1) * row_size : 0;
+            size_t row_end = std::min(size, (first / row_size + 2) * row_size);
+
+            msg += "\n    offset    left" + std::string(row_size * 3 - 3, ' ') + "right";
+            for (size_t row = row_begin; row < row_end; row += row_size) {
+                size_t row_length = std::min(row_size, size - row);
+                bool row_differs = (std::memcmp(left_bytes + row, right_bytes + row, row_length) != 0);
+
+                msg += row_differs ? "\n  * " : "\n    ";
+                append_hex(msg, row, 8);
+                for (const unsigned char* bytes : { left_bytes, right_bytes }) {
+                    msg += "  ";
+                    for (size_t i = 0; i != row_size; ++i) {
+                        if (i < row_length) {
+                            append_hex(msg, bytes[row + i], 2);
+                            msg += ' ';
+                        } else {
+                            msg += "   ";
+                        }
+                    }
+                }
+            }
+
+            return AssertException(std::move(msg));
+        }
+#endif
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename TLeft, typename TRight>
+        std::optional<AssertException> RangeEqual(const TLeft& left, const TRight& right) {
+            using TLeftElement = std::decay_t<decltype(*std::begin(left))>;
+            using TRightElement = std::decay_t<decltype(*std::begin(right))>;
+
+            const size_t left_size = static_cast<size_t>(std::distance(std::begin(left), std::end(left)));
+            const size_t right_size = static_cast<size_t>(std::distance(std::begin(right), std::end(right)));
+            const size_t size = std::min(left_size, right_size);
+
+            // Random access to the elements for reporting and the generic comparison.
+            auto left_at = [&](size_t index) { return std::next(std::begin(left), static_cast<std::ptrdiff_t>(index)); };
+            auto right_at = [&](size_t index) { return std::next(std::begin(right), static_cast<std::ptrdiff_t>(index)); };
+
+            auto report = [&](const auto& find_next) -> std::optional<AssertException> {
+                auto first = find_next(0);
+                if (first == size && left_size == right_size) {
+                    return std::nullopt;
+                }
+
+                std::string msg;
+                if (left_size != right_size) {
+                    msg = "Range sizes differ: [" + std::to_string(left_size) + "] != [" + std::to_string(right_size) + "]";
+                    if (first == size) {
+                        return AssertException(std::move(msg));
+                    }
+                    msg += "\n";
+                }
+
+                msg += "Ranges differ: " + DescribeMismatches(
+                    first,
+                    size,
+                    "elements",
+                    find_next,
+                    [&](std::string& out, size_t index) {
+                        out += "[" + std::to_string(index) + "]: [";
+                        Ext::Formatter<TLeftElement>::Append(out, *left_at(index));
+                        out += "] != [";
+                        Ext::Formatter<TRightElement>::Append(out, *right_at(index));
+                        out += "]";
+                    }
+                );
+                return AssertException(std::move(msg));
+            };
+
+            if constexpr (
+                Ext::IsContiguousRange<TLeft>::value &&
+                Ext::IsContiguousRange<TRight>::value &&
+                std::is_same_v<TLeftElement, TRightElement> &&
+                std::has_unique_object_representations_v<TLeftElement>
+            ) {
+                // Bitwise equality is the same as operator ==.  Compare as bytes.
+                auto left_bytes = reinterpret_cast<const unsigned char*>(std::data(left));
+                auto right_bytes = reinterpret_cast<const unsigned char*>(std::data(right));
+                return report([=](size_t index) {
+                    auto byte = Simd::FindMismatch(left_bytes, right_bytes, size * sizeof(TLeftElement), index * sizeof(TLeftElement));
+                    return byte / sizeof(TLeftElement);
+                });
+            } else {
+                return report([&](size_t index) {
+                    auto l = left_at(index);
+                    auto r = right_at(index);
+                    for (; index < size; ++index, ++l, ++r) {
+                        if (!static_cast<bool>(*l == *r)) {
+                            break;
+                        }
+                    }
+                    return index;
+                });
+            }
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        // Checks two contiguous floating point ranges element by element.  [find_next(index)] returns the next
+        // element at or after [index] that fails the comparison.  [error(index)] measures how far apart an
+        // element pair is and is only used to build the failure message, which lists the largest error and a
+        // histogram of error magnitudes in powers of [histogram_base] (2 or 10).
+        template <typename T, typename TFindNext, typename TError>
+        std::optional<AssertException> ElementsClose(
+            const T* left,
+            const T* right,
+            size_t size,
+            const std::string& criteria,
+            const TFindNext& find_next,
+            const TError& error,
+            int histogram_base
+        ) {
+            auto first = find_next(0);
+            if (first == size) {
+                return std::nullopt;
+            }
+
+            std::string msg = "Ranges are not " + criteria + ": " + DescribeMismatches(
+                first,
+                size,
+                "elements",
+                find_next,
+                [&](std::string& out, size_t index) {
+                    out += "[" + std::to_string(index) + "]: [";
+                    Ext::Formatter<T>::Append(out, left[index]);
+                    out += "] != [";
+                    Ext::Formatter<T>::Append(out, right[index]);
+                    out += "]";
+                }
+            );
+
+            // Scan every element.  This only happens once the comparison has already failed.  Finite errors are
+            // counted by exponent, which for a double lies in [MinExponent, MaxExponent] in either base.
+            constexpr int MinExponent = std::numeric_limits<double>::min_exponent - std::numeric_limits<double>::digits;
+            constexpr int MaxExponent = std::numeric_limits<double>::max_exponent;
+            std::array<size_t, MaxExponent - MinExponent + 1> bucket_counts = {};
+            size_t max_index = first;
+            double max_error = error(first);
+            size_t zero_count = 0;
+            size_t infinity_count = 0;
+            size_t nan_count = 0;
+            for (size_t index = 0; index != size; ++index) {
+                double element_error = error(index);
+                if (std::isnan(element_error)) {
+                    nan_count++;
+                } else if (std::isinf(element_error)) {
+                    infinity_count++;
+                } else if (element_error == 0) {
+                    zero_count++;
+                } else {
+                    auto bucket = (histogram_base == 2)
+                        ? std::ilogb(element_error)
+                        : static_cast<int>(std::floor(std::log10(element_error)));
+                    bucket_counts[static_cast<size_t>(bucket - MinExponent)]++;
+                }
+
+                if (!std::isnan(max_error) && (std::isnan(element_error) || element_error > max_error)) {
+                    max_error = element_error;
+                    max_index = index;
+                }
+            }
+
+            msg += "\n    Largest error: [" + Ext::ToString(max_error) + "] at [" + std::to_string(max_index) + "]";
+            msg += "\n    Error histogram:";
+            auto append_bucket = [&](const std::string& label, size_t count) {
+                msg += "\n      " + label + std::string(label.size() < 24 ? 24 - label.size() : 1, ' ') + std::to_string(count);
+            };
+            if (zero_count > 0) {
+                append_bucket("0", zero_count);
+            }
+            auto bucket_label = [&](int bucket) {
+                if (histogram_base == 2) {
+                    return Ext::ToString(std::ldexp(1.0, bucket));
+                }
+                return "1e" + std::to_string(bucket);
+            };
+            for (int bucket = MinExponent; bucket <= MaxExponent; ++bucket) {
+                if (auto count = bucket_counts[static_cast<size_t>(bucket - MinExponent)]) {
+                    append_bucket("[" + bucket_label(bucket) + ", " + bucket_label(bucket + 1) + ")", count);
+                }
+            }
+            if (infinity_count > 0) {
+                append_bucket("inf", infinity_count);
+            }
+            if (nan_count > 0) {
+                append_bucket("NaN", nan_count);
+            }
+
+            return AssertException(std::move(msg));
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        // Returns the contiguous data of two floating point ranges of the same type and size.
+        template <typename TLeft, typename TRight>
+        auto FloatingPointRanges(const TLeft& left, const TRight& right) {
+            using TElement = std::decay_t<decltype(*std::data(left))>;
+            static_assert(std::is_floating_point_v<TElement>, "Requires contiguous floating point ranges");
+            static_assert(
+                std::is_same_v<TElement, std::decay_t<decltype(*std::data(right))>>,
+                "Requires ranges with the same element type"
+            );
+
+            const TElement* left_data = std::data(left);
+            const TElement* right_data = std::data(right);
+            return std::make_tuple(left_data, right_data, static_cast<size_t>(std::size(left)));
+        }
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+        CPPUTF_INLINE std::optional<AssertException> CompareSizes(size_t left_size, size_t right_size) {
+            if (left_size == right_size) {
+                return std::nullopt;
+            }
+            return AssertException(
+                "Range sizes differ: [" + std::to_string(left_size) + "] != [" + std::to_string(right_size) + "]"
+            );
+        }
+#endif
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename TLeft, typename TRight, typename TTolerance>
+        std::optional<AssertException> AllClose(const TLeft& left, const TRight& right, TTolerance tolerance) {
+            if (auto exception = CompareSizes(std::size(left), std::size(right))) {
+                return exception;
+            }
+
+            auto [left_data, right_data, size] = FloatingPointRanges(left, right);
+            using TElement = std::decay_t<decltype(*left_data)>;
+            const auto element_tolerance = static_cast<TElement>(tolerance);
+
+            return ElementsClose(
+                left_data,
+                right_data,
+                size,
+                "within [" + Ext::ToString(element_tolerance) + "]",
+                [&](size_t index) { return Simd::FindNotClose(left_data, right_data, size, element_tolerance, index); },
+                [&](size_t index) {
+                    if (left_data[index] == right_data[index]) {
+                        return 0.0;
+                    }
+                    return static_cast<double>(std::abs(left_data[index] - right_data[index]));
+                },
+                10
+            );
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename TLeft, typename TRight>
+        std::optional<AssertException> AllCloseUlps(const TLeft& left, const TRight& right, uint64_t max_ulps) {
+            if (auto exception = CompareSizes(std::size(left), std::size(right))) {
+                return exception;
+            }
+
+            auto [left_data, right_data, size] = FloatingPointRanges(left, right);
+
+            return ElementsClose(
+                left_data,
+                right_data,
+                size,
+                "within [" + std::to_string(max_ulps) + "] ulps",
+                [&](size_t index) { return Simd::FindNotWithinUlps(left_data, right_data, size, max_ulps, index); },
+                [&](size_t index) {
+                    auto distance = Simd::UlpDistance(left_data[index], right_data[index]);
+                    if (distance == std::numeric_limits<uint64_t>::max()) {
+                        return std::numeric_limits<double>::quiet_NaN();
+                    }
+                    return static_cast<double>(distance);
+                },
+                2
+            );
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        template <typename TLeft, typename TRight, typename TRelative, typename TAbsolute>
+        std::optional<AssertException> AllCloseRelative(
+            const TLeft& left,
+            const TRight& right,
+            TRelative relative,
+            TAbsolute absolute
+        ) {
+            if (auto exception = CompareSizes(std::size(left), std::size(right))) {
+                return exception;
+            }
+
+            auto [left_data, right_data, size] = FloatingPointRanges(left, right);
+            using TElement = std::decay_t<decltype(*left_data)>;
+            const auto element_relative = static_cast<TElement>(relative);
+            const auto element_absolute = static_cast<TElement>(absolute);
+
+            return ElementsClose(
+                left_data,
+                right_data,
+                size,
+                "within relative [" + Ext::ToString(element_relative) + "] or absolute [" +
+                    Ext::ToString(element_absolute) + "]",
+                [&](size_t index) {
+                    return Simd::FindNotCloseRelative(left_data, right_data, size, element_relative, element_absolute, index);
+                },
+                [&](size_t index) {
+                    // Relative error: |left - right| / max(|left|, |right|)
+                    double l = left_data[index];
+                    double r = right_data[index];
+                    if (l == r) {
+                        return 0.0;
+                    }
+                    return std::abs(l - r) / std::max(std::abs(l), std::abs(r));
+                },
+                10
+            );
+        }
 
     }
 
@@ -714,15 +7625,26 @@ namespace CppUnitTestFramework {
                 return;
             }
 
-            m_logger->AssertFailed(behavior, location, exception00->what());
+            {
+                // STRESS_TEST bodies assert from several threads at once.
+                std::lock_guard lock(m_failure_mutex);
+                m_logger->AssertFailed(behavior, location, exception00->what());
+                if (behavior == AssertType::Continue) {
+                    m_check_has_failed = true;
+                }
+            }
 
             if (behavior == AssertType::Throw) {
                 throw *exception00;
-            } else {
-                m_check_has_failed = true;
             }
         }
 
+        // Reports a measurement, such as a throughput, with the test case's result.
+        void ReportMetric(const std::string_view& name, double value) {
+            std::lock_guard lock(m_failure_mutex);
+            m_logger->TestMetric(name, value);
+        }
+
         // In leiu of std::make_array()
         template <typename... TArgs>
         static auto make_tags_array(TArgs&&... tags) {
@@ -733,6 +7655,7 @@ namespace CppUnitTestFramework {
 
     private:
         bool m_check_has_failed = false;
+        std::mutex m_failure_mutex;
         ILoggerPtr m_logger;
     };
 
@@ -750,6 +7673,248 @@ namespace CppUnitTestFramework {
         TestFixtureBaseImpl<T>
     >;
 
+    //--------------------------------------------------------------------------------------------------------
+
+    template <typename T>
+    struct AsyncTestFixture : TestFixtureBase<T>, AsyncTestCase {
+        using Base = TestFixtureBase<T>;
+        using Base::Base;
+
+    private:
+        bool ChecksFailed() const override {
+            return this->HaveChecksFailed();
+        }
+    };
+
+#if defined(CPPUTF_HAS_COROUTINES)
+    // The return type of a COROUTINE_TEST_CASE body.  The coroutine is resumed by the event loop, and destroyed
+    // with its test case even if it never finished.
+    struct AsyncCoroutine {
+        struct promise_type {
+            AsyncCoroutine get_return_object() {
+                return AsyncCoroutine{ std::coroutine_handle<promise_type>::from_promise(*this) };
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+
+            // Leaves resume() with the exception, which ends the test case like any other continuation.
+            void unhandled_exception() { throw; }
+        };
+
+        AsyncCoroutine() = default;
+        explicit AsyncCoroutine(std::coroutine_handle<promise_type> handle)
+          : Handle(handle)
+        {}
+        AsyncCoroutine(AsyncCoroutine&& other) noexcept
+          : Handle(std::exchange(other.Handle, nullptr))
+        {}
+        AsyncCoroutine& operator = (AsyncCoroutine&& other) noexcept {
+            std::swap(Handle, other.Handle);
+            return *this;
+        }
+        ~AsyncCoroutine() {
+            if (Handle) {
+                Handle.destroy();
+            }
+        }
+
+        std::coroutine_handle<promise_type> Handle;
+    };
+
+    // Suspends a coroutine until the continuation passed to [Schedule] runs.
+    template <typename TSchedule>
+    struct AsyncAwaiter {
+        TSchedule Schedule;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { Schedule([handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+
+    template <typename T>
+    struct CoroutineTestFixture : AsyncTestFixture<T> {
+        using Base = AsyncTestFixture<T>;
+        using Base::Base;
+
+    protected:
+        virtual AsyncCoroutine RunCoroutine() = 0;
+
+        // co_await Delay(std::chrono::milliseconds(10));
+        template <typename TRep, typename TPeriod>
+        auto Delay(const std::chrono::duration<TRep, TPeriod>& delay) {
+            return MakeAwaiter([this, delay](auto resume) { this->After(delay, std::move(resume)); });
+        }
+
+#if defined(CPPUTF_HAS_ASYNC_IO)
+        auto Readable(int fd) {
+            return MakeAwaiter([this, fd](auto resume) { this->WhenReadable(fd, std::move(resume)); });
+        }
+
+        auto Writable(int fd) {
+            return MakeAwaiter([this, fd](auto resume) { this->WhenWritable(fd, std::move(resume)); });
+        }
+#endif
+
+    private:
+        template <typename TSchedule>
+        static AsyncAwaiter<TSchedule> MakeAwaiter(TSchedule schedule) {
+            return { std::move(schedule) };
+        }
+
+        void Run() override {
+            m_body = RunCoroutine();
+            this->Post([handle = m_body.Handle]() { handle.resume(); });
+        }
+
+        AsyncCoroutine m_body;
+    };
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Runs a STRESS_TEST body on several threads at once.  The threads wait at a barrier so that they start
+    // together, and stop early once a REQUIRE fails or an exception is thrown on any of them.
+    struct StressRunner {
+        struct Result {
+            double OperationsPerSecond = 0;     // Per thread, averaged over the threads
+            std::exception_ptr Failure;         // The first REQUIRE failure or exception
+        };
+
+        // Calls [body] with each thread index and iteration.  The calling thread runs thread 0.
+        static Result Run(size_t threads, size_t iterations, void (*body)(void*, size_t, size_t), void* context);
+
+        // Yields the calling thread for one call in four, chosen at random.
+        static void MaybeYield();
+    };
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    CPPUTF_INLINE StressRunner::Result StressRunner::Run(size_t threads, size_t iterations, void (*body)(void*, size_t, size_t), void* context) {
+        threads = std::max<size_t>(threads, 1);
+
+        Result result;
+        std::mutex failure_mutex;
+        std::atomic<bool> stop{ false };
+        std::vector<double> rates(threads, 0.0);
+
+        // The threads wait at a barrier, so that they start together.  It is also released without running
+        // the body if a thread cannot be started.
+        std::mutex start_mutex;
+        std::condition_variable start_condition;
+        size_t arrived = 0;
+        bool released = false;
+        auto release = [&]() {
+            {
+                std::lock_guard lock(start_mutex);
+                released = true;
+            }
+            start_condition.notify_all();
+        };
+
+        auto run_thread = [&](size_t thread_index) {
+            {
+                std::unique_lock lock(start_mutex);
+                if (++arrived == threads) {
+                    released = true;
+                    start_condition.notify_all();
+                } else {
+                    start_condition.wait(lock, [&]() { return released; });
+                }
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            size_t completed = 0;
+            try {
+                for (; completed != iterations && !stop.load(std::memory_order_relaxed); ++completed) {
+                    body(context, thread_index, completed);
+                }
+            } catch (...) {
+                std::lock_guard lock(failure_mutex);
+                if (!result.Failure) {
+                    result.Failure = std::current_exception();
+                }
+                stop = true;
+            }
+
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() > 0) {
+                rates[thread_index] = static_cast<double>(completed) / elapsed.count();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        try {
+            for (size_t index = 1; index != threads; ++index) {
+                workers.emplace_back(run_thread, index);
+            }
+        } catch (...) {
+            // Release the threads that did start, without running the body.
+            stop = true;
+            release();
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            throw;
+        }
+
+        run_thread(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (auto rate : rates) {
+            result.OperationsPerSecond += rate;
+        }
+        result.OperationsPerSecond /= static_cast<double>(threads);
+        return result;
+    }
+
+    CPPUTF_INLINE void StressRunner::MaybeYield() {
+        // xorshift32, seeded differently on each thread.
+        static thread_local uint32_t s_state = static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+        s_state ^= s_state << 13;
+        s_state ^= s_state >> 17;
+        s_state ^= s_state << 5;
+        if ((s_state & 3) == 0) {
+            std::this_thread::yield();
+        }
+    }
+#endif
+
+    // The base of STRESS_TEST test cases.  Every thread shares the one fixture.
+    template <typename T>
+    struct StressTestFixture : TestFixtureBase<T> {
+        using Base = TestFixtureBase<T>;
+        using Base::Base;
+
+    protected:
+        virtual void RunIteration(size_t thread_index, size_t iteration) = 0;
+
+        // Runs RunIteration() [iterations] times on each of [threads] threads, and reports the throughput.
+        void RunStress(size_t threads, size_t iterations) {
+            auto result = StressRunner::Run(threads, iterations, [](void* self, size_t thread_index, size_t iteration) {
+                static_cast<StressTestFixture*>(self)->RunIteration(thread_index, iteration);
+            }, this);
+
+            this->ReportMetric("ops/s per thread", result.OperationsPerSecond);
+            if (result.Failure) {
+                std::rethrow_exception(result.Failure);
+            }
+        }
+
+        // Widens the windows in which races can happen.  Call it between the steps of an operation.
+        static void MaybeYield() {
+            StressRunner::MaybeYield();
+        }
+
+        // The sections of the threads would interleave in the report, so SECTION is not available.
+        template <typename... Args>
+        auto EnterSection(Args&&...) {
+            static_assert(sizeof...(Args) == 0, "SECTION cannot be used in a STRESS_TEST");
+            return 0;
+        }
+    };
+
 }
 
 //------------------------------------------------------------------------------------------------------------
@@ -779,6 +7944,70 @@ void TestCase_##TestName::Run()
 
 #define TEST_CASE(TestFixture, TestName) TEST_CASE_WITH_TAGS(TestFixture, TestName, )
 
+#define ASYNC_TEST_CASE_WITH_TAGS(TestFixture, TestName, ...) namespace {                           \
+    struct TestCase_##TestName : CppUnitTestFramework::AsyncTestFixture<TestFixture> {              \
+        using CppUnitTestFramework::AsyncTestFixture<TestFixture>::AsyncTestFixture;                \
+        static constexpr std::string_view SourceFile = __FILE__;                                    \
+        static constexpr size_t SourceLine = __LINE__;                                              \
+        static constexpr std::string_view Name = #TestFixture "::" #TestName;                       \
+        static std::vector<std::string_view> Tags;                                                  \
+        void Run() override;                                                                        \
+    };                                                                                              \
+    std::vector<std::string_view> TestCase_##TestName::Tags = make_tags_array(__VA_ARGS__);         \
+    CppUnitTestFramework::TestRegistry::AutoReg<TestCase_##TestName> _CPPUTF_NEXT_REGISTRAR_NAME;   \
+}                                                                                                   \
+void TestCase_##TestName::Run()
+
+#define ASYNC_TEST_CASE(TestFixture, TestName) ASYNC_TEST_CASE_WITH_TAGS(TestFixture, TestName, )
+
+#define STRESS_TEST_WITH_TAGS(TestFixture, TestName, ThreadCount, IterationCount, ...) namespace {  \
+    struct TestCase_##TestName : CppUnitTestFramework::StressTestFixture<TestFixture> {             \
+        using CppUnitTestFramework::StressTestFixture<TestFixture>::StressTestFixture;              \
+        static constexpr std::string_view SourceFile = __FILE__;                                    \
+        static constexpr size_t SourceLine = __LINE__;                                              \
+        static constexpr std::string_view Name = #TestFixture "::" #TestName;                       \
+        static std::vector<std::string_view> Tags;                                                  \
+        void Run() { RunStress(ThreadCount, IterationCount); }                                      \
+        void RunIteration(size_t ThreadIndex, size_t Iteration) override;                           \
+    };                                                                                              \
+    std::vector<std::string_view> TestCase_##TestName::Tags = make_tags_array(__VA_ARGS__);         \
+    CppUnitTestFramework::TestRegistry::AutoReg<TestCase_##TestName> _CPPUTF_NEXT_REGISTRAR_NAME;   \
+}                                                                                                   \
+void TestCase_##TestName::RunIteration([[maybe_unused]] size_t ThreadIndex, [[maybe_unused]] size_t Iteration)
+
+#define STRESS_TEST(TestFixture, TestName, ThreadCount, IterationCount) STRESS_TEST_WITH_TAGS(TestFixture, TestName, ThreadCount, IterationCount, )
+
+#if defined(CPPUTF_HAS_COROUTINES)
+#define COROUTINE_TEST_CASE_WITH_TAGS(TestFixture, TestName, ...) namespace {                       \
+    struct TestCase_##TestName : CppUnitTestFramework::CoroutineTestFixture<TestFixture> {          \
+        using CppUnitTestFramework::CoroutineTestFixture<TestFixture>::CoroutineTestFixture;        \
+        static constexpr std::string_view SourceFile = __FILE__;                                    \
+        static constexpr size_t SourceLine = __LINE__;                                              \
+        static constexpr std::string_view Name = #TestFixture "::" #TestName;                       \
+        static std::vector<std::string_view> Tags;                                                  \
+        CppUnitTestFramework::AsyncCoroutine RunCoroutine() override;                               \
+    };                                                                                              \
+    std::vector<std::string_view> TestCase_##TestName::Tags = make_tags_array(__VA_ARGS__);         \
+    CppUnitTestFramework::TestRegistry::AutoReg<TestCase_##TestName> _CPPUTF_NEXT_REGISTRAR_NAME;   \
+}                                                                                                   \
+CppUnitTestFramework::AsyncCoroutine TestCase_##TestName::RunCoroutine()
+
+#define COROUTINE_TEST_CASE(TestFixture, TestName) COROUTINE_TEST_CASE_WITH_TAGS(TestFixture, TestName, )
+#endif
+
+//------------------------------------------------------------------------------------------------------------
+
+#define FIXTURE_SETUP_ONCE(Type, Name) \
+    const std::shared_ptr<const Type> Name = CppUnitTestFramework::SharedSetupRegistry::Acquire<Type>(CppUnitTestFramework::SharedScope::Fixture)
+#define FIXTURE_SETUP_ONCE_PER_TAG(Type, Name, Tag) \
+    const std::shared_ptr<const Type> Name = CppUnitTestFramework::SharedSetupRegistry::Acquire<Type>(CppUnitTestFramework::SharedScope::Tag, Tag)
+#define FIXTURE_SETUP_ONCE_PER_PROCESS(Type, Name) \
+    const std::shared_ptr<const Type> Name = CppUnitTestFramework::SharedSetupRegistry::Acquire<Type>(CppUnitTestFramework::SharedScope::Process)
+
+//------------------------------------------------------------------------------------------------------------
+
+#define TEST_DATA(Path) CppUnitTestFramework::TestDataRegistry::Acquire(Path)
+
 //------------------------------------------------------------------------------------------------------------
 
 #define SECTION(Text)  if (auto _CPPUTF_NEXT_SECTION_LOCK_NAME = EnterSection("Section: " Text); true)
@@ -792,9 +8021,36 @@ void TestCase_##TestName::Run()
 
 #define _CPPUTF_ASSERT_LOCATION CppUnitTestFramework::AssertLocation{ __FILE__, __LINE__ }
 
-#define REQUIRE(Expression)          CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsTrue(static_cast<bool>(Expression), #Expression))
-#define REQUIRE_TRUE(Expression)     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsTrue(static_cast<bool>(Expression), #Expression))
-#define REQUIRE_FALSE(Expression)    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsFalse(static_cast<bool>(Expression), #Expression))
+// "Decomposer() <= a != b" is intended, so -Wparentheses is silenced around it.  Pragmas cannot appear
+// within an expression, so the assertion is a statement.  It is one on every compiler, so that code which
+// builds with one compiler builds with the others.
+#if defined(__GNUC__)
+    #define _CPPUTF_DECOMPOSED_ASSERT(Type, Function, Expression, Text) \
+        do { \
+            _Pragma("GCC diagnostic push") \
+            _Pragma("GCC diagnostic ignored \"-Wparentheses\"") \
+            CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Type, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::Function(CppUnitTestFramework::Assert::Decomposer() <= Expression, Text)); \
+            _Pragma("GCC diagnostic pop") \
+        } while (false)
+#elif defined(_MSC_VER)
+    // C4127: older versions warn that "while (false)" is constant.
+    #define _CPPUTF_DECOMPOSED_ASSERT(Type, Function, Expression, Text) \
+        __pragma(warning(push)) \
+        __pragma(warning(disable: 4127)) \
+        do { \
+            CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Type, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::Function(CppUnitTestFramework::Assert::Decomposer() <= Expression, Text)); \
+        } while (false) \
+        __pragma(warning(pop))
+#else
+    #define _CPPUTF_DECOMPOSED_ASSERT(Type, Function, Expression, Text) \
+        do { \
+            CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Type, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::Function(CppUnitTestFramework::Assert::Decomposer() <= Expression, Text)); \
+        } while (false)
+#endif
+
+#define REQUIRE(Expression)          _CPPUTF_DECOMPOSED_ASSERT(Throw, IsTrue, Expression, #Expression)
+#define REQUIRE_TRUE(Expression)     _CPPUTF_DECOMPOSED_ASSERT(Throw, IsTrue, Expression, #Expression)
+#define REQUIRE_FALSE(Expression)    _CPPUTF_DECOMPOSED_ASSERT(Throw, IsFalse, Expression, #Expression)
 #define REQUIRE_EQUAL(Left, Right)   CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AreEqual((Left), (Right)))
 #define REQUIRE_NULL(Expression)     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsNull((Expression), #Expression))
 #define REQUIRE_NOT_NULL(Expression) CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsNotNull((Expression), #Expression))
@@ -806,10 +8062,24 @@ void TestCase_##TestName::Run()
     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::Close((Left), (Right), (Percentage)))
 #define REQUIRE_CLOSE_FRACTION(Left, Right, Fraction) \
     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::CloseFraction((Left), (Right), (Fraction)))
-
-#define CHECK(Expression)          CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsTrue(static_cast<bool>(Expression), #Expression))
-#define CHECK_TRUE(Expression)     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsTrue(static_cast<bool>(Expression), #Expression))
-#define CHECK_FALSE(Expression)    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsFalse(static_cast<bool>(Expression), #Expression))
+#define REQUIRE_FILES_EQUAL(LeftPath, RightPath) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::FilesEqual((LeftPath), (RightPath)))
+#define REQUIRE_SNAPSHOT(Name, Value) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::MatchesSnapshot((Name), (Value)))
+#define REQUIRE_RANGE_EQUAL(Left, Right) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::RangeEqual((Left), (Right)))
+#define REQUIRE_BUFFER_EQUAL(Left, Right, Size) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::BufferEqual((Left), (Right), (Size)))
+#define REQUIRE_ALL_CLOSE(Left, Right, Tolerance) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AllClose((Left), (Right), (Tolerance)))
+#define REQUIRE_ALL_CLOSE_ULPS(Left, Right, Ulps) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AllCloseUlps((Left), (Right), (Ulps)))
+#define REQUIRE_ALL_CLOSE_RELATIVE(Left, Right, Relative, Absolute) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Throw, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AllCloseRelative((Left), (Right), (Relative), (Absolute)))
+
+#define CHECK(Expression)          _CPPUTF_DECOMPOSED_ASSERT(Continue, IsTrue, Expression, #Expression)
+#define CHECK_TRUE(Expression)     _CPPUTF_DECOMPOSED_ASSERT(Continue, IsTrue, Expression, #Expression)
+#define CHECK_FALSE(Expression)    _CPPUTF_DECOMPOSED_ASSERT(Continue, IsFalse, Expression, #Expression)
 #define CHECK_EQUAL(Left, Right)   CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AreEqual((Left), (Right)))
 #define CHECK_NULL(Expression)     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsNull((Expression), #Expression))
 #define CHECK_NOT_NULL(Expression) CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::IsNotNull((Expression), #Expression))
@@ -821,6 +8091,20 @@ void TestCase_##TestName::Run()
     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::Close((Left), (Right), (Percentage)))
 #define CHECK_CLOSE_FRACTION(Left, Right, Fraction) \
     CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::CloseFraction((Left), (Right), (Fraction)))
+#define CHECK_FILES_EQUAL(LeftPath, RightPath) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::FilesEqual((LeftPath), (RightPath)))
+#define CHECK_SNAPSHOT(Name, Value) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::MatchesSnapshot((Name), (Value)))
+#define CHECK_RANGE_EQUAL(Left, Right) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::RangeEqual((Left), (Right)))
+#define CHECK_BUFFER_EQUAL(Left, Right, Size) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::BufferEqual((Left), (Right), (Size)))
+#define CHECK_ALL_CLOSE(Left, Right, Tolerance) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AllClose((Left), (Right), (Tolerance)))
+#define CHECK_ALL_CLOSE_ULPS(Left, Right, Ulps) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AllCloseUlps((Left), (Right), (Ulps)))
+#define CHECK_ALL_CLOSE_RELATIVE(Left, Right, Relative, Absolute) \
+    CppUnitTestFramework::CommonFixture::HandleAssert(CppUnitTestFramework::AssertType::Continue, _CPPUTF_ASSERT_LOCATION, CppUnitTestFramework::Assert::AllCloseRelative((Left), (Right), (Relative), (Absolute)))
 
 //------------------------------------------------------------------------------------------------------------
 
@@ -835,10 +8119,12 @@ int main(int argc, const char* argv[]) {
         return 2;
     }
 
-    bool success = CppUnitTestFramework::TestRegistry::Run(
-        &options,
-        CppUnitTestFramework::ConsoleLogger::Create(&options)
-    );
+    auto logger = CppUnitTestFramework::CreateLogger(&options);
+    if (!logger) {
+        return 2;
+    }
+
+    bool success = CppUnitTestFramework::TestRegistry::Run(&options, logger);
 
     return success ? 0 : 1;
 }
@@ -15,6 +15,9 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
         public string WorkingDirectory00 { get; private set; }
         public Dictionary<string, string> Environment { get; private set; }
         public bool DebugLogging { get; private set; }
+        public int MaxParallelism { get; private set; }
+        public bool SplitExecutables { get; private set; }
+        public int MinTestsPerProcess { get; private set; }
 
         //----------------------------------------------------------------------------------------------------
 
@@ -23,6 +26,9 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
             WorkingDirectory00 = null;
             Environment = new Dictionary<string, string>();
             DebugLogging = true;
+            MaxParallelism = System.Environment.ProcessorCount;
+            SplitExecutables = false;
+            MinTestsPerProcess = 100;
         }
 
         //----------------------------------------------------------------------------------------------------
@@ -58,6 +64,24 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
                 DebugLogging = true;
             }
 
+            // CppUnitTestFrameworkTestAdaptor.MaxParallelism
+            var max_parallelism00 = root.SelectSingleNode("MaxParallelism");
+            if (max_parallelism00 != null && int.TryParse(max_parallelism00.InnerText, out int value3) && value3 > 0) {
+                MaxParallelism = value3;
+            }
+
+            // CppUnitTestFrameworkTestAdaptor.SplitExecutables
+            var split_executables00 = root.SelectSingleNode("SplitExecutables");
+            if (split_executables00 != null && bool.TryParse(split_executables00.InnerText, out bool value5)) {
+                SplitExecutables = value5;
+            }
+
+            // CppUnitTestFrameworkTestAdaptor.MinTestsPerProcess
+            var min_tests_per_process00 = root.SelectSingleNode("MinTestsPerProcess");
+            if (min_tests_per_process00 != null && int.TryParse(min_tests_per_process00.InnerText, out int value4) && value4 > 0) {
+                MinTestsPerProcess = value4;
+            }
+
             // CppUnitTestFrameworkTestAdaptor.Environment
             var environment00 = root.SelectSingleNode("Environment");
             Environment = new Dictionary<string, string>();
@@ -5,6 +5,7 @@ using System;
 using System.Collections.Generic;
 using System.Diagnostics;
 using System.IO;
+using System.Threading;
 using System.Threading.Tasks;
 
 namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
@@ -24,6 +25,9 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
             Config = new Configuration(context.RunSettings.SettingsXml);
             LogDebug($"Config.Enabled            = {Config.Enabled}");
             LogDebug($"Config.WorkingDirectory00 = {Config.WorkingDirectory00}");
+            LogDebug($"Config.MaxParallelism     = {Config.MaxParallelism}");
+            LogDebug($"Config.SplitExecutables   = {Config.SplitExecutables}");
+            LogDebug($"Config.MinTestsPerProcess = {Config.MinTestsPerProcess}");
             LogDebug($"Config.Environment:");
             foreach (var kvp in Config.Environment) {
                 LogDebug($"    {kvp.Key} = {kvp.Value}");
@@ -141,20 +145,29 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
         //----------------------------------------------------------------------------------------------------
 
         #region Test Discovery
-        protected async Task<List<TestCase>> DiscoverTestsFromExecutable(string executable) {
+        protected async Task<List<TestCase>> DiscoverTestsFromExecutable(
+            string executable,
+            SemaphoreSlim throttle
+        ) {
             var tests = new List<TestCase>();
 
-            var process = StartTestRun(executable, "--discover_tests", "--adapter_info");
-            if (process == null) {
-                LogError("Failed to launch " + executable);
-                return tests;
-            }
-
+            // The discovery process takes one of the [throttle] slots while it runs.
+            await throttle.WaitAsync();
             try {
-                return await ParseTestDiscovery(executable, process.StandardOutput);
+                var process = StartTestRun(executable, "--discover_tests", "--adapter_info");
+                if (process == null) {
+                    LogError("Failed to launch " + executable);
+                    return tests;
+                }
+
+                using (process) {
+                    return await ParseTestDiscovery(executable, process.StandardOutput);
+                }
             } catch (Exception e) {
-                LogError("Failed to parse: " + e.Message);
+                LogError("Failed to discover tests for " + executable + ": " + e.Message);
                 return tests;
+            } finally {
+                throttle.Release();
             }
         }
 
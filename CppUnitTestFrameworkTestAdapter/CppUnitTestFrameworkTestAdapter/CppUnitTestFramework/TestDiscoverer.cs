@@ -2,6 +2,8 @@
 using Microsoft.VisualStudio.TestPlatform.ObjectModel.Adapter;
 using Microsoft.VisualStudio.TestPlatform.ObjectModel.Logging;
 using System.Collections.Generic;
+using System.Linq;
+using System.Threading;
 using System.Threading.Tasks;
 
 namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
@@ -22,18 +24,19 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
                 return;
             }
 
-            foreach (var executable in sources) {
-                var task = DiscoverTestsFromExecutable(executable);
-                task.Wait();
-                if (task.Status != TaskStatus.RanToCompletion) {
-                    LogError("Failed to discover tests for " + executable);
-                    continue;
-                }
+            // Discover each executable at once, up to the configured parallelism
+            var throttle = new SemaphoreSlim(Config.MaxParallelism);
+            var discoveries = sources.Select(async executable => {
+                var tests = await DiscoverTestsFromExecutable(executable, throttle);
 
-                foreach (var test_case in task.Result) {
-                    discoverySink.SendTestCase(test_case);
+                // The sink is shared by every executable
+                lock (discoverySink) {
+                    foreach (var test_case in tests) {
+                        discoverySink.SendTestCase(test_case);
+                    }
                 }
-            }
+            });
+            Task.WaitAll(discoveries.ToArray());
         }
     }
 }
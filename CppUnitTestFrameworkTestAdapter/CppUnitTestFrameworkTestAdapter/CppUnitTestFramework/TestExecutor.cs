@@ -3,7 +3,9 @@ using Microsoft.VisualStudio.TestPlatform.ObjectModel.Adapter;
 using System;
 using System.Collections.Generic;
 using System.Diagnostics;
+using System.IO;
 using System.Linq;
+using System.Threading;
 using System.Threading.Tasks;
 
 namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
@@ -15,14 +17,17 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
     {
         public const string ExecutorUri = "executor://CppUTFTestExecutor";
 
-        private Process m_test_run_process = null;
-        
+        private readonly object m_lock = new object();
+        private readonly HashSet<Process> m_test_run_processes = new HashSet<Process>();
+        private bool m_cancelled = false;
+
         //----------------------------------------------------------------------------------------------------
 
         public void Cancel() {
-            lock (this) {
-                if (m_test_run_process != null) {
-                    m_test_run_process.Kill();
+            lock (m_lock) {
+                m_cancelled = true;
+                foreach (var process in m_test_run_processes) {
+                    KillProcess(process);
                 }
             }
         }
@@ -37,15 +42,26 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
             if (!Initialize(frameworkHandle, runContext)) {
                 return;
             }
+            lock (m_lock) {
+                m_cancelled = false;
+            }
 
             // Group the tests by executable to minimize the number of processes
             var per_executable = tests.GroupBy(t => t.Source).ToList();
 
             // Run specific test cases
-            foreach (var executable_group in per_executable) {
-                var executable = executable_group.Key;
-                RunAndParseTests(runContext, frameworkHandle, executable, executable_group);
-            }
+            var throttle = CreateThrottle(runContext);
+            var runs = per_executable.Select(
+                executable_group => RunExecutable(
+                    runContext,
+                    frameworkHandle,
+                    executable_group.Key,
+                    executable_group.ToList(),
+                    per_executable.Count,
+                    throttle
+                )
+            );
+            Task.WaitAll(runs.ToArray());
         }
 
         //----------------------------------------------------------------------------------------------------
@@ -58,59 +74,141 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
             if (!Initialize(frameworkHandle, runContext)) {
                 return;
             }
+            lock (m_lock) {
+                m_cancelled = false;
+            }
 
-            // Run all test cases from each executable
-            foreach (var executable in sources) {
-                // Discover the test cases
-                var task = DiscoverTestsFromExecutable(executable);
-                task.Wait();
-                if (task.Status != TaskStatus.RanToCompletion) {
-                    LogError("Failed to discover tests for " + executable);
-                    continue;
-                }
+            // Run all test cases from each executable.  Each executable starts running as soon as its own
+            // test cases are discovered.
+            var executables = sources.ToList();
+            var throttle = CreateThrottle(runContext);
+            var runs = executables.Select(async executable => {
+                var tests = await DiscoverTestsFromExecutable(executable, throttle);
+                await RunExecutable(runContext, frameworkHandle, executable, tests, executables.Count, throttle);
+            });
+            Task.WaitAll(runs.ToArray());
+        }
+
+        //----------------------------------------------------------------------------------------------------
+
+        private SemaphoreSlim CreateThrottle(IRunContext run_context) {
+            // Only one process is debugged at a time.
+            return new SemaphoreSlim(run_context.IsBeingDebugged ? 1 : Config.MaxParallelism);
+        }
+
+        //----------------------------------------------------------------------------------------------------
 
-                // Run all test cases
-                RunAndParseTests(runContext, frameworkHandle, executable, task.Result);
+        private Task RunExecutable(
+            IRunContext run_context,
+            IFrameworkHandle frameworkHandle,
+            string executable,
+            List<TestCase> tests,
+            int executable_count,
+            SemaphoreSlim throttle
+        ) {
+            // When enabled, split a large executable over several processes while there are slots to spare.
+            // Each process runs a contiguous range of the sorted test names, so the tests of a fixture mostly
+            // stay together.  The processes don't know about each other, so "exclusive" tags only hold within
+            // each one.
+            var partition_count = 1;
+            if (Config.SplitExecutables && !run_context.IsBeingDebugged) {
+                var spare_slots = Math.Max(1, Config.MaxParallelism / executable_count);
+                var needed = (tests.Count + Config.MinTestsPerProcess - 1) / Config.MinTestsPerProcess;
+                partition_count = Math.Max(1, Math.Min(spare_slots, needed));
             }
+
+            var sorted = tests.OrderBy(t => t.FullyQualifiedName, StringComparer.Ordinal).ToList();
+            var runs = Enumerable.Range(0, partition_count).Select(index => {
+                var start = index * sorted.Count / partition_count;
+                var end = (index + 1) * sorted.Count / partition_count;
+                return RunAndParseTests(
+                    run_context,
+                    frameworkHandle,
+                    executable,
+                    sorted.GetRange(start, end - start),
+                    throttle
+                );
+            });
+            return Task.WhenAll(runs.ToArray());
         }
 
         //----------------------------------------------------------------------------------------------------
 
-        private void RunAndParseTests(
+        private async Task RunAndParseTests(
             IRunContext run_context,
             IFrameworkHandle frameworkHandle,
             string executable,
-            IEnumerable<TestCase> tests
+            List<TestCase> tests,
+            SemaphoreSlim throttle
         ) {
-            var args = tests.Select(t => t.FullyQualifiedName).ToList();
-            args.Insert(0, "--verbose --adapter_info");
+            if (tests.Count == 0) {
+                return;
+            }
 
-            Task parse_output_task;
-            lock (this) {
-                if (m_test_run_process != null) {
-                    LogInfo("Cannot run tests while other tests are active");
-                    return;
+            await throttle.WaitAsync();
+            string test_list_path00 = null;
+            try {
+                lock (m_lock) {
+                    if (m_cancelled) {
+                        return;
+                    }
                 }
 
+                // The test names are passed in a file, as a large selection won't fit on the command line.
+                test_list_path00 = Path.GetTempFileName();
+                File.WriteAllLines(test_list_path00, tests.Select(t => t.FullyQualifiedName));
+                var args = new string[] { "--verbose", "--adapter_info", $"\"--test_list={test_list_path00}\"" };
+
+                Process process;
                 if (run_context.IsBeingDebugged) {
-                    m_test_run_process = StartDebugTestRun(frameworkHandle, executable, args.ToArray());
-                } else { 
-                    m_test_run_process = StartTestRun(executable, args.ToArray());
+                    process = StartDebugTestRun(frameworkHandle, executable, args);
+                } else {
+                    process = StartTestRun(executable, args);
                 }
-                if (m_test_run_process == null) {
+                if (process == null) {
                     LogError("Failed to launch " + executable);
+                    return;
                 }
 
-                parse_output_task = ParseTestRunOutput(frameworkHandle, m_test_run_process, tests);
-            }
+                lock (m_lock) {
+                    m_test_run_processes.Add(process);
+                    if (m_cancelled) {
+                        // Cancelled while the process was starting.
+                        KillProcess(process);
+                    }
+                }
 
-            parse_output_task.Wait();
-            if (parse_output_task.Status != TaskStatus.RanToCompletion) {
-                LogError("Failed to discover tests for " + executable);
+                try {
+                    await ParseTestRunOutput(frameworkHandle, process, tests);
+                } catch (Exception e) {
+                    LogError("Failed to parse the test output for " + executable + ": " + e.Message);
+                } finally {
+                    lock (m_lock) {
+                        m_test_run_processes.Remove(process);
+                    }
+                    process.Dispose();
+                }
+            } catch (IOException e) {
+                LogError("Failed to write the test list for " + executable + ": " + e.Message);
+            } finally {
+                if (test_list_path00 != null) {
+                    try {
+                        File.Delete(test_list_path00);
+                    } catch (IOException) {
+                        // Still in use.  Leave it in the temp directory.
+                    }
+                }
+                throttle.Release();
             }
+        }
+
+        //----------------------------------------------------------------------------------------------------
 
-            lock (this) {
-                m_test_run_process = null;
+        private static void KillProcess(Process process) {
+            try {
+                process.Kill();
+            } catch (InvalidOperationException) {
+                // Already exited.
             }
         }
 
@@ -119,7 +217,7 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
         private async Task ParseTestRunOutput(
             ITestExecutionRecorder recorder,
             Process process,
-            IEnumerable<TestCase> tests
+            List<TestCase> tests
         ) {
             if (!process.StartInfo.RedirectStandardOutput) {
                 // A debugged process won't re-direct stdout for us while it's running.  We can't know what
@@ -129,8 +227,14 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
             }
             var stream = process.StandardOutput;
 
+            var tests_by_name = new Dictionary<string, TestCase>();
+            foreach (var test in tests) {
+                tests_by_name[test.FullyQualifiedName] = test;
+            }
+
             var tests_complete = false;
-            TestCase current_test = null;
+            var in_test = false;
+            TestCase current_test00 = null;
             var current_message_lines = new List<string>();
 
             do {
@@ -145,24 +249,28 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
                 }
 
                 if (line.StartsWith("Test Complete:")) {
-                    if (current_test == null) {
+                    if (!in_test) {
                         LogError("Unexpected test completion");
                         break;
                     }
 
                     // The current test has finished.  Update the status.
                     var status = line.Substring(15);
-                    var outcome = (status == "passed") ? TestOutcome.Passed : TestOutcome.Failed;
-                    var message = string.Join(Environment.NewLine, current_message_lines);
-                    recorder.RecordResult(
-                        new TestResult(current_test) {
-                            Outcome = outcome,
-                            ErrorMessage = message
-                        }
-                    );
-                    LogDebug($"Test Complete: {current_test.FullyQualifiedName} ({status})");
+                    if (current_test00 != null) {
+                        var outcome = (status == "passed") ? TestOutcome.Passed : TestOutcome.Failed;
+                        var message = string.Join(Environment.NewLine, current_message_lines);
+                        RecordResult(
+                            recorder,
+                            new TestResult(current_test00) {
+                                Outcome = outcome,
+                                ErrorMessage = message
+                            }
+                        );
+                        LogDebug($"Test Complete: {current_test00.FullyQualifiedName} ({status})");
+                    }
 
-                    current_test = null;
+                    in_test = false;
+                    current_test00 = null;
                     current_message_lines.Clear();
                     continue;
                 }
@@ -170,9 +278,9 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
                 if (line.StartsWith("Skip:")) {
                     var test_name = line.Substring(6);
 
-                    var test_case = tests.FirstOrDefault(t => t.FullyQualifiedName == test_name);
-                    if (test_case != null) {
-                        recorder.RecordResult(
+                    if (tests_by_name.TryGetValue(test_name, out TestCase test_case)) {
+                        RecordResult(
+                            recorder,
                             new TestResult(test_case) { Outcome = TestOutcome.Skipped }
                         );
                     }
@@ -182,8 +290,15 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
 
                 if (line.StartsWith("Test:")) {
                     var test_name = line.Substring(6);
-                    current_test = tests.First(t => t.FullyQualifiedName == test_name);
-                    recorder.RecordStart(current_test);
+
+                    // Only the listed tests are run, but any others are left alone rather than misreported.
+                    in_test = true;
+                    tests_by_name.TryGetValue(test_name, out current_test00);
+                    if (current_test00 != null) {
+                        lock (recorder) {
+                            recorder.RecordStart(current_test00);
+                        }
+                    }
                     continue;
                 }
 
@@ -212,5 +327,14 @@ namespace CppUnitTestFrameworkTestAdapter.CppUnitTestFramework
                 tests_complete = true;
             } while (!stream.EndOfStream);
         }
+
+        //----------------------------------------------------------------------------------------------------
+
+        private static void RecordResult(ITestExecutionRecorder recorder, TestResult result) {
+            // Results arrive from several processes at once.
+            lock (recorder) {
+                recorder.RecordResult(result);
+            }
+        }
     }
 }
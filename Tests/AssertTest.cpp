@@ -1,5 +1,10 @@
 #include "CppUnitTestFramework.hpp"
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <list>
+
 using namespace CppUnitTestFramework;
 
 namespace {
@@ -13,6 +18,28 @@ namespace {
         const bool Value;
         explicit operator bool() const { return Value; }
     };
+
+    // Comparable, but has no conversion to a string.
+    struct Unprintable {
+        int Value;
+        bool operator == (const Unprintable& other) const { return Value == other.Value; }
+    };
+
+    struct BitFields {
+        unsigned Low : 4;
+        unsigned High : 4;
+    };
+
+    // The message of the AssertException thrown by [assertion], or an empty string.
+    template <typename TAssertion>
+    std::string FailureMessage(const TAssertion& assertion) {
+        try {
+            assertion();
+        } catch (const AssertException& ex) {
+            return ex.what();
+        }
+        return {};
+    }
 }
 
 namespace CppUnitTestFrameworkTest {
@@ -96,6 +123,178 @@ namespace CppUnitTestFrameworkTest {
 
     //--------------------------------------------------------------------------------------------------------
 
+    TEST_CASE(AssertTest, AreEqual_Container) {
+        const std::vector<int> values_12 = { 1, 2 };
+        const std::vector<int> values_13 = { 1, 3 };
+
+        SECTION("Check passes") {
+            CHECK_NO_THROW(REQUIRE_EQUAL(values_12, values_12));
+        }
+
+        SECTION("Check fails") {
+            CHECK_THROW(AssertException, REQUIRE_EQUAL(values_12, values_13));
+
+            auto exception = Assert::AreEqual(std::vector<int>(10000000, 1), std::vector<int>(10000000, 2));
+            REQUIRE(exception.has_value());
+            CHECK(std::strlen(exception->what()) < 1000);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, AreEqual_Text) {
+        SECTION("Short strings") {
+            auto exception = Assert::AreEqual(std::string("left"), "right");
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(std::string(exception->what()), "[left] == [right]");
+        }
+
+        SECTION("Multi-line strings") {
+            std::string left = "one\ntwo\nthree\nfour\nfive\nsix\nseven\neight\n";
+            std::string right = "one\ntwo\nthree\nFOUR\nfive\nsix\nseven\neight\nnine\n";
+
+            auto exception = Assert::AreEqual(left, right);
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(
+                std::string(exception->what()),
+                "Texts differ at offset 14 (line 4, column 1); sizes [40] and [45]\n"
+                "--- left\n"
+                "+++ right\n"
+                "@@ -1,8 +1,9 @@\n"
+                " one\n"
+                " two\n"
+                " three\n"
+                "-four\n"
+                "+FOUR\n"
+                " five\n"
+                " six\n"
+                " seven\n"
+                " eight\n"
+                "+nine"
+            );
+        }
+
+        SECTION("Missing final line break") {
+            auto exception = Assert::AreEqual(std::string("a\nb\n"), std::string("a\nb"));
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(
+                std::string(exception->what()),
+                "Texts differ at offset 3 (line 2, column 2); sizes [4] and [3]\n"
+                "--- left\n"
+                "+++ right\n"
+                "@@ -1,2 +1,2 @@\n"
+                " a\n"
+                "-b\n"
+                "+b\n"
+                "\\ No newline at end of file"
+            );
+        }
+
+        SECTION("Large texts") {
+            std::string left;
+            for (int i = 0; i != 1000000; ++i) {
+                left += "line " + std::to_string(i) + "\n";
+            }
+            std::string right = left;
+            right.replace(right.find("line 500000\n"), 12, "changed\n");
+
+            auto exception = Assert::AreEqual(left, right);
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("(line 500001, column 1)") != std::string::npos);
+            CHECK(message.find("@@ -499998,7 +499998,7 @@\n line 499997\n line 499998\n line 499999\n-line 500000\n+changed\n") != std::string::npos);
+            CHECK(message.size() < 1000);
+        }
+
+        SECTION("Output is bounded") {
+            std::string left;
+            std::string right;
+            for (int i = 0; i != 10000; ++i) {
+                left += std::to_string(i) + "\n";
+                right += std::to_string(i * 7) + "\n";
+            }
+
+            auto exception = Assert::AreEqual(left, right);
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("\n... (diff truncated)") != std::string::npos);
+            CHECK(message.size() < 2000);
+        }
+
+        SECTION("Large texts that differ throughout") {
+            std::string left;
+            std::string right;
+            for (int i = 0; i != 1000000; ++i) {
+                left += "line " + std::to_string(i) + "\n";
+                right += "LINE " + std::to_string(i) + "\n";
+            }
+
+            // Only the lines needed to fill the output are split and compared.
+            auto start = std::chrono::steady_clock::now();
+            auto exception = Assert::AreEqual(left, right);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("\n... (diff truncated)") != std::string::npos);
+            CHECK(message.size() < 2000);
+            CHECK(elapsed < std::chrono::seconds(1));
+        }
+
+        SECTION("Lines beyond the limit are summarized") {
+            std::string left;
+            for (int i = 0; i != 200; ++i) {
+                left += std::to_string(i) + "\n";
+            }
+            std::string right = "first\n" + left + "last\n";
+
+            Diff::Limits limits;
+            limits.MaxLines = 50;
+            CHECK_EQUAL(
+                Diff::UnifiedDiff(left, right, "left", "right", limits),
+                "Texts differ at offset 0 (line 1, column 1); sizes [690] and [701]\n"
+                "--- left\n"
+                "+++ right\n"
+                "@@ -1,3 +1,4 @@\n"
+                "+first\n"
+                " 0\n"
+                " 1\n"
+                " 2\n"
+                "... (151 more left lines and 152 more right lines differ)"
+            );
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, FilesEqual) {
+        auto write_file = [](const std::string& path, const std::string& contents) {
+            std::ofstream(path, std::ios::binary) << contents;
+        };
+        write_file("AssertTest_FilesEqual_1.txt", "alpha\nbeta\ngamma\n");
+        write_file("AssertTest_FilesEqual_2.txt", "alpha\nbeta\ngamma\n");
+        write_file("AssertTest_FilesEqual_3.txt", "alpha\ndelta\ngamma\n");
+
+        SECTION("Check passes") {
+            CHECK_NO_THROW(REQUIRE_FILES_EQUAL("AssertTest_FilesEqual_1.txt", "AssertTest_FilesEqual_2.txt"));
+        }
+
+        SECTION("Check fails") {
+            CHECK_THROW(AssertException, REQUIRE_FILES_EQUAL("AssertTest_FilesEqual_1.txt", "AssertTest_FilesEqual_3.txt"));
+            CHECK_THROW(AssertException, REQUIRE_FILES_EQUAL("AssertTest_FilesEqual_1.txt", "AssertTest_Missing.txt"));
+
+            auto exception = Assert::FilesEqual("AssertTest_FilesEqual_1.txt", "AssertTest_FilesEqual_3.txt");
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("--- AssertTest_FilesEqual_1.txt\n+++ AssertTest_FilesEqual_3.txt\n@@ -1,3 +1,3 @@\n alpha\n-beta\n+delta\n gamma") != std::string::npos);
+        }
+
+        std::remove("AssertTest_FilesEqual_1.txt");
+        std::remove("AssertTest_FilesEqual_2.txt");
+        std::remove("AssertTest_FilesEqual_3.txt");
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
     TEST_CASE(AssertTest, IsNull) {
         SECTION("Check passes") {
             CHECK_NO_THROW(REQUIRE_NULL(nullptr));
@@ -160,6 +359,59 @@ namespace CppUnitTestFrameworkTest {
 
     //--------------------------------------------------------------------------------------------------------
 
+    TEST_CASE(AssertTest, Decomposition) {
+        int one = 1;
+        int two = 2;
+        std::string text = "text";
+
+        SECTION("Check passes") {
+            CHECK_NO_THROW(REQUIRE(one == 1));
+            CHECK_NO_THROW(REQUIRE(one != two));
+            CHECK_NO_THROW(REQUIRE(one < two));
+            CHECK_NO_THROW(REQUIRE(one <= 1));
+            CHECK_NO_THROW(REQUIRE(two > one));
+            CHECK_NO_THROW(REQUIRE(two >= 2));
+            CHECK_NO_THROW(REQUIRE(text == "text"));
+            CHECK_NO_THROW(REQUIRE_FALSE(one == two));
+            CHECK_NO_THROW(REQUIRE(one + 1 == two));
+        }
+
+        SECTION("Operand values") {
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(one == two); }), "IsTrue(one == two): [1] == [2]");
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(two < one); }), "IsTrue(two < one): [2] < [1]");
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(one + 1 >= two * 2); }), "IsTrue(one + 1 >= two * 2): [2] >= [4]");
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(text != "text"); }), "IsTrue(text != \"text\"): [text] != [text]");
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE_FALSE(one != two); }), "IsFalse(one != two): [1] != [2]");
+        }
+
+        SECTION("Other expressions") {
+            // Reported by their text alone.
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(one == 2 && two == 2); }), "IsTrue(one == 2 && two == 2)");
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(one & two); }), "IsTrue(one & two)");
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(Unprintable{ 1 } == Unprintable{ 2 }); }), "IsTrue(Unprintable{ 1 } == Unprintable{ 2 })");
+
+            // The right hand side of && is not evaluated.
+            int* null = nullptr;
+            CHECK_NO_THROW(REQUIRE_FALSE(null != nullptr && *null == 1));
+            CHECK_NO_THROW(REQUIRE(one | two));
+            CHECK_NO_THROW(REQUIRE((one ^ two) == 3));
+        }
+
+        SECTION("Operand types") {
+            std::vector<int> values = { 1, 2, 3 };
+            CHECK_NO_THROW(REQUIRE(values.size() == 3));
+            CHECK_NO_THROW(REQUIRE(values.size() > 0));
+
+            BitFields fields{ 3, 4 };
+            CHECK_NO_THROW(REQUIRE(fields.Low < fields.High));
+
+            std::vector<int> other = { 1, 2, 4 };
+            CHECK_EQUAL(FailureMessage([&]() { REQUIRE(values == other); }), "IsTrue(values == other): [{ 1, 2, 3 }] == [{ 1, 2, 4 }]");
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
     TEST_CASE(AssertTest, Throws) {
         SECTION("Check passes") {
             CHECK_NO_THROW(REQUIRE_THROW(std::runtime_error, throw std::runtime_error("Bang")));
@@ -258,6 +510,9 @@ namespace CppUnitTestFrameworkTest {
             CHECK_THROW(AssertException, REQUIRE_CLOSE(-11.0, -10.0, 0.09));
             CHECK_THROW(AssertException, REQUIRE_CLOSE(-10.0, -10.1, 0.009));
             CHECK_THROW(AssertException, REQUIRE_CLOSE(-10.1, -10.0, 0.009));
+
+            // The overflow guard must not clamp to the float range.
+            CHECK_THROW(AssertException, REQUIRE_CLOSE(1e-300, 1e300, 1e100));
         }
     }
 
@@ -325,4 +580,300 @@ namespace CppUnitTestFrameworkTest {
         }
     }
 
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, RangeEqual) {
+        SECTION("Check passes") {
+            CHECK_NO_THROW(REQUIRE_RANGE_EQUAL(std::vector<int>(), std::vector<int>()));
+            CHECK_NO_THROW(REQUIRE_RANGE_EQUAL(std::vector<int>(1000, 5), std::vector<int>(1000, 5)));
+
+            std::array<int, 3> array = { 1, 2, 3 };
+            std::list<int> list = { 1, 2, 3 };
+            CHECK_NO_THROW(REQUIRE_RANGE_EQUAL(array, list));
+            CHECK_NO_THROW(REQUIRE_RANGE_EQUAL(std::vector<std::string>(3, "a"), std::vector<std::string>(3, "a")));
+        }
+
+        SECTION("Check fails") {
+            std::vector<int> left(1000, 5);
+            std::vector<int> right(1000, 5);
+            right[3] = 6;
+            right[999] = 7;
+            CHECK_THROW(AssertException, REQUIRE_RANGE_EQUAL(left, right));
+
+            auto exception = Assert::RangeEqual(left, right);
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(
+                std::string(exception->what()),
+                "Ranges differ: 2 of 1000 elements differ:\n    [3]: [5] != [6]\n    [999]: [5] != [7]"
+            );
+
+            std::list<int> list = { 1, 2, 4 };
+            CHECK_THROW(AssertException, REQUIRE_RANGE_EQUAL(std::vector<int>({ 1, 2, 3 }), list));
+        }
+
+        SECTION("Size mismatch") {
+            auto exception = Assert::RangeEqual(std::vector<int>{ 1, 2 }, std::vector<int>{ 1, 2, 3 });
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(std::string(exception->what()), "Range sizes differ: [2] != [3]");
+        }
+
+        SECTION("Mismatch count is bounded") {
+            auto exception = Assert::RangeEqual(std::vector<int>(100000, 1), std::vector<int>(100000, 2));
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("100000 of 100000 elements differ") != std::string::npos);
+            CHECK(message.find("... (99990 more)") != std::string::npos);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, BufferEqual) {
+        std::vector<unsigned char> left(100);
+        for (size_t i = 0; i != left.size(); ++i) {
+            left[i] = static_cast<unsigned char>(i);
+        }
+
+        SECTION("Check passes") {
+            auto right = left;
+            CHECK_NO_THROW(REQUIRE_BUFFER_EQUAL(left.data(), right.data(), left.size()));
+            CHECK_NO_THROW(REQUIRE_BUFFER_EQUAL(nullptr, nullptr, 0));
+        }
+
+        SECTION("Every mismatch position is found") {
+            for (size_t size = 1; size != left.size(); ++size) {
+                for (size_t index = 0; index != size; ++index) {
+                    auto right = left;
+                    right[index] ^= 0x80;
+                    REQUIRE_EQUAL(Simd::FindMismatch(left.data(), right.data(), size), index);
+                    REQUIRE_EQUAL(Simd::FindMismatch(left.data(), right.data(), size, index + 1), size);
+                }
+            }
+        }
+
+        SECTION("Check fails") {
+            auto right = left;
+            right[0x21] = 0xff;
+            CHECK_THROW(AssertException, REQUIRE_BUFFER_EQUAL(left.data(), right.data(), left.size()));
+
+            auto exception = Assert::BufferEqual(left.data(), right.data(), left.size());
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("1 of 100 bytes differ:\n    @0x00000021: [0x21] != [0xff]") != std::string::npos);
+            CHECK(message.find("\n    00000010  10 11 12") != std::string::npos);
+            CHECK(message.find("\n  * 00000020  20 21 22") != std::string::npos);
+            CHECK(message.find("20 ff 22") != std::string::npos);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, AllClose) {
+        SECTION("Check passes") {
+            std::vector<float> floats(1001, 1.0f);
+            std::vector<double> doubles(1001, 1.0);
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE(floats, floats, 0.0f));
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE(doubles, doubles, 0.0));
+
+            auto other_floats = floats;
+            auto other_doubles = doubles;
+            other_floats[500] = 1.5f;
+            other_doubles[1000] = 0.5;
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE(floats, other_floats, 0.5f));
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE(doubles, other_doubles, 0.5));
+
+            std::vector<double> infinities(9, std::numeric_limits<double>::infinity());
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE(infinities, infinities, 0.0));
+        }
+
+        SECTION("Every mismatch position is found") {
+            std::vector<float> floats(40, 1.0f);
+            std::vector<double> doubles(40, 1.0);
+            for (size_t size = 1; size != floats.size(); ++size) {
+                for (size_t index = 0; index != size; ++index) {
+                    auto other_floats = floats;
+                    auto other_doubles = doubles;
+                    other_floats[index] = 2.0f;
+                    other_doubles[index] = std::numeric_limits<double>::quiet_NaN();
+                    REQUIRE_EQUAL(Simd::FindNotClose(floats.data(), other_floats.data(), size, 0.5f), index);
+                    REQUIRE_EQUAL(Simd::FindNotClose(doubles.data(), other_doubles.data(), size, 0.5), index);
+                }
+            }
+        }
+
+        SECTION("Check fails") {
+            std::vector<double> left(100, 1.0);
+            std::vector<double> right(100, 1.0);
+            right[10] = 1.25;
+            right[20] = 3.0;
+            CHECK_THROW(AssertException, REQUIRE_ALL_CLOSE(left, right, 0.1));
+
+            auto exception = Assert::AllClose(left, right, 0.1);
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(
+                std::string(exception->what()),
+                "Ranges are not within [0.1]: 2 of 100 elements differ:\n    [10]: [1] != [1.25]\n    [20]: [1] != [3]"
+                "\n    Largest error: [2] at [20]"
+                "\n    Error histogram:"
+                "\n      0                       98"
+                "\n      [1e-1, 1e0)             1"
+                "\n      [1e0, 1e1)              1"
+            );
+
+            CHECK_THROW(AssertException, REQUIRE_ALL_CLOSE(std::vector<float>(3), std::vector<float>(4), 0.1f));
+        }
+
+        SECTION("Infinite errors") {
+            std::vector<double> left = { 1.0, 1.0, 1.0 };
+            std::vector<double> right = { 1.0, std::numeric_limits<double>::infinity(), 1e300 };
+
+            auto exception = Assert::AllClose(left, right, 0.1);
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(
+                std::string(exception->what()),
+                "Ranges are not within [0.1]: 2 of 3 elements differ:\n    [1]: [1] != [inf]\n    [2]: [1] != [1e+300]"
+                "\n    Largest error: [inf] at [1]"
+                "\n    Error histogram:"
+                "\n      0                       1"
+                "\n      [1e300, 1e301)          1"
+                "\n      inf                     1"
+            );
+        }
+    }
+
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, UlpDistance) {
+        CHECK_EQUAL(Simd::UlpDistance(1.0f, 1.0f), 0u);
+        CHECK_EQUAL(Simd::UlpDistance(0.0f, -0.0f), 0u);
+        CHECK_EQUAL(Simd::UlpDistance(1.0f, std::nextafter(1.0f, 2.0f)), 1u);
+        CHECK_EQUAL(Simd::UlpDistance(-1.0, std::nextafter(-1.0, -2.0)), 1u);
+        CHECK_EQUAL(Simd::UlpDistance(std::numeric_limits<float>::denorm_min(), -std::numeric_limits<float>::denorm_min()), 2u);
+        CHECK_EQUAL(Simd::UlpDistance(std::nanf(""), 1.0f), std::numeric_limits<uint64_t>::max());
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, AllCloseUlps) {
+        SECTION("Check passes") {
+            std::vector<float> floats(1001);
+            std::vector<double> doubles(1001);
+            for (size_t i = 0; i != floats.size(); ++i) {
+                floats[i] = static_cast<float>(i) - 500.0f;
+                doubles[i] = static_cast<double>(i) - 500.0;
+            }
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE_ULPS(floats, floats, 0));
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE_ULPS(doubles, doubles, 0));
+
+            auto other_floats = floats;
+            auto other_doubles = doubles;
+            for (size_t i = 0; i < floats.size(); i += 3) {
+                other_floats[i] = std::nextafter(std::nextafter(floats[i], 1e9f), 1e9f);
+                other_doubles[i] = std::nextafter(std::nextafter(doubles[i], -1e9), -1e9);
+            }
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE_ULPS(floats, other_floats, 2));
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE_ULPS(doubles, other_doubles, 2));
+            CHECK_THROW(AssertException, REQUIRE_ALL_CLOSE_ULPS(floats, other_floats, 1));
+            CHECK_THROW(AssertException, REQUIRE_ALL_CLOSE_ULPS(doubles, other_doubles, 1));
+        }
+
+        SECTION("Every mismatch position is found") {
+            std::vector<float> floats(40, 1.0f);
+            std::vector<double> doubles(40, -1.0);
+            for (size_t size = 1; size != floats.size(); ++size) {
+                for (size_t index = 0; index != size; ++index) {
+                    auto other_floats = floats;
+                    auto other_doubles = doubles;
+                    other_floats[index] = -1.0f;
+                    other_doubles[index] = std::numeric_limits<double>::quiet_NaN();
+                    REQUIRE_EQUAL(Simd::FindNotWithinUlps(floats.data(), other_floats.data(), size, 1000), index);
+                    REQUIRE_EQUAL(Simd::FindNotWithinUlps(doubles.data(), other_doubles.data(), size, 1000), index);
+                }
+            }
+        }
+
+        SECTION("Opposite extremes do not overflow") {
+            std::vector<float> left(8, std::numeric_limits<float>::max());
+            std::vector<float> right(8, -std::numeric_limits<float>::max());
+            CHECK_THROW(AssertException, REQUIRE_ALL_CLOSE_ULPS(left, right, 16));
+        }
+
+        SECTION("Check fails") {
+            std::vector<float> left(16, 1.0f);
+            auto right = left;
+            right[3] = std::nextafter(1.0f, 2.0f);
+            right[7] = std::nanf("");
+
+            auto exception = Assert::AllCloseUlps(left, right, 0);
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(
+                std::string(exception->what()),
+                "Ranges are not within [0] ulps: 2 of 16 elements differ:\n    [3]: [1] != [1.0000001]\n    [7]: [1] != [nan]"
+                "\n    Largest error: [nan] at [7]"
+                "\n    Error histogram:"
+                "\n      0                       14"
+                "\n      [1, 2)                  1"
+                "\n      NaN                     1"
+            );
+        }
+
+        SECTION("Long labels") {
+            std::vector<float> left = { 1.0f };
+            std::vector<float> right = { -1.0f };
+
+            auto exception = Assert::AllCloseUlps(left, right, 0);
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(
+                std::string(exception->what()),
+                "Ranges are not within [0] ulps: 1 of 1 elements differ:\n    [0]: [1] != [-1]"
+                "\n    Largest error: [2130706432] at [0]"
+                "\n    Error histogram:"
+                "\n      [1073741824, 2147483648) 1"
+            );
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AssertTest, AllCloseRelative) {
+        SECTION("Check passes") {
+            std::vector<double> left = { 1e-20, 1.0, 1e10, -1e10, 0.0 };
+            std::vector<double> right = { 2e-20, 1.0 + 1e-7, 1e10 + 100.0, -1e10 - 100.0, 1e-13 };
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE_RELATIVE(left, right, 1e-6, 1e-12));
+
+            std::vector<float> floats(1001, 100.0f);
+            std::vector<float> other_floats(1001, 100.001f);
+            CHECK_NO_THROW(REQUIRE_ALL_CLOSE_RELATIVE(floats, other_floats, 1e-4f, 0.0f));
+        }
+
+        SECTION("Every mismatch position is found") {
+            std::vector<float> floats(40, 1.0f);
+            std::vector<double> doubles(40, 1.0);
+            for (size_t size = 1; size != floats.size(); ++size) {
+                for (size_t index = 0; index != size; ++index) {
+                    auto other_floats = floats;
+                    auto other_doubles = doubles;
+                    other_floats[index] = 1.1f;
+                    other_doubles[index] = std::numeric_limits<double>::quiet_NaN();
+                    REQUIRE_EQUAL(Simd::FindNotCloseRelative(floats.data(), other_floats.data(), size, 0.01f, 0.0f), index);
+                    REQUIRE_EQUAL(Simd::FindNotCloseRelative(doubles.data(), other_doubles.data(), size, 0.01, 0.0), index);
+                }
+            }
+        }
+
+        SECTION("Check fails") {
+            std::vector<double> left = { 1.0, 1.0, 1.0, 1.0 };
+            std::vector<double> right = { 1.0, 1.5, 1.0, 1.001 };
+
+            auto exception = Assert::AllCloseRelative(left, right, 1e-2, 0.0);
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("within relative [0.01] or absolute [0]: 1 of 4 elements differ:\n    [1]: [1] != [1.5]") != std::string::npos);
+            CHECK(message.find("Largest error: [0.3333333333333333] at [1]") != std::string::npos);
+            CHECK(message.find("\n      [1e-4, 1e-3)            1") != std::string::npos);
+        }
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <chrono>
+#include <stdexcept>
+
+#if defined(CPPUTF_HAS_ASYNC_IO)
+    #include <unistd.h>
+#endif
+
+using namespace CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace {
+    using CppUnitTestFrameworkTest::RecordingLogger;
+
+    struct AsyncTest {
+        std::string Order;
+
+#if defined(CPPUTF_HAS_ASYNC_IO)
+        int Pipe[2] = { -1, -1 };
+
+        AsyncTest() {
+            if (pipe(Pipe) != 0) {
+                throw std::runtime_error("Unable to create a pipe");
+            }
+        }
+        ~AsyncTest() {
+            close(Pipe[0]);
+            close(Pipe[1]);
+        }
+#endif
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+        // Returns the order in which the samples' continuations ran, followed by the test cases and their
+        // failures.
+        static std::string RunSamples(std::vector<std::string> args) {
+            args.push_back("AsyncSample::");
+            return CppUnitTestFrameworkTest::RunSamples(RecordingLogger::Tests | RecordingLogger::Failures, args);
+        }
+#endif
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    ASYNC_TEST_CASE(AsyncTest, Timers) {
+        // Continuations that are due together run in the order they were scheduled.
+        After(20ms, [this]() { Order += "20,"; });
+        After(10ms, [this]() { Order += "10a,"; });
+        After(10ms, [this]() { Order += "10b,"; });
+        Post([this]() { Order += "post,"; });
+        After(30ms, [this]() {
+            CHECK_EQUAL(Order, "post,10a,10b,20,");
+        });
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_ASYNC_IO)
+    ASYNC_TEST_CASE(AsyncTest, Pipe) {
+        WhenReadable(Pipe[0], [this]() {
+            char buffer[8] = {};
+            REQUIRE(read(Pipe[0], buffer, sizeof(buffer)) == 4);
+            CHECK_EQUAL(std::string(buffer), "ping");
+        });
+        WhenWritable(Pipe[1], [this]() {
+            After(10ms, [this]() {
+                REQUIRE(write(Pipe[1], "ping", 4) == 4);
+            });
+        });
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+    TEST_CASE(AsyncTest, Multiplexed) {
+        // The samples overlap, and are reported as they complete.
+        CHECK_EQUAL(
+            RunSamples({}),
+            "start 1,start 2,middle 2,end 1,end 2,"
+            "EnterTest AsyncSample::Failed\n"
+            "AssertFailed IsTrue(1 == 2): [1] == [2]\n"
+            "ExitTest failed\n"
+            "EnterTest AsyncSample::TimedOut\n"
+            "UnhandledException Timed out after 20 ms with 1 operations pending\n"
+            "ExitTest failed\n"
+            "EnterTest AsyncSample::First\n"
+            "ExitTest passed\n"
+            "EnterTest AsyncSample::Second\n"
+            "ExitTest passed\n"
+        );
+
+        SECTION("Limited") {
+            // Each sample starts once the one before it completes.
+            CHECK_EQUAL(
+                RunSamples({ "--async_limit=1" }),
+                "start 1,end 1,start 2,middle 2,end 2,"
+                "EnterTest AsyncSample::First\n"
+                "ExitTest passed\n"
+                "EnterTest AsyncSample::Second\n"
+                "ExitTest passed\n"
+                "EnterTest AsyncSample::Failed\n"
+                "AssertFailed IsTrue(1 == 2): [1] == [2]\n"
+                "ExitTest failed\n"
+                "EnterTest AsyncSample::TimedOut\n"
+                "UnhandledException Timed out after 20 ms with 1 operations pending\n"
+                "ExitTest failed\n"
+            );
+        }
+
+        SECTION("Isolated") {
+            // Each sample runs on its own.
+            CHECK_EQUAL(
+                RunSamples({ "--isolate" }),
+                "start 1,end 1,start 2,middle 2,end 2,"
+                "EnterTest AsyncSample::First\n"
+                "ExitTest passed\n"
+                "EnterTest AsyncSample::Second\n"
+                "ExitTest passed\n"
+                "EnterTest AsyncSample::Failed\n"
+                "AssertFailed IsTrue(1 == 2): [1] == [2]\n"
+                "ExitTest failed\n"
+                "EnterTest AsyncSample::TimedOut\n"
+                "UnhandledException Timed out after 20 ms with 1 operations pending\n"
+                "ExitTest failed\n"
+            );
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(AsyncTest, Options) {
+        const char* args[] = { "program", "--async_limit=8" };
+        RunOptions options;
+        REQUIRE(options.ParseCommandLine(2, args));
+        CHECK_EQUAL(options.AsyncLimit, 8u);
+
+        const char* zero[] = { "program", "--async_limit=0" };
+        RunOptions rejected;
+        CHECK_FALSE(rejected.ParseCommandLine(2, zero));
+
+        const char* empty[] = { "program", "--async_limit=" };
+        CHECK_FALSE(rejected.ParseCommandLine(2, empty));
+
+        const char* overflow[] = { "program", "--async_limit=99999999999999999999999" };
+        CHECK_FALSE(rejected.ParseCommandLine(2, overflow));
+    }
+
+}
@@ -0,0 +1,135 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace CppUnitTestFramework;
+
+#if defined(CPPUTF_HAS_CAPTURE) && defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+
+namespace {
+    using CppUnitTestFrameworkTest::RecordingLogger;
+
+    struct CaptureTest {
+        // The samples run in another process, so that redirecting stdout cannot catch the output of test cases
+        // running in parallel with this one.
+        static std::string RunSamples(std::vector<std::string> args) {
+            args.insert(args.end(), { "--capture", "CaptureSample::" });
+            return CppUnitTestFrameworkTest::RunSamples(RecordingLogger::Tests | RecordingLogger::Output, args);
+        }
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(CaptureTest, FailedTestCases) {
+        // The output of passing test cases is discarded.
+        CHECK_EQUAL(
+            RunSamples({ "--capture_limit=25" }),
+            "EnterTest CaptureSample::Passed\n"
+            "ExitTest passed\n"
+            "EnterTest CaptureSample::Failed\n"
+            "TestOutput [out,err,printf\n]\n"
+            "ExitTest failed\n"
+            "EnterTest CaptureSample::Truncated\n"
+            "TestOutput [01234567890123456789...]\n"
+            "ExitTest failed\n"
+        );
+
+        SECTION("Isolated") {
+            // A forked child's failed write is only seen by the child.
+            CHECK_EQUAL(
+                RunSamples({ "--capture_limit=25", "--isolate" }),
+                "EnterTest CaptureSample::Passed\n"
+                "ExitTest passed\n"
+                "EnterTest CaptureSample::Failed\n"
+                "TestOutput [out,err,printf\n]\n"
+                "ExitTest failed\n"
+                "EnterTest CaptureSample::Truncated\n"
+                "TestOutput [01234567890123456789]\n"
+                "ExitTest failed\n"
+            );
+        }
+
+        SECTION("Parallel") {
+            auto log = RunSamples({ "--capture_limit=25", "--isolate", "-j2" });
+            CHECK(log.find("EnterTest CaptureSample::Passed\nExitTest passed\n") != std::string::npos);
+            CHECK(log.find("EnterTest CaptureSample::Failed\nTestOutput [out,err,printf\n]\nExitTest failed\n") != std::string::npos);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(CaptureTest, Verbose) {
+        CHECK_EQUAL(
+            RunSamples({ "--verbose" }),
+            "EnterTest CaptureSample::Passed\n"
+            "TestOutput [passed\n]\n"
+            "ExitTest passed\n"
+            "EnterTest CaptureSample::Failed\n"
+            "TestOutput [out,err,printf\n]\n"
+            "ExitTest failed\n"
+            "EnterTest CaptureSample::Truncated\n"
+            "TestOutput [0123456789012345678901234567890123456789012345678901234567890123456789"
+            "012345678901234567890123456789]\n"
+            "ExitTest failed\n"
+        );
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(CaptureTest, ConsoleOutput) {
+        auto stream = std::make_shared<std::ostringstream>();
+        RunOptions options;
+        auto logger = ConsoleLogger::Create(&options, stream);
+
+        logger->EnterTest("Fixture::Test");
+        logger->AssertFailed(AssertType::Continue, AssertLocation{ __FILE__, 10 }, "message");
+        logger->TestOutput("line 1\nline 2\n", true);
+        logger->ExitTest(true);
+
+        // Indented so that test adapters take the output as part of the result.
+        CHECK_EQUAL(
+            stream->str(),
+            "Test: Fixture::Test\n"
+            "    @10 CHECK: message\n"
+            "    Output:\n"
+            "        line 1\n"
+            "        line 2\n"
+            "        [Truncated]\n"
+        );
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(CaptureTest, Options) {
+        auto parse = [](RunOptions& options, std::vector<const char*> args) {
+            args.insert(args.begin(), "program");
+            return options.ParseCommandLine(static_cast<int>(args.size()), args.data());
+        };
+
+        RunOptions options;
+        REQUIRE(parse(options, { "--capture_limit=4096" }));
+        CHECK(options.Capture);
+        CHECK_EQUAL(options.CaptureLimit, 4096u);
+
+        RunOptions isolated;
+        CHECK(parse(isolated, { "--capture", "-j2", "--isolate" }));
+
+        RunOptions threads;
+        CHECK_FALSE(parse(threads, { "--capture", "-j2" }));
+        RunOptions async;
+        CHECK_FALSE(parse(async, { "--capture", "--async_logging" }));
+        RunOptions zero;
+        CHECK_FALSE(parse(zero, { "--capture_limit=0" }));
+
+        RunOptions suffixed;
+        REQUIRE(parse(suffixed, { "--capture_limit=16K" }));
+        CHECK_EQUAL(suffixed.CaptureLimit, size_t(16) << 10);
+    }
+
+}
+
+#endif
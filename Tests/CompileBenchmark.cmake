@@ -0,0 +1,237 @@
+# Measures how the framework's macros scale with the size of a test suite.
+#
+# Generates FILE_COUNT test files, each with TEST_COUNT test cases of CHECK_COUNT assertions, then compiles and
+# links them twice: once header-only and once with CPPUTF_SPLIT_COMPILATION.  Compile time, object size, link
+# time and binary size are printed and written to <OUTPUT_DIR>/compile_benchmark.json.
+#
+# Run through the CompileBenchmark target, or directly:
+#   cmake -DCOMPILER=g++ -DCOMPILER_ID=GNU -DINCLUDE_DIR=<repo> -DOUTPUT_DIR=<dir> -P CompileBenchmark.cmake
+cmake_minimum_required(VERSION 3.23)
+
+foreach(required COMPILER COMPILER_ID INCLUDE_DIR OUTPUT_DIR)
+    if(NOT DEFINED ${required})
+        message(FATAL_ERROR "CompileBenchmark: ${required} must be defined")
+    endif()
+endforeach()
+if(NOT DEFINED FILE_COUNT)
+    set(FILE_COUNT 4)
+endif()
+if(NOT DEFINED TEST_COUNT)
+    set(TEST_COUNT 100)
+endif()
+if(NOT DEFINED CHECK_COUNT)
+    set(CHECK_COUNT 10)
+endif()
+separate_arguments(flags NATIVE_COMMAND "${FLAGS}")
+
+if(COMPILER_ID STREQUAL MSVC)
+    set(object_suffix .obj)
+    set(executable_suffix .exe)
+    list(APPEND flags /nologo /EHsc /std:c++17 /I${INCLUDE_DIR})
+else()
+    set(object_suffix .o)
+    set(executable_suffix "")
+    list(APPEND flags -std=c++17 -I${INCLUDE_DIR})
+endif()
+
+#------------------------------------------------------------------------------------------------------------
+
+function(current_microseconds out)
+    string(TIMESTAMP now "%s %f" UTC)
+    separate_arguments(now UNIX_COMMAND "${now}")
+    list(GET now 0 seconds)
+    list(GET now 1 micros)
+    string(REGEX REPLACE "^0+([0-9])" "\\1" micros "${micros}")
+    math(EXPR value "${seconds} * 1000000 + ${micros}")
+    set(${out} ${value} PARENT_SCOPE)
+endfunction()
+
+# Formats a duration in microseconds as seconds with three decimal places.
+function(format_seconds micros out)
+    math(EXPR whole "${micros} / 1000000")
+    math(EXPR fraction "(${micros} % 1000000) / 1000")
+    string(LENGTH "${fraction}" length)
+    if(length EQUAL 1)
+        set(fraction "00${fraction}")
+    elseif(length EQUAL 2)
+        set(fraction "0${fraction}")
+    endif()
+    set(${out} "${whole}.${fraction}" PARENT_SCOPE)
+endfunction()
+
+# Runs a command and stores its wall-clock duration in microseconds.
+function(timed_command out)
+    current_microseconds(start)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+    current_microseconds(end)
+    if(NOT result EQUAL 0)
+        string(REPLACE ";" " " command "${ARGN}")
+        message(FATAL_ERROR "CompileBenchmark: command failed (${result}): ${command}\n${output}")
+    endif()
+    math(EXPR elapsed "${end} - ${start}")
+    set(${out} ${elapsed} PARENT_SCOPE)
+endfunction()
+
+#------------------------------------------------------------------------------------------------------------
+
+# A test case body cycles through the common assertions and a handful of type pairs, so that each file
+# instantiates Assert::AreEqual and Ext::ToString as a typical test file would.
+function(generate_check index out)
+    math(EXPR kind "${index} % 6")
+    if(kind EQUAL 0)
+        set(check "CHECK_EQUAL(value + ${index}, ${index} + value);")
+    elseif(kind EQUAL 1)
+        set(check "CHECK_EQUAL(std::string(\"value ${index}\"), \"value ${index}\");")
+    elseif(kind EQUAL 2)
+        set(check "CHECK_CLOSE(value + ${index}.5, ${index}.5 + value, 0.01);")
+    elseif(kind EQUAL 3)
+        set(check "CHECK(value + ${index} >= ${index});")
+    elseif(kind EQUAL 4)
+        set(check "CHECK_EQUAL((std::vector<int>{ value, ${index} }), (std::vector<int>{ 0, ${index} }));")
+    else()
+        set(check "REQUIRE_EQUAL(static_cast<long>(value + ${index}), ${index});")
+    endif()
+    set(${out} "${check}" PARENT_SCOPE)
+endfunction()
+
+function(generate_file path file_index)
+    set(content "#include \"CppUnitTestFramework.hpp\"\n\n#include <string>\n#include <vector>\n\n")
+    string(APPEND content "namespace {\n    struct BenchmarkFixture${file_index} {\n        int value = 0;\n    };\n}\n\n")
+
+    math(EXPR last_test "${TEST_COUNT} - 1")
+    math(EXPR last_check "${CHECK_COUNT} - 1")
+    foreach(test RANGE ${last_test})
+        math(EXPR group "${test} % 8")
+        string(APPEND content "TEST_CASE_WITH_TAGS(BenchmarkFixture${file_index}, Test${test}, \"group${group}\") {\n")
+        if(CHECK_COUNT GREATER 0)
+            foreach(check RANGE ${last_check})
+                generate_check(${check} line)
+                string(APPEND content "    ${line}\n")
+            endforeach()
+        endif()
+        string(APPEND content "}\n\n")
+    endforeach()
+
+    file(WRITE "${path}" "${content}")
+endfunction()
+
+#------------------------------------------------------------------------------------------------------------
+
+set(source_dir "${OUTPUT_DIR}/compile_benchmark")
+file(REMOVE_RECURSE "${source_dir}")
+file(MAKE_DIRECTORY "${source_dir}")
+
+file(WRITE "${source_dir}/main.cpp" "#define GENERATE_UNIT_TEST_MAIN\n#include \"CppUnitTestFramework.hpp\"\n")
+set(sources "")
+math(EXPR last_file "${FILE_COUNT} - 1")
+foreach(file_index RANGE ${last_file})
+    generate_file("${source_dir}/Benchmark${file_index}.cpp" ${file_index})
+    list(APPEND sources "${source_dir}/Benchmark${file_index}.cpp")
+endforeach()
+
+math(EXPR total_tests "${FILE_COUNT} * ${TEST_COUNT}")
+math(EXPR total_checks "${total_tests} * ${CHECK_COUNT}")
+message(STATUS "CompileBenchmark: ${FILE_COUNT} files x ${TEST_COUNT} tests x ${CHECK_COUNT} checks (${total_tests} tests, ${total_checks} checks)")
+
+set(results "")
+foreach(mode header_only split)
+    set(mode_flags ${flags})
+    if(mode STREQUAL split)
+        if(COMPILER_ID STREQUAL MSVC)
+            list(APPEND mode_flags /DCPPUTF_SPLIT_COMPILATION)
+        else()
+            list(APPEND mode_flags -DCPPUTF_SPLIT_COMPILATION)
+        endif()
+    endif()
+
+    # The translation unit with main() is reported separately, as it compiles the framework in both modes.
+    set(objects "")
+    set(main_micros 0)
+    set(test_micros 0)
+    set(max_test_micros 0)
+    set(test_object_bytes 0)
+    foreach(source "${source_dir}/main.cpp" ${sources})
+        get_filename_component(name "${source}" NAME_WE)
+        set(object "${source_dir}/${mode}_${name}${object_suffix}")
+        if(COMPILER_ID STREQUAL MSVC)
+            timed_command(elapsed "${COMPILER}" ${mode_flags} /c "${source}" /Fo${object})
+        else()
+            timed_command(elapsed "${COMPILER}" ${mode_flags} -c "${source}" -o "${object}")
+        endif()
+        list(APPEND objects "${object}")
+
+        if(name STREQUAL main)
+            set(main_micros ${elapsed})
+            file(SIZE "${object}" main_object_bytes)
+        else()
+            math(EXPR test_micros "${test_micros} + ${elapsed}")
+            if(elapsed GREATER max_test_micros)
+                set(max_test_micros ${elapsed})
+            endif()
+            file(SIZE "${object}" bytes)
+            math(EXPR test_object_bytes "${test_object_bytes} + ${bytes}")
+        endif()
+    endforeach()
+
+    set(executable "${source_dir}/${mode}_Benchmark${executable_suffix}")
+    if(COMPILER_ID STREQUAL MSVC)
+        timed_command(link_micros "${COMPILER}" /nologo ${objects} /Fe${executable})
+    else()
+        timed_command(link_micros "${COMPILER}" ${objects} -o "${executable}" -pthread)
+    endif()
+    file(SIZE "${executable}" binary_bytes)
+
+    # The generated tests all pass.  Running them checks that the benchmark measured working code.
+    execute_process(COMMAND "${executable}" RESULT_VARIABLE result OUTPUT_QUIET)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "CompileBenchmark: ${executable} failed (${result})")
+    endif()
+
+    math(EXPR mean_test_micros "${test_micros} / ${FILE_COUNT}")
+    format_seconds(${main_micros} main_seconds)
+    format_seconds(${test_micros} test_seconds)
+    format_seconds(${mean_test_micros} mean_test_seconds)
+    format_seconds(${max_test_micros} max_test_seconds)
+    format_seconds(${link_micros} link_seconds)
+    math(EXPR mean_test_object_bytes "${test_object_bytes} / ${FILE_COUNT}")
+
+    message(STATUS "  ${mode}:")
+    message(STATUS "    main.cpp compile:       ${main_seconds} s, ${main_object_bytes} bytes")
+    message(STATUS "    test files compile:     ${test_seconds} s (mean ${mean_test_seconds} s, max ${max_test_seconds} s)")
+    message(STATUS "    test file objects:      ${test_object_bytes} bytes (mean ${mean_test_object_bytes} bytes)")
+    message(STATUS "    link:                   ${link_seconds} s")
+    message(STATUS "    binary:                 ${binary_bytes} bytes")
+
+    if(NOT results STREQUAL "")
+        string(APPEND results ",\n")
+    endif()
+    string(APPEND results
+        "    {\n"
+        "      \"mode\": \"${mode}\",\n"
+        "      \"main_compile_seconds\": ${main_seconds},\n"
+        "      \"main_object_bytes\": ${main_object_bytes},\n"
+        "      \"test_compile_seconds\": ${test_seconds},\n"
+        "      \"test_compile_seconds_mean\": ${mean_test_seconds},\n"
+        "      \"test_compile_seconds_max\": ${max_test_seconds},\n"
+        "      \"test_object_bytes\": ${test_object_bytes},\n"
+        "      \"link_seconds\": ${link_seconds},\n"
+        "      \"binary_bytes\": ${binary_bytes}\n"
+        "    }"
+    )
+endforeach()
+
+string(REPLACE "\\" "\\\\" compiler_json "${COMPILER}")
+string(REPLACE ";" " " flags_json "${FLAGS}")
+string(REPLACE "\"" "\\\"" flags_json "${flags_json}")
+file(WRITE "${OUTPUT_DIR}/compile_benchmark.json"
+    "{\n"
+    "  \"compiler\": \"${compiler_json}\",\n"
+    "  \"compiler_id\": \"${COMPILER_ID}\",\n"
+    "  \"flags\": \"${flags_json}\",\n"
+    "  \"files\": ${FILE_COUNT},\n"
+    "  \"tests_per_file\": ${TEST_COUNT},\n"
+    "  \"checks_per_test\": ${CHECK_COUNT},\n"
+    "  \"results\": [\n${results}\n  ]\n"
+    "}\n"
+)
+message(STATUS "CompileBenchmark: results written to ${OUTPUT_DIR}/compile_benchmark.json")
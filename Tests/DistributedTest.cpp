@@ -0,0 +1,128 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <array>
+#include <csignal>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(CPPUTF_HAS_FORK)
+    #include <sys/wait.h>
+#endif
+
+using namespace CppUnitTestFramework;
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+
+namespace {
+    using CppUnitTestFrameworkTest::RecordingLogger;
+
+    struct DistributedTest {
+        std::string Log;
+
+        // Runs the samples that match [keyword] through a coordinator.  Returns true if they all passed.
+        bool RunSamples(std::vector<std::string> args, std::string keyword = "DistributedSample::") {
+            args.push_back(std::move(keyword));
+            args.insert(args.begin(), "--record=" + std::to_string(
+                RecordingLogger::Runs | RecordingLogger::Tests | RecordingLogger::Sections | RecordingLogger::Failures
+            ));
+            auto run = CppUnitTestFrameworkTest::RunSampleExecutable(args);
+            Log = run.Output;
+            return WIFEXITED(run.Status) && WEXITSTATUS(run.Status) == 0;
+        }
+
+        // The lines recorded for each test case.  Workers complete test cases in any order, so they are sorted.
+        std::multiset<std::string> Results() const {
+            std::multiset<std::string> results;
+            for (auto start = Log.find("EnterTest "); start != std::string::npos; start = Log.find("EnterTest ", start)) {
+                auto end = Log.find('\n', Log.find("ExitTest ", start)) + 1;
+                results.insert(Log.substr(start, end - start));
+                start = end;
+            }
+            return results;
+        }
+
+        // The pass, fail and skip counts reported by EndRun.
+        std::array<size_t, 3> Counts() const {
+            std::array<size_t, 3> counts = {};
+            std::istringstream(Log.substr(Log.rfind("EndRun ") + 7)) >> counts[0] >> counts[1] >> counts[2];
+            return counts;
+        }
+
+        static bool ParseArgs(RunOptions& options, std::vector<const char*> args) {
+            args.insert(args.begin(), "program");
+            return options.ParseCommandLine(static_cast<int>(args.size()), args.data());
+        }
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Starts several worker processes, so it runs alone.
+    TEST_CASE_WITH_TAGS(DistributedTest, LocalWorkers, "exclusive") {
+        std::multiset<std::string> expected{
+            "EnterTest DistributedSample::Crashed\nUnhandledException Worker disconnected while running the test case\nExitTest failed\n",
+            "EnterTest DistributedSample::Failed\nAssertFailed [1] == [2]\nExitTest failed\n",
+            "EnterTest DistributedSample::Passed\nPushSection Section: Remote\nPopSection\nExitTest passed\n"
+        };
+
+        // A private Unix domain socket, then TCP on a port chosen by the system.
+        for (std::vector<std::string> coordinator : { std::vector<std::string>{}, { "--coordinator=tcp:127.0.0.1:0" } }) {
+            coordinator.push_back("--workers=2");
+            CHECK_FALSE(RunSamples(coordinator));
+
+            auto counts = Counts();
+            CHECK_EQUAL(counts[0], 1u);
+            CHECK_EQUAL(counts[1], 2u);
+            CHECK(counts[2] > 0u);
+            CHECK(Results() == expected);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE_WITH_TAGS(DistributedTest, IsolatedWorkers, "exclusive") {
+        CHECK_FALSE(RunSamples({ "--workers=1", "--isolate" }));
+
+        // The worker survives the crash and reports it like any other failure.
+        CHECK_EQUAL(Counts()[1], 2u);
+        CHECK(Results().count(
+            "EnterTest DistributedSample::Crashed\n"
+            "UnhandledException Test process terminated by signal " + std::to_string(SIGABRT) + "\n"
+            "ExitTest failed\n"
+        ) == 1);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE_WITH_TAGS(DistributedTest, ExclusiveResources, "exclusive") {
+        // Each worker would otherwise take one of the test cases at once.
+        CHECK(RunSamples({ "--workers=4" }, "DistributedExclusiveSample::"));
+        CHECK_EQUAL(Counts()[0], 4u);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(DistributedTest, Options) {
+        RunOptions options;
+        REQUIRE(ParseArgs(options, { "--coordinator=tcp:*:7000", "--workers", "3" }));
+        CHECK_EQUAL(options.Coordinator, "tcp:*:7000");
+        CHECK_EQUAL(options.LocalWorkers, 3u);
+
+        RunOptions worker;
+        REQUIRE(ParseArgs(worker, { "--worker", "unix:/tmp/tests.sock" }));
+        CHECK_EQUAL(worker.Worker, "unix:/tmp/tests.sock");
+
+        RunOptions no_workers;
+        CHECK_FALSE(ParseArgs(no_workers, { "--workers=0" }));
+        RunOptions both;
+        CHECK_FALSE(ParseArgs(both, { "--worker=unix:a", "--coordinator=unix:b" }));
+    }
+
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <csignal>
+
+using namespace CppUnitTestFramework;
+
+#if defined(CPPUTF_HAS_FORK)
+
+namespace {
+    using CppUnitTestFrameworkTest::RecordingLogger;
+
+    struct IsolationTest {
+        // Records the calls replayed from the child process.
+        std::shared_ptr<RecordingLogger> Logger = std::make_shared<RecordingLogger>(
+            RecordingLogger::Sections | RecordingLogger::Failures | RecordingLogger::Locations
+        );
+        std::shared_ptr<ForwardingLogger> FixtureLogger = ForwardingLogger::Create(Logger);
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(IsolationTest, Passed) {
+        bool failed = ForkedTestRunner::Run(*FixtureLogger, Logger, [&]() {
+            FixtureLogger->PushSection("Section: Child");
+            FixtureLogger->PopSection();
+            return false;
+        });
+
+        CHECK_FALSE(failed);
+        CHECK_EQUAL(Logger->Log, "PushSection Section: Child\nPopSection\n");
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(IsolationTest, Failed) {
+        SECTION("Check failed") {
+            bool failed = ForkedTestRunner::Run(*FixtureLogger, Logger, [&]() {
+                FixtureLogger->AssertFailed(AssertType::Continue, AssertLocation{ "file.cpp", 12 }, "[1] == [2]");
+                return true;
+            });
+
+            CHECK(failed);
+            CHECK_EQUAL(Logger->Log, "AssertFailed file.cpp:12 [1] == [2]\n");
+        }
+
+        SECTION("Exception thrown") {
+            Logger->Log.clear();
+            bool failed = ForkedTestRunner::Run(*FixtureLogger, Logger, []() -> bool {
+                throw std::runtime_error("Oops");
+            });
+
+            CHECK(failed);
+            CHECK_EQUAL(Logger->Log, "UnhandledException Oops\n");
+        }
+
+        SECTION("Process crashed") {
+            Logger->Log.clear();
+            bool failed = ForkedTestRunner::Run(*FixtureLogger, Logger, [&]() -> bool {
+                FixtureLogger->PushSection("Section: Crash");
+                std::abort();
+            });
+
+            CHECK(failed);
+            CHECK_EQUAL(
+                Logger->Log,
+                "PushSection Section: Crash\n"
+                "PopSection\n"
+                "UnhandledException Test process terminated by signal " + std::to_string(SIGABRT) + "\n"
+            );
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if !defined(CPPUTF_DECLARATIONS_ONLY)
+    // AsyncLogger is only visible to the implementation translation unit in split builds.
+    TEST_CASE(IsolationTest, TerminateWithAsyncLogging) {
+        // The child has no background thread to write the events, so it must not wait for them when it
+        // terminates.
+        auto async_logger = AsyncLogger::Create(std::make_shared<RecordingLogger>());
+        for (int index = 0; index != 1000; ++index) {
+            async_logger->SkipTest("Queued");
+        }
+
+        bool failed = ForkedTestRunner::Run(*FixtureLogger, Logger, []() -> bool {
+            std::terminate();
+        });
+
+        CHECK(failed);
+        CHECK_EQUAL(Logger->Log, "UnhandledException Test process terminated by signal " + std::to_string(SIGABRT) + "\n");
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(IsolationTest, StateIsNotShared) {
+        int value = 1;
+        bool failed = ForkedTestRunner::Run(*FixtureLogger, Logger, [&]() {
+            value = 2;
+            return value != 2;
+        });
+
+        CHECK_FALSE(failed);
+        CHECK_EQUAL(value, 1);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(SAMPLES_EXECUTABLE)
+    TEST_CASE(IsolationTest, FixtureConstructedInChild) {
+        // Each fixture constructor counts itself in a global, or crashes.  The FIXTURE_SETUP_ONCE state
+        // is created by the first child, and then by the parent for the second one.
+        CHECK_EQUAL(
+            RunSamples(RecordingLogger::Tests | RecordingLogger::Failures, { "--isolate", "IsolationSample::" }),
+            "EnterTest IsolationSample::First\n"
+            "ExitTest passed\n"
+            "EnterTest CrashedIsolationSample::Constructor\n"
+            "UnhandledException Test process terminated by signal " + std::to_string(SIGABRT) + "\n"
+            "ExitTest failed\n"
+            "EnterTest IsolationSample::Second\n"
+            "ExitTest passed\n"
+        );
+    }
+#endif
+
+}
+
+#endif
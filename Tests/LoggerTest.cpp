@@ -0,0 +1,279 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <fstream>
+#include <iterator>
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    struct LoggerTest {
+        std::shared_ptr<std::ostringstream> Output = std::make_shared<std::ostringstream>();
+
+        static void RunSampleTests(ILogger& logger) {
+            logger.BeginRun(3);
+
+            logger.SkipTest("Fixture::Skipped");
+
+            logger.EnterTest("Fixture::Passed");
+            logger.TestMetric("ops/s", 1500);
+            logger.ExitTest(false);
+
+            logger.EnterTest("Fixture::Failed");
+            logger.PushSection("Section: <outer>");
+            logger.AssertFailed(AssertType::Continue, AssertLocation{ "file.cpp", 12 }, "[\"a\" & 'b'] == [c]");
+            logger.PopSection();
+            logger.ExitTest(true);
+
+            logger.EndRun(1, 1, 1);
+        }
+
+        static bool Contains(const std::string& text, const std::string_view& fragment) {
+            return text.find(fragment) != std::string::npos;
+        }
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    bool ParseArgs(RunOptions& options, std::vector<const char*> args) {
+        args.insert(args.begin(), "program");
+        return options.ParseCommandLine(static_cast<int>(args.size()), args.data());
+    }
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(LoggerTest, JUnitLogger) {
+        auto logger = JUnitLogger::Create(Output);
+        RunSampleTests(*logger);
+
+        auto xml = Output->str();
+        CHECK(xml.rfind("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites tests=\"3\">", 0) == 0);
+        CHECK(Contains(xml, "<testcase classname=\"Fixture\" name=\"Skipped\">\n      <skipped/>\n    </testcase>"));
+        CHECK(Contains(xml, "<testcase classname=\"Fixture\" name=\"Passed\" time=\""));
+        CHECK(Contains(xml, "<properties><property name=\"ops/s\" value=\"1500\"/></properties>"));
+        CHECK(Contains(xml,
+            "<failure type=\"CHECK\" message=\"[&quot;a&quot; &amp; &apos;b&apos;] == [c]\">"
+            "file.cpp:12\nSection: &lt;outer&gt;</failure>"
+        ));
+        CHECK(Contains(xml, "  </testsuite>\n</testsuites>\n"));
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(LoggerTest, JsonLogger) {
+        auto logger = JsonLogger::Create(Output);
+        RunSampleTests(*logger);
+
+        auto json = Output->str();
+        CHECK(json.rfind("{\n  \"test_count\": 3,\n  \"tests\": [", 0) == 0);
+        CHECK(Contains(json, "{ \"name\": \"Fixture::Skipped\", \"status\": \"skipped\" }"));
+        CHECK(Contains(json, "{ \"name\": \"Fixture::Passed\", \"status\": \"passed\", \"duration\": "));
+        CHECK(Contains(json, "\"failures\": [], \"metrics\": { \"ops/s\": 1500 } }"));
+        CHECK(Contains(json,
+            "{ \"type\": \"CHECK\", \"file\": \"file.cpp\", \"line\": 12, \"sections\": [\"Section: <outer>\"], "
+            "\"message\": \"[\\\"a\\\" & 'b'] == [c]\" }"
+        ));
+        CHECK(Contains(json, "\"passed\": 1,\n  \"failed\": 1,\n  \"skipped\": 1\n}\n"));
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(LoggerTest, MultiLogger) {
+        auto second_output = std::make_shared<std::ostringstream>();
+        auto logger = MultiLogger::Create({ JsonLogger::Create(Output), JsonLogger::Create(second_output) });
+        RunSampleTests(*logger);
+
+        CHECK_FALSE(Output->str().empty());
+        CHECK_EQUAL(Output->str().size(), second_output->str().size());
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(LoggerTest, AsyncLogger) {
+        RecordingLogger expected;
+        RunSampleTests(expected);
+
+        SECTION("Events are forwarded in order and flushed by EndRun") {
+            auto sink = std::make_shared<RecordingLogger>();
+            auto logger = AsyncLogger::Create(sink);
+            RunSampleTests(*logger);
+
+            CHECK_EQUAL(sink->Log, expected.Log);
+        }
+
+        SECTION("A full ring blocks the test thread until the sink catches up") {
+            auto sink = std::make_shared<RecordingLogger>(RecordingLogger::All, std::chrono::microseconds(50));
+            auto logger = AsyncLogger::Create(sink, 2);
+            RunSampleTests(*logger);
+
+            CHECK_EQUAL(sink->Log, expected.Log);
+        }
+
+        SECTION("Destruction drains pending events") {
+            auto sink = std::make_shared<RecordingLogger>(RecordingLogger::All, std::chrono::microseconds(50));
+            {
+                auto logger = AsyncLogger::Create(sink, 1000);
+                for (int i = 0; i != 100; ++i) {
+                    logger->EnterTest("Fixture::Test" + std::to_string(i));
+                    logger->ExitTest(false);
+                }
+            }
+
+            std::string_view last_test = "EnterTest Fixture::Test99\nExitTest passed\n";
+            REQUIRE(sink->Log.size() >= last_test.size());
+            CHECK_EQUAL(std::string_view(sink->Log).substr(sink->Log.size() - last_test.size()), last_test);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_SIGACTION) && defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+    TEST_CASE(LoggerTest, AsyncLoggerFatalSignal) {
+        // The failures queued before the abort are written before the process dies of it.
+        auto run = RunSampleExecutable({ "--async_logging", "--verbose", "LoggerSample::" });
+        CHECK(WIFSIGNALED(run.Status));
+        CHECK_EQUAL(WTERMSIG(run.Status), SIGABRT);
+
+        size_t failure_count = 0;
+        for (auto start = run.Output.find(" CHECK: "); start != std::string::npos; start = run.Output.find(" CHECK: ", start + 1)) {
+            failure_count++;
+        }
+        CHECK_EQUAL(failure_count, 3000u);
+    }
+
+    TEST_CASE(LoggerTest, AsyncLoggerFatalSignalFile) {
+        // The report of the test case that completed before the abort reaches the --out file.
+        TempDirectory directory{ "cpputf_logger_test" };
+        auto file = (directory / "results.xml").string();
+        auto run = RunSampleExecutable({ "--async_logging", "--reporter=junit", "--out=" + file, "LoggerSample::" });
+        CHECK(WIFSIGNALED(run.Status));
+        CHECK_EQUAL(WTERMSIG(run.Status), SIGABRT);
+
+        std::ifstream input(file);
+        std::string contents{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+        CHECK(Contains(contents, "<testcase classname=\"LoggerSample\" name=\"Completed\""));
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(LoggerTest, ReporterOptions) {
+        SECTION("Default") {
+            RunOptions options;
+            REQUIRE(ParseArgs(options, { "keyword" }));
+            CHECK(options.Reporters.empty());
+            CHECK_FALSE(options.AsyncLogging);
+        }
+
+        SECTION("Async logging") {
+            RunOptions options;
+            REQUIRE(ParseArgs(options, { "--async_logging" }));
+            CHECK(options.AsyncLogging);
+        }
+
+        SECTION("Jobs") {
+            RunOptions options;
+            CHECK_EQUAL(options.Jobs, 1u);
+            REQUIRE(ParseArgs(options, { "-j4" }));
+            CHECK_EQUAL(options.Jobs, 4u);
+            REQUIRE(ParseArgs(options, { "--jobs", "3" }));
+            CHECK_EQUAL(options.Jobs, 3u);
+            REQUIRE(ParseArgs(options, { "--jobs=0" }));
+            CHECK(options.Jobs >= 1u);
+
+            RunOptions overflow;
+            CHECK_FALSE(ParseArgs(overflow, { "--jobs=99999999999999999999999" }));
+
+            RunOptions too_many;
+            CHECK_FALSE(ParseArgs(too_many, { "-j", "200000" }));
+            REQUIRE(ParseArgs(too_many, { "-j", "1024" }));
+            CHECK_EQUAL(too_many.Jobs, RunOptions::MaxJobs);
+        }
+
+        SECTION("Snapshots") {
+            RunOptions options;
+            CHECK_EQUAL(options.SnapshotDirectory, "snapshots");
+            REQUIRE(ParseArgs(options, { "--update_snapshots", "--snapshot_dir", "golden" }));
+            CHECK(options.UpdateSnapshots);
+            CHECK_EQUAL(options.SnapshotDirectory, "golden");
+        }
+
+        SECTION("Hyphens") {
+            RunOptions options;
+            REQUIRE(ParseArgs(options, { "--update-snapshots", "--snapshot-dir=golden-files", "--async-limit", "8" }));
+            CHECK(options.UpdateSnapshots);
+            CHECK_EQUAL(options.SnapshotDirectory, "golden-files");
+            CHECK_EQUAL(options.AsyncLimit, 8u);
+        }
+
+#if defined(CPPUTF_HAS_FORK)
+        SECTION("Isolation") {
+            RunOptions options;
+            REQUIRE(ParseArgs(options, { "--isolate" }));
+            CHECK(options.Isolate);
+        }
+#endif
+
+        SECTION("Reporters with outputs") {
+            RunOptions options;
+            REQUIRE(ParseArgs(options, { "--reporter=junit", "--out", "a.xml", "--reporter", "json", "--out=b.json", "--reporter=console" }));
+            REQUIRE_EQUAL(options.Reporters.size(), 3u);
+            CHECK_EQUAL(options.Reporters[0].Name, "junit");
+            CHECK_EQUAL(options.Reporters[0].OutputFile, "a.xml");
+            CHECK_EQUAL(options.Reporters[1].Name, "json");
+            CHECK_EQUAL(options.Reporters[1].OutputFile, "b.json");
+            CHECK_EQUAL(options.Reporters[2].Name, "console");
+            CHECK(options.Reporters[2].OutputFile.empty());
+        }
+
+        SECTION("Output without reporter redirects the console") {
+            RunOptions options;
+            REQUIRE(ParseArgs(options, { "--out=log.txt" }));
+            REQUIRE_EQUAL(options.Reporters.size(), 1u);
+            CHECK_EQUAL(options.Reporters[0].Name, "console");
+            CHECK_EQUAL(options.Reporters[0].OutputFile, "log.txt");
+        }
+
+        SECTION("Invalid") {
+            std::ostringstream errors;
+            auto old_buffer = std::cerr.rdbuf(errors.rdbuf());
+
+            RunOptions unknown_reporter;
+            CHECK_FALSE(ParseArgs(unknown_reporter, { "--reporter=xml" }));
+            RunOptions two_stdout_reporters;
+            CHECK_FALSE(ParseArgs(two_stdout_reporters, { "--reporter=junit", "--reporter=json" }));
+            RunOptions two_outputs;
+            CHECK_FALSE(ParseArgs(two_outputs, { "--reporter=junit", "--out=a", "--out=b" }));
+
+            std::cerr.rdbuf(old_buffer);
+        }
+
+        SECTION("Missing value") {
+            std::ostringstream errors;
+            auto old_buffer = std::cerr.rdbuf(errors.rdbuf());
+
+            // Another option is not taken as the value, and the option is reported as it was typed.
+            RunOptions next_option;
+            CHECK_FALSE(ParseArgs(next_option, { "--out", "--verbose" }));
+            RunOptions last_option;
+            CHECK_FALSE(ParseArgs(last_option, { "--jobs" }));
+            RunOptions empty_value;
+            CHECK_FALSE(ParseArgs(empty_value, { "--snapshot_dir=" }));
+
+            std::cerr.rdbuf(old_buffer);
+            CHECK_EQUAL(
+                errors.str(),
+                "Missing value for option: --out\n"
+                "Missing value for option: --jobs\n"
+                "Missing directory for option: --snapshot_dir\n"
+            );
+
+            // A single dash is still a value.
+            RunOptions options;
+            REQUIRE(ParseArgs(options, { "--out", "-" }));
+            CHECK_EQUAL(options.Reporters[0].OutputFile, "-");
+        }
+    }
+
+}
@@ -0,0 +1,205 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace CppUnitTestFramework;
+
+#if defined(CPPUTF_HAS_RESULT_CACHE) && defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE) && defined(RESULT_CACHE_SAMPLES)
+
+namespace {
+    using CppUnitTestFrameworkTest::RecordingLogger;
+
+    struct ResultCacheTest {
+        CppUnitTestFrameworkTest::TempDirectory Directory{ "cpputf_result_cache_test" };
+        std::string CacheFile = (Directory / "cache.txt").string();
+        std::string DataFile = (Directory / "result_cache_sample.txt").string();
+
+        ResultCacheTest() {
+            WriteData("1");
+        }
+
+        void WriteData(const std::string& contents) const {
+            std::ofstream(DataFile, std::ios::trunc) << contents;
+        }
+
+        // Runs the samples in the temporary directory, where their data file is.
+        std::string RunSamples(std::vector<std::string> args, const std::string& executable = RESULT_CACHE_SAMPLES) const {
+            args.push_back("--cache=" + CacheFile);
+            args.push_back("ResultCacheSample::");
+            return CppUnitTestFrameworkTest::RunSamples(RecordingLogger::Tests, args, Directory.Path().string(), executable);
+        }
+
+        // Copies the result cache samples into the temporary directory, with the marker constant in
+        // ResultCacheSamples.cpp changed, and returns the path of the copy.
+        std::string CopyChangedSamples() const {
+            std::ifstream input(RESULT_CACHE_SAMPLES, std::ios::binary);
+            std::string contents{ std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>() };
+
+            constexpr std::string_view marker = "cpputf_result_cache_marker_1";
+            auto position = contents.find(marker);
+            if (position == std::string::npos) {
+                throw std::runtime_error("The marker is missing from the samples executable");
+            }
+            contents[position + marker.size() - 1] = '2';
+
+            auto path = Directory / "changed_samples";
+            std::ofstream(path, std::ios::binary) << contents;
+            std::filesystem::permissions(path, std::filesystem::perms::owner_all);
+            return path.string();
+        }
+    };
+
+    struct ResultCacheFingerprint {
+        CppUnitTestFrameworkTest::TempDirectory Directory{ "cpputf_result_cache_fingerprint" };
+        std::string CacheFile = (Directory / "cache.txt").string();
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(ResultCacheTest, SkipsPassedTests) {
+        CHECK_EQUAL(
+            RunSamples({}),
+            "EnterTest ResultCacheSample::Edited\n"
+            "ExitTest passed\n"
+            "EnterTest ResultCacheSample::Passed\n"
+            "ExitTest passed\n"
+            "EnterTest ResultCacheSample::Failed\n"
+            "ExitTest failed\n"
+            "EnterTest ResultCacheSample::Data\n"
+            "ExitTest passed\n"
+        );
+
+        SECTION("Unchanged") {
+            CHECK_EQUAL(
+                RunSamples({}),
+                "CachedTest ResultCacheSample::Edited\n"
+                "CachedTest ResultCacheSample::Passed\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+                "CachedTest ResultCacheSample::Data\n"
+            );
+        }
+
+        SECTION("Data file changed") {
+            WriteData("2");
+            CHECK_EQUAL(
+                RunSamples({}),
+                "CachedTest ResultCacheSample::Edited\n"
+                "CachedTest ResultCacheSample::Passed\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+                "EnterTest ResultCacheSample::Data\n"
+                "ExitTest passed\n"
+            );
+        }
+
+        SECTION("Test case edited") {
+            // The edit moves the code of the other test cases, but doesn't change it.
+            CHECK_EQUAL(
+                RunSamples({}, RESULT_CACHE_SAMPLES_EDITED),
+                "EnterTest ResultCacheSample::Edited\n"
+                "ExitTest passed\n"
+                "CachedTest ResultCacheSample::Passed\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+                "CachedTest ResultCacheSample::Data\n"
+            );
+
+            // Only the latest result of each test case is kept.
+            CHECK_EQUAL(
+                RunSamples({}),
+                "EnterTest ResultCacheSample::Edited\n"
+                "ExitTest passed\n"
+                "CachedTest ResultCacheSample::Passed\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+                "CachedTest ResultCacheSample::Data\n"
+            );
+        }
+
+        SECTION("Constant changed") {
+            // Only one test case reads the constant.
+            CHECK_EQUAL(
+                RunSamples({}, CopyChangedSamples()),
+                "CachedTest ResultCacheSample::Edited\n"
+                "EnterTest ResultCacheSample::Passed\n"
+                "ExitTest passed\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+                "CachedTest ResultCacheSample::Data\n"
+            );
+        }
+
+        SECTION("Cache key changed") {
+            CHECK_EQUAL(
+                RunSamples({ "--cache_key=data-v2" }),
+                "EnterTest ResultCacheSample::Edited\n"
+                "ExitTest passed\n"
+                "EnterTest ResultCacheSample::Passed\n"
+                "ExitTest passed\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+                "EnterTest ResultCacheSample::Data\n"
+                "ExitTest passed\n"
+            );
+        }
+
+        SECTION("Cache disabled") {
+            CHECK_EQUAL(
+                RunSamples({ "--no_cache" }),
+                "EnterTest ResultCacheSample::Edited\n"
+                "ExitTest passed\n"
+                "EnterTest ResultCacheSample::Passed\n"
+                "ExitTest passed\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+                "EnterTest ResultCacheSample::Data\n"
+                "ExitTest passed\n"
+            );
+        }
+
+        SECTION("Parallel") {
+            // Cached test cases are reported before any are run.
+            CHECK_EQUAL(
+                RunSamples({ "-j2" }),
+                "CachedTest ResultCacheSample::Edited\n"
+                "CachedTest ResultCacheSample::Passed\n"
+                "CachedTest ResultCacheSample::Data\n"
+                "EnterTest ResultCacheSample::Failed\n"
+                "ExitTest failed\n"
+            );
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(ResultCacheFingerprint, Fingerprint) {
+        RunOptions options;
+        options.CacheFile = CacheFile;
+        ResultCache cache(&options);
+
+        auto fingerprint = cache.Fingerprint("Fixture::Test", {});
+        CHECK_EQUAL(fingerprint, cache.Fingerprint("Fixture::Test", {}));
+        CHECK(fingerprint != cache.Fingerprint("Fixture::Other", {}));
+        CHECK(fingerprint != cache.Fingerprint("Fixture::Test", { "slow" }));
+        CHECK(ResultCache::BinaryFingerprint() != 0u);
+
+        SECTION("Saved and loaded") {
+            REQUIRE(cache.Save({ fingerprint }));
+            ResultCache loaded(&options);
+            CHECK(loaded.Passed(fingerprint));
+            CHECK_FALSE(loaded.Passed(cache.Fingerprint("Fixture::Other", {})));
+        }
+    }
+
+}
+
+#endif
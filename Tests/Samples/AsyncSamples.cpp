@@ -0,0 +1,44 @@
+#include "CppUnitTestFramework.hpp"
+
+#include <chrono>
+#include <iostream>
+
+using namespace std::chrono_literals;
+
+namespace {
+    // Writes out the order in which the continuations run.  It is flushed straight away, so that it comes before
+    // the recorded log.
+    void Event(const char* event) {
+        std::cout << event << std::flush;
+    }
+
+    struct AsyncSample {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    ASYNC_TEST_CASE(AsyncSample, First) {
+        Event("start 1,");
+        After(100ms, []() { Event("end 1,"); });
+    }
+
+    ASYNC_TEST_CASE(AsyncSample, Second) {
+        Event("start 2,");
+        After(50ms, [this]() {
+            Event("middle 2,");
+            After(100ms, []() { Event("end 2,"); });
+        });
+    }
+
+    ASYNC_TEST_CASE(AsyncSample, Failed) {
+        // The second continuation is dropped once the first fails.
+        Post([this]() { REQUIRE(1 == 2); });
+        After(10ms, []() { Event("dropped,"); });
+    }
+
+    ASYNC_TEST_CASE(AsyncSample, TimedOut) {
+        SetTimeout(20ms);
+        After(1h, []() {});
+    }
+
+}
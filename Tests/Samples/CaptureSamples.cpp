@@ -0,0 +1,30 @@
+#include "CppUnitTestFramework.hpp"
+
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    struct CaptureSample {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(CaptureSample, Passed) {
+        std::cout << "passed" << std::endl;
+    }
+
+    TEST_CASE(CaptureSample, Failed) {
+        std::cout << "out," << std::flush;
+        std::cerr << "err,";
+        std::printf("printf\n");
+        CHECK(false);
+    }
+
+    TEST_CASE(CaptureSample, Truncated) {
+        for (int i = 0; i != 10; ++i) {
+            std::cout << "0123456789" << std::flush;
+        }
+        CHECK(false);
+    }
+
+}
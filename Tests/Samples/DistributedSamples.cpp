@@ -0,0 +1,59 @@
+#include "CppUnitTestFramework.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#if defined(CPPUTF_HAS_FORK)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#if defined(CPPUTF_HAS_FORK)
+
+namespace {
+    // Created by the DistributedExclusiveSample test cases while they run.  Creating it fails if another worker
+    // already holds it.  Named before the workers are forked, so that they all share it.
+    const std::string s_marker_path =
+        (std::filesystem::temp_directory_path() / ("cpputf_distributed_" + std::to_string(getpid()))).string();
+
+    struct DistributedSample {};
+    struct DistributedExclusiveSample : CppUnitTestFramework::CommonFixture {
+        using CommonFixture::CommonFixture;
+
+        void HoldMarker() {
+            int fd = open(s_marker_path.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0600);
+            REQUIRE(fd >= 0);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            close(fd);
+            unlink(s_marker_path.c_str());
+        }
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(DistributedSample, Passed) {
+        SECTION("Remote") {
+            CHECK_EQUAL(1, 1);
+        }
+    }
+
+    TEST_CASE(DistributedSample, Failed) {
+        CHECK_EQUAL(1, 2);
+    }
+
+    TEST_CASE(DistributedSample, Crashed) {
+        std::abort();
+    }
+
+    TEST_CASE_WITH_TAGS(DistributedExclusiveSample, First, "exclusive:marker") { HoldMarker(); }
+    TEST_CASE_WITH_TAGS(DistributedExclusiveSample, Second, "exclusive:marker") { HoldMarker(); }
+    TEST_CASE_WITH_TAGS(DistributedExclusiveSample, Third, "exclusive:marker") { HoldMarker(); }
+    TEST_CASE_WITH_TAGS(DistributedExclusiveSample, Fourth, "exclusive:marker") { HoldMarker(); }
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include "CppUnitTestFramework.hpp"
+
+#include <cstdlib>
+
+#if defined(CPPUTF_HAS_FORK)
+namespace {
+    int ConstructedFixtures = 0;
+
+    struct IsolatedState {
+        pid_t CreatedBy = getpid();
+    };
+
+    // Without --isolate, the second test case sees the first one's fixture.
+    struct IsolationSample {
+        IsolationSample() {
+            ++ConstructedFixtures;
+        }
+
+        FIXTURE_SETUP_ONCE(IsolatedState, State);
+    };
+
+    struct CrashedIsolationSample {
+        CrashedIsolationSample() {
+            std::abort();
+        }
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(IsolationSample, First) {
+        CHECK_EQUAL(ConstructedFixtures, 1);
+        CHECK_EQUAL(State->CreatedBy, getpid());
+    }
+
+    TEST_CASE(CrashedIsolationSample, Constructor) {}
+
+    TEST_CASE(IsolationSample, Second) {
+        // The state was created again by the parent for the later test cases.
+        CHECK_EQUAL(ConstructedFixtures, 1);
+        CHECK_EQUAL(State->CreatedBy, getppid());
+    }
+
+}
+#endif
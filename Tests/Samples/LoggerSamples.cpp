@@ -0,0 +1,22 @@
+#include "CppUnitTestFramework.hpp"
+
+#include <cstdlib>
+
+namespace {
+    struct LoggerSample {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    // Completes before LoggerSample::Aborted, so its report is written before the abort.
+    TEST_CASE(LoggerSample, Completed) {}
+
+    // Queues failures faster than the console writes them, then aborts.
+    TEST_CASE(LoggerSample, Aborted) {
+        for (int i = 0; i != 3000; ++i) {
+            CHECK_EQUAL(i, -1);
+        }
+        std::abort();
+    }
+
+}
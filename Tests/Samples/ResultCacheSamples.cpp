@@ -0,0 +1,40 @@
+// Built twice, as ResultCacheSamples and as ResultCacheSamplesEdited with RESULT_CACHE_SAMPLE_EDIT defined, so
+// that ResultCacheTest can check which test cases an edit re-runs.
+#include "CppUnitTestFramework.hpp"
+
+#include <string>
+
+namespace {
+    struct ResultCacheSample {};
+}
+
+// A constant read by ResultCacheSample::Passed, which ResultCacheTest changes in a copy of the executable.
+extern const char ResultCacheSampleMarker[];
+const char ResultCacheSampleMarker[] = "cpputf_result_cache_marker_1";
+
+namespace CppUnitTestFrameworkTest {
+
+    // First, so that the edit moves the code of the others.  Both versions are on one line, so that the line
+    // numbers of the others don't change either.
+    TEST_CASE(ResultCacheSample, Edited) {
+#if defined(RESULT_CACHE_SAMPLE_EDIT)
+        CHECK_EQUAL(std::string("edited").size(), 6u); CHECK(!std::string("edited").empty());
+#else
+        CHECK_EQUAL(std::string("original").size(), 8u);
+#endif
+    }
+
+    TEST_CASE(ResultCacheSample, Passed) {
+        // Read through a volatile pointer, so that the compiler keeps the reference to the constant.
+        const char* volatile marker = ResultCacheSampleMarker;
+        CHECK(marker[0] == 'c');
+    }
+
+    TEST_CASE(ResultCacheSample, Failed) {
+        CHECK(false);
+    }
+
+    // The data file is relative to the directory that the samples are run in.
+    TEST_CASE_WITH_TAGS(ResultCacheSample, Data, "cache_data:result_cache_sample.txt") {}
+
+}
@@ -0,0 +1,27 @@
+#include "CppUnitTestFramework.hpp"
+
+#include <stdexcept>
+
+namespace {
+    struct StressSample {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    STRESS_TEST(StressSample, Passed, 4, 100) {
+        CHECK(Iteration < 100);
+    }
+
+    // Every failure is reported, from whichever thread it happened on.
+    STRESS_TEST(StressSample, Failed, 4, 50) {
+        MaybeYield();
+        CHECK(ThreadIndex != 1);
+    }
+
+    STRESS_TEST(StressSample, Thrown, 4, 50) {
+        if (ThreadIndex == 2) {
+            throw std::runtime_error("thread 2");
+        }
+    }
+
+}
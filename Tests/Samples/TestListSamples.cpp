@@ -0,0 +1,13 @@
+#include "CppUnitTestFramework.hpp"
+
+namespace {
+    struct TestListSample {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(TestListSample, First) {}
+    TEST_CASE(TestListSample, FirstAgain) {}
+    TEST_CASE(TestListSample, Second) {}
+
+}
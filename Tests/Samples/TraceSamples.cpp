@@ -0,0 +1,17 @@
+#include "CppUnitTestFramework.hpp"
+
+namespace {
+    struct TraceSample {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(TraceSample, First) {
+        SECTION("Section") {
+            CHECK(false);
+        }
+    }
+
+    TEST_CASE(TraceSample, Second) {}
+
+}
@@ -0,0 +1,42 @@
+// The sample test cases that the tests run in a separate process (see RunSamples in TestHelpers.hpp), to check
+// how the framework runs and reports them.  Many of them fail on purpose, so they are kept out of the Tests
+// executable.
+//
+// When the first argument is "--record=<events>", the run is reported to a RecordingLogger that records those
+// events, and its log is written to stdout once the run is over.  Otherwise this behaves like the default main.
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main(int argc, const char* argv[]) {
+    std::shared_ptr<CppUnitTestFrameworkTest::RecordingLogger> recorder;
+    if (argc > 1 && std::strncmp(argv[1], "--record=", 9) == 0) {
+        recorder = std::make_shared<CppUnitTestFrameworkTest::RecordingLogger>(static_cast<unsigned>(std::stoul(argv[1] + 9)));
+        argv[1] = argv[0];
+        argv++;
+        argc--;
+    }
+
+    CppUnitTestFramework::RunOptions options;
+    if (!options.ParseCommandLine(argc, argv)) {
+        return 2;
+    }
+
+    CppUnitTestFramework::ILoggerPtr logger = recorder;
+    if (!logger) {
+        logger = CppUnitTestFramework::CreateLogger(&options);
+    }
+    if (!logger) {
+        return 2;
+    }
+
+    bool success = CppUnitTestFramework::TestRegistry::Run(&options, logger);
+
+    if (recorder) {
+        std::cout << recorder->Log << std::flush;
+    }
+    return success ? 0 : 1;
+}
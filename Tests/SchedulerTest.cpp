@@ -0,0 +1,133 @@
+#include "CppUnitTestFramework.hpp"
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    struct SchedulerTest {
+        static TestScheduler::Constraints Parse(std::vector<std::string_view> tags) {
+            return TestScheduler::ParseConstraints(tags);
+        }
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(SchedulerTest, ParseConstraints) {
+        SECTION("No constraints") {
+            auto constraints = Parse({ "gpu", "slow" });
+            CHECK_EQUAL(constraints.Weight, 1u);
+            CHECK(constraints.Exclusive.empty());
+        }
+
+        SECTION("Exclusive resources") {
+            auto constraints = Parse({ "exclusive:db", "gpu", "exclusive:port" });
+            REQUIRE_EQUAL(constraints.Exclusive.size(), 2u);
+            CHECK_EQUAL(constraints.Exclusive[0], "db");
+            CHECK_EQUAL(constraints.Exclusive[1], "port");
+        }
+
+        SECTION("Run alone") {
+            auto constraints = Parse({ "exclusive" });
+            CHECK_EQUAL(constraints.Weight, std::numeric_limits<size_t>::max());
+            CHECK(constraints.Exclusive.empty());
+        }
+
+        SECTION("Weight") {
+            CHECK_EQUAL(Parse({ "weight:4" }).Weight, 4u);
+            CHECK_EQUAL(Parse({ "weight:0" }).Weight, 1u);
+            CHECK_EQUAL(Parse({ "weight:x" }).Weight, 1u);
+            CHECK_EQUAL(Parse({ "weight:4x" }).Weight, 1u);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(SchedulerTest, Exclusive) {
+        TestScheduler scheduler(4);
+        scheduler.Add(0, Parse({ "exclusive:db" }));
+        scheduler.Add(1, Parse({ "exclusive:db" }));
+        scheduler.Add(2, Parse({}));
+
+        CHECK(scheduler.TryTake() == std::optional<size_t>(0));
+        // 1 is blocked on "db", so 2 fills the free slot.
+        CHECK(scheduler.TryTake() == std::optional<size_t>(2));
+        CHECK(scheduler.TryTake() == std::nullopt);
+
+        scheduler.Release(0);
+        CHECK(scheduler.TryTake() == std::optional<size_t>(1));
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(SchedulerTest, Weight) {
+        TestScheduler scheduler(4);
+        scheduler.Add(0, Parse({ "weight:3" }));
+        scheduler.Add(1, Parse({ "weight:2" }));
+        scheduler.Add(2, Parse({}));
+        scheduler.Add(3, Parse({ "weight:100" }));
+
+        CHECK(scheduler.TryTake() == std::optional<size_t>(0));
+        CHECK(scheduler.TryTake() == std::optional<size_t>(2));
+        CHECK(scheduler.TryTake() == std::nullopt);
+
+        scheduler.Release(2);
+        CHECK(scheduler.TryTake() == std::nullopt);
+        scheduler.Release(0);
+        CHECK(scheduler.TryTake() == std::optional<size_t>(1));
+        scheduler.Release(1);
+
+        // Heavier than the pool, so it runs alone.
+        CHECK(scheduler.TryTake() == std::optional<size_t>(3));
+        scheduler.Release(3);
+        CHECK(scheduler.Take() == std::nullopt);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(SchedulerTest, Threads) {
+        constexpr size_t TestCount = 200;
+        TestScheduler scheduler(4);
+        for (size_t id = 0; id != TestCount; ++id) {
+            scheduler.Add(id, Parse({ (id % 2) ? "exclusive:db" : "weight:2" }));
+        }
+
+        std::atomic<int> db_users{ 0 };
+        std::atomic<int> used_slots{ 0 };
+        std::atomic<bool> violated{ false };
+        std::atomic<size_t> completed{ 0 };
+
+        auto worker = [&]() {
+            while (auto id = scheduler.Take()) {
+                bool uses_db = (*id % 2) != 0;
+                int weight = uses_db ? 1 : 2;
+                // Both counters are always taken, so that they balance the releases below.
+                int db_count = uses_db ? ++db_users : 0;
+                int slot_count = (used_slots += weight);
+                if (db_count > 1 || slot_count > 4) {
+                    violated = true;
+                }
+                std::this_thread::yield();
+                if (uses_db) {
+                    --db_users;
+                }
+                used_slots -= weight;
+                completed++;
+                scheduler.Release(*id);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread != 4; ++thread) {
+            threads.emplace_back(worker);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        CHECK_FALSE(violated.load());
+        CHECK_EQUAL(completed.load(), TestCount);
+        CHECK_EQUAL(db_users.load(), 0);
+        CHECK_EQUAL(used_slots.load(), 0);
+    }
+
+}
@@ -94,7 +94,8 @@ namespace {
 namespace CppUnitTestFrameworkTest {
 
     namespace {
-        // We need a custom base type to hook the logger API.  This means manually rolling the test case.
+        // We need a custom base type to hook the logger API.  This means manually rolling the test case.  The
+        // hooked logger is shared, so these test cases never run concurrently.
         struct TestCase_Nesting : SectionTest {
             using SectionTest::SectionTest;
             static constexpr std::string_view SourceFile = __FILE__;
@@ -116,14 +117,15 @@ namespace CppUnitTestFrameworkTest {
                 CHECK_EQUAL(GetTestLog(), "Push Section: Outer\nPush Section: Inner\nPop\nPop\n");
             }
         };
-        std::vector<std::string_view> TestCase_Nesting::Tags = make_tags_array();
+        std::vector<std::string_view> TestCase_Nesting::Tags = make_tags_array("exclusive:SectionTest");
         TestRegistry::AutoReg<TestCase_Nesting> s_test_registrar_Nesting;
     }
 
     //--------------------------------------------------------------------------------------------------------
 
     namespace {
-        // We need a custom base type to hook the logger API.  This means manually rolling the test case.
+        // We need a custom base type to hook the logger API.  This means manually rolling the test case.  The
+        // hooked logger is shared, so these test cases never run concurrently.
         struct TestCase_BDD : SectionTest {
             using SectionTest::SectionTest;
             static constexpr std::string_view SourceFile = __FILE__;
@@ -157,7 +159,7 @@ Pop
                 );
             }
         };
-        std::vector<std::string_view> TestCase_BDD::Tags = make_tags_array();
+        std::vector<std::string_view> TestCase_BDD::Tags = make_tags_array("exclusive:SectionTest");
         TestRegistry::AutoReg<TestCase_BDD> s_test_registrar_BDD;
     }
 
@@ -0,0 +1,85 @@
+#include "CppUnitTestFramework.hpp"
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    struct ExpensiveState {
+        ExpensiveState() {
+            ++Constructions;
+        }
+        ~ExpensiveState() {
+            ++Destructions;
+        }
+
+        int Value = 42;
+
+        static inline int Constructions = 0;
+        static inline int Destructions = 0;
+    };
+
+    struct SharedSetupTest {
+        FIXTURE_SETUP_ONCE(ExpensiveState, State);
+    };
+
+    struct TaggedState {
+        int Value = 7;
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(SharedSetupTest, FirstUse) {
+        CHECK_EQUAL(State->Value, 42);
+        CHECK_EQUAL(ExpensiveState::Constructions, 1);
+        CHECK_EQUAL(ExpensiveState::Destructions, 0);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(SharedSetupTest, SecondUse) {
+        CHECK_EQUAL(State->Value, 42);
+        CHECK_EQUAL(ExpensiveState::Constructions, 1);
+        CHECK_EQUAL(ExpensiveState::Destructions, 0);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(SharedSetupTest, Lifetime) {
+        auto acquire = [](const std::string& tag) {
+            SharedSetupRegistry::AddPending(SharedSetupRegistry::ScopeKeys("SharedSetupTest.Lifetime", { tag }));
+            SharedSetupRegistry::AddPending(SharedSetupRegistry::ScopeKeys("SharedSetupTest.Lifetime", { tag }));
+            return SharedSetupRegistry::Acquire<TaggedState>(SharedScope::Tag, tag);
+        };
+        auto complete = [](const std::string& tag) {
+            SharedSetupRegistry::Complete(SharedSetupRegistry::ScopeKeys("SharedSetupTest.Lifetime", { tag }));
+        };
+
+        SECTION("State is shared within a scope") {
+            auto state = acquire("SharedSetupTest.Shared");
+            CHECK_EQUAL(state->Value, 7);
+            CHECK(state == SharedSetupRegistry::Acquire<TaggedState>(SharedScope::Tag, "SharedSetupTest.Shared"));
+            CHECK(state != SharedSetupRegistry::Acquire<TaggedState>(SharedScope::Tag, "SharedSetupTest.Other"));
+            complete("SharedSetupTest.Shared");
+            complete("SharedSetupTest.Shared");
+        }
+
+        SECTION("State is kept while test cases remain in scope") {
+            std::weak_ptr<const TaggedState> weak_state = acquire("SharedSetupTest.Pending");
+            complete("SharedSetupTest.Pending");
+            CHECK_FALSE(weak_state.expired());
+            complete("SharedSetupTest.Pending");
+            CHECK(weak_state.expired());
+        }
+
+        SECTION("State is kept while in use") {
+            auto state = acquire("SharedSetupTest.InUse");
+            std::weak_ptr<const TaggedState> weak_state = state;
+            complete("SharedSetupTest.InUse");
+            complete("SharedSetupTest.InUse");
+            CHECK_FALSE(weak_state.expired());
+            state.reset();
+            CHECK(weak_state.expired());
+        }
+    }
+
+}
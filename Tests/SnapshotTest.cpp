@@ -0,0 +1,111 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    // Points snapshots at a fresh temporary directory for the duration of a test case.  The settings are
+    // global, so the test cases that use this take the "snapshot_settings" resource.
+    struct SnapshotTest {
+        SnapshotTest()
+          : m_saved_settings(Snapshot::CurrentSettings())
+        {
+            Snapshot::CurrentSettings() = { Directory.Path().string(), false };
+        }
+
+        ~SnapshotTest() {
+            Snapshot::CurrentSettings() = m_saved_settings;
+        }
+
+        CppUnitTestFrameworkTest::TempDirectory Directory{ "cpputf_snapshot_test" };
+
+    private:
+        Snapshot::Settings m_saved_settings;
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE_WITH_TAGS(SnapshotTest, MatchesSnapshot, "exclusive:snapshot_settings") {
+        SECTION("Missing snapshot") {
+            auto exception = Assert::MatchesSnapshot("missing.txt", "value");
+            REQUIRE(exception.has_value());
+            CHECK_EQUAL(std::string(exception->what()).rfind("Snapshot not found: ", 0), 0u);
+        }
+
+        SECTION("Update creates the snapshot") {
+            Snapshot::CurrentSettings().Update = true;
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("group/created.txt", "line 1\nline 2\n"));
+            Snapshot::CurrentSettings().Update = false;
+
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("group/created.txt", "line 1\nline 2\n"));
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("group/created.txt", std::string("line 1\nline 2\n")));
+
+            size_t file_count = 0;
+            for ([[maybe_unused]] auto& entry : std::filesystem::directory_iterator(Directory / "group")) {
+                file_count++;
+            }
+            CHECK_EQUAL(file_count, 1u);
+        }
+
+        SECTION("Mismatch is reported as a diff") {
+            Snapshot::CurrentSettings().Update = true;
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("diff.txt", "alpha\nbeta\n"));
+            Snapshot::CurrentSettings().Update = false;
+
+            CHECK_THROW(AssertException, REQUIRE_SNAPSHOT("diff.txt", "alpha\ngamma\n"));
+            CHECK_THROW(AssertException, REQUIRE_SNAPSHOT("diff.txt", "alpha\nbeta\ngamma\n"));
+
+            auto exception = Assert::MatchesSnapshot("diff.txt", "alpha\ngamma\n");
+            REQUIRE(exception.has_value());
+            std::string message = exception->what();
+            CHECK(message.find("+++ actual\n@@ -1,2 +1,2 @@\n alpha\n-beta\n+gamma") != std::string::npos);
+        }
+
+        SECTION("Update rewrites a mismatched snapshot") {
+            Snapshot::CurrentSettings().Update = true;
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("rewrite.txt", "old"));
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("rewrite.txt", "new value"));
+            Snapshot::CurrentSettings().Update = false;
+
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("rewrite.txt", "new value"));
+            CHECK_THROW(AssertException, REQUIRE_SNAPSHOT("rewrite.txt", "old"));
+        }
+
+        SECTION("Values are converted to strings") {
+            const std::vector<int> values = { 1, 2, 3 };
+
+            Snapshot::CurrentSettings().Update = true;
+            CHECK_NO_THROW(REQUIRE_SNAPSHOT("values.txt", values));
+            Snapshot::CurrentSettings().Update = false;
+
+            auto file = MappedFile::Open((Directory / "values.txt").string());
+            REQUIRE(file != nullptr);
+            CHECK_EQUAL(file->Contents(), "{ 1, 2, 3 }");
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE_WITH_TAGS(SnapshotTest, MappedFile, "exclusive:snapshot_settings") {
+        SECTION("Missing file") {
+            CHECK(MappedFile::Open((Directory / "missing.txt").string()) == nullptr);
+            CHECK(MappedFile::Open(Directory.Path().string()) == nullptr);
+        }
+
+        SECTION("Empty file") {
+            std::ofstream((Directory / "empty.txt").string());
+            auto file = MappedFile::Open((Directory / "empty.txt").string());
+            REQUIRE(file != nullptr);
+            CHECK(file->Contents().empty());
+        }
+
+        SECTION("File contents") {
+            std::ofstream((Directory / "contents.txt").string(), std::ios::binary) << "some\ncontents";
+            auto file = MappedFile::Open((Directory / "contents.txt").string());
+            REQUIRE(file != nullptr);
+            CHECK_EQUAL(file->Contents(), "some\ncontents");
+        }
+    }
+
+}
@@ -0,0 +1,84 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <array>
+#include <atomic>
+#include <stdexcept>
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    using CppUnitTestFrameworkTest::RecordingLogger;
+
+    struct StressTest {
+        static constexpr size_t ThreadCount = 4;
+        static constexpr size_t IterationCount = 250;
+
+        std::atomic<size_t> Total{ 0 };
+        std::array<std::atomic<size_t>, ThreadCount> PerThread = {};
+
+        void Count(size_t thread_index) {
+            Total++;
+            PerThread[thread_index]++;
+        }
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(StressTest, Runner) {
+        auto result = StressRunner::Run(ThreadCount, IterationCount, [](void* self, size_t thread_index, size_t /*iteration*/) {
+            static_cast<StressTest*>(self)->Count(thread_index);
+        }, static_cast<StressTest*>(this));
+
+        CHECK_FALSE(result.Failure);
+        CHECK(result.OperationsPerSecond > 0);
+        CHECK_EQUAL(Total.load(), ThreadCount * IterationCount);
+        for (auto& count : PerThread) {
+            CHECK_EQUAL(count.load(), IterationCount);
+        }
+
+        SECTION("Failure") {
+            // The other threads stop once thread 3 fails.
+            Total = 0;
+            result = StressRunner::Run(ThreadCount, IterationCount, [](void* self, size_t thread_index, size_t iteration) {
+                if (thread_index == 3 && iteration == 10) {
+                    throw std::runtime_error("failed");
+                }
+                static_cast<StressTest*>(self)->Count(thread_index);
+            }, static_cast<StressTest*>(this));
+
+            REQUIRE(result.Failure);
+            REQUIRE_THROW(std::runtime_error, std::rethrow_exception(result.Failure));
+            CHECK(Total.load() < ThreadCount * IterationCount);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+    TEST_CASE(StressTest, Reporting) {
+        // Each of the 50 iterations on thread 1 fails.
+        std::string failures;
+        for (int i = 0; i != 50; ++i) {
+            failures += "AssertFailed IsTrue(ThreadIndex != 1): [1] != [1]\n";
+        }
+
+        CHECK_EQUAL(
+            RunSamples(RecordingLogger::Tests | RecordingLogger::Failures | RecordingLogger::Metrics, { "StressSample::" }),
+            "EnterTest StressSample::Passed\n"
+            "TestMetric ops/s per thread\n"
+            "ExitTest passed\n"
+            "EnterTest StressSample::Failed\n" +
+            failures +
+            "TestMetric ops/s per thread\n"
+            "ExitTest failed\n"
+            "EnterTest StressSample::Thrown\n"
+            "TestMetric ops/s per thread\n"
+            "UnhandledException thread 2\n"
+            "ExitTest failed\n"
+        );
+    }
+#endif
+
+}
@@ -0,0 +1,108 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    struct TestDataTest {
+        CppUnitTestFrameworkTest::TempDirectory Directory{ "cpputf_test_data_test" };
+
+        TestDataTest() {
+            Write("first.txt", "first file");
+            Write("second.txt", "second");
+        }
+        ~TestDataTest() {
+            // The registry is shared by the whole process, so drop this fixture's files from it and restore the
+            // default limit.
+            TestDataRegistry::SetLimit(0);
+            TestDataRegistry::SetLimit(RunOptions().TestDataLimit);
+        }
+
+        void Write(const std::string& name, const std::string& contents) const {
+            std::ofstream(Directory / name, std::ios::binary | std::ios::trunc) << contents;
+        }
+
+        std::string PathOf(const std::string& name) const {
+            return (Directory / name).string();
+        }
+    };
+
+    struct TestDataOptions {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE_WITH_TAGS(TestDataTest, Shared, "exclusive:test_data") {
+        auto first = TEST_DATA(PathOf("first.txt"));
+        CHECK_EQUAL(first.Text(), "first file");
+        CHECK_EQUAL(first.Size(), 10u);
+
+        // Different spellings of the same path share the mapping.
+        auto again = TEST_DATA((Directory / "." / "first.txt").string());
+        CHECK(again.Data() == first.Data());
+
+        SECTION("Missing file") {
+            REQUIRE_THROW(std::runtime_error, UNUSED_RETURN(TEST_DATA(PathOf("missing.txt"))));
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE_WITH_TAGS(TestDataTest, Unused, "exclusive:test_data") {
+        TestDataRegistry::SetLimit(12);
+        {
+            auto first = TEST_DATA(PathOf("first.txt"));
+            auto second = TEST_DATA(PathOf("second.txt"));
+            CHECK_EQUAL(TestDataRegistry::CachedBytes(), 0u);
+        }
+
+        // Only the most recently released file fits within the limit.
+        CHECK_EQUAL(TestDataRegistry::CachedBytes(), 10u);
+
+        SECTION("Reused") {
+            auto first = TEST_DATA(PathOf("first.txt"));
+            CHECK_EQUAL(TestDataRegistry::CachedBytes(), 0u);
+            CHECK_EQUAL(first.Text(), "first file");
+        }
+
+        SECTION("Rewritten") {
+            Write("first.txt", "rewritten");
+            auto path = Directory / "first.txt";
+            std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::hours(1));
+
+            CHECK_EQUAL(TEST_DATA(PathOf("first.txt")).Text(), "rewritten");
+        }
+
+        SECTION("Limit lowered") {
+            TestDataRegistry::SetLimit(0);
+            CHECK_EQUAL(TestDataRegistry::CachedBytes(), 0u);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(TestDataOptions, Options) {
+        // Like --capture_limit, the limit is in bytes with an optional suffix.
+        const char* args[] = { "program", "--data_limit=64M" };
+        RunOptions options;
+        REQUIRE(options.ParseCommandLine(2, args));
+        CHECK_EQUAL(options.TestDataLimit, size_t(64) << 20);
+
+        const char* bytes[] = { "program", "--data_limit=65536" };
+        RunOptions unsuffixed;
+        REQUIRE(unsuffixed.ParseCommandLine(2, bytes));
+        CHECK_EQUAL(unsuffixed.TestDataLimit, 65536u);
+
+        const char* invalid[] = { "program", "--data_limit=lots" };
+        RunOptions rejected;
+        CHECK_FALSE(rejected.ParseCommandLine(2, invalid));
+
+        const char* suffix_only[] = { "program", "--data_limit=M" };
+        CHECK_FALSE(rejected.ParseCommandLine(2, suffix_only));
+    }
+
+}
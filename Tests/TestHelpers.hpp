@@ -0,0 +1,224 @@
+#pragma once
+
+#include "CppUnitTestFramework.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <process.h>
+#else
+    #include <fcntl.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+namespace CppUnitTestFrameworkTest {
+
+    // A directory that is created in the system's temporary directory and removed, with its contents, when
+    // this is destroyed.  The name holds the process ID and a counter, so that every instance has its own
+    // directory even while the same tests run in parallel or in other processes.
+    class TempDirectory {
+    public:
+        explicit TempDirectory(const std::string& prefix)
+          : m_path(std::filesystem::temp_directory_path() / (prefix + "_" + UniqueSuffix()))
+        {
+            std::filesystem::create_directories(m_path);
+        }
+        ~TempDirectory() {
+            std::error_code error;
+            std::filesystem::remove_all(m_path, error);
+        }
+
+        TempDirectory(const TempDirectory&) = delete;
+        TempDirectory& operator=(const TempDirectory&) = delete;
+
+        const std::filesystem::path& Path() const { return m_path; }
+
+        std::filesystem::path operator/(const std::string& name) const { return m_path / name; }
+
+    private:
+        static std::string UniqueSuffix() {
+            static std::atomic<unsigned> s_count{ 0 };
+#if defined(_WIN32)
+            auto pid = _getpid();
+#else
+            auto pid = getpid();
+#endif
+            return std::to_string(pid) + "_" + std::to_string(s_count++);
+        }
+
+        std::filesystem::path m_path;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+    // Records ILogger calls as lines of text, such as "EnterTest Fixture::Test" or "ExitTest failed".  Only the
+    // kinds of call in [events] are recorded, and each call can be slowed by [delay] to simulate a slow
+    // terminal.
+    class RecordingLogger :
+        public CppUnitTestFramework::ILogger
+    {
+    public:
+        enum Events : unsigned {
+            Runs = 1 << 0,          // BeginRun and EndRun, with their counts
+            Tests = 1 << 1,         // EnterTest, ExitTest and CachedTest
+            Skips = 1 << 2,         // SkipTest
+            Sections = 1 << 3,      // SkipSection, PushSection and PopSection
+            Failures = 1 << 4,      // AssertFailed and UnhandledException, with their messages
+            Locations = 1 << 5,     // The source locations of failed assertions
+            Output = 1 << 6,        // TestOutput
+            Metrics = 1 << 7,       // The names of TestMetric calls
+            Values = 1 << 8,        // The values of TestMetric calls
+            All = (1 << 9) - 1
+        };
+
+        explicit RecordingLogger(unsigned events = All, std::chrono::microseconds delay = {})
+          : m_events(events),
+            m_delay(delay)
+        {}
+
+        std::string Log;
+
+        void BeginRun(size_t test_count) override {
+            Record(Runs, "BeginRun " + std::to_string(test_count));
+        }
+        void EndRun(size_t pass_count, size_t fail_count, size_t skip_count) override {
+            Record(Runs, "EndRun " + std::to_string(pass_count) + " " + std::to_string(fail_count) + " " + std::to_string(skip_count));
+        }
+
+        void SkipTest(const std::string_view& name) override { Record(Skips, "SkipTest " + std::string(name)); }
+        void EnterTest(const std::string_view& name) override { Record(Tests, "EnterTest " + std::string(name)); }
+        void ExitTest(bool failed) override { Record(Tests, failed ? "ExitTest failed" : "ExitTest passed"); }
+        void CachedTest(const std::string_view& name) override { Record(Tests, "CachedTest " + std::string(name)); }
+
+        void SkipSection(const std::string_view& name) override { Record(Sections, "SkipSection " + std::string(name)); }
+        void PushSection(const std::string_view& name) override { Record(Sections, "PushSection " + std::string(name)); }
+        void PopSection() override { Record(Sections, "PopSection"); }
+
+        void AssertFailed(
+            CppUnitTestFramework::AssertType /*type*/,
+            const CppUnitTestFramework::AssertLocation& location,
+            const std::string_view& message
+        ) override {
+            std::string line = "AssertFailed ";
+            if (m_events & Locations) {
+                line += std::string(location.SourceFile) + ":" + std::to_string(location.LineNumber) + " ";
+            }
+            Record(Failures, line + std::string(message));
+        }
+        void UnhandledException(const std::string_view& message) override {
+            Record(Failures, "UnhandledException " + std::string(message));
+        }
+
+        void TestOutput(const std::string_view& output, bool truncated) override {
+            Record(Output, "TestOutput [" + std::string(output) + (truncated ? "...]" : "]"));
+        }
+        void TestMetric(const std::string_view& name, double value) override {
+            Record(Metrics, "TestMetric " + std::string(name) + ((m_events & Values) ? " " + std::to_string(value) : ""));
+        }
+
+    private:
+        void Record(Events kind, const std::string& line) {
+            if ((m_events & kind) == 0) {
+                return;
+            }
+            if (m_delay.count() > 0) {
+                std::this_thread::sleep_for(m_delay);
+            }
+            Log += line + "\n";
+        }
+
+        unsigned m_events;
+        std::chrono::microseconds m_delay;
+    };
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+    // What a run of the samples executable produced.
+    struct SampleRun {
+        std::string Output;     // Everything written to stdout
+        int Status = 0;         // The wait status of the process
+    };
+
+    // Runs the samples executable (see Samples/main.cpp) with [args], in [directory] if that is not empty.  A
+    // copy of the executable can be run instead by giving its path as [executable].
+    inline SampleRun RunSampleExecutable(
+        const std::vector<std::string>& args,
+        const std::string& directory = {},
+        const std::string& executable = SAMPLES_EXECUTABLE
+    ) {
+        std::vector<const char*> argv{ executable.c_str() };
+        for (auto& arg : args) {
+            argv.push_back(arg.c_str());
+        }
+        argv.push_back(nullptr);
+
+        // Close-on-exec from the start, so that samples started by other threads at the same time don't hold
+        // the pipe open.
+        int fds[2];
+#if defined(__APPLE__)
+        // There is no pipe2(), so a fork on another thread between these calls can still inherit the pipe.
+        if (pipe(fds) != 0) {
+            throw std::runtime_error("Unable to create a pipe");
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#else
+        if (pipe2(fds, O_CLOEXEC) != 0) {
+            throw std::runtime_error("Unable to create a pipe");
+        }
+#endif
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            dup2(fds[1], STDOUT_FILENO);
+            if (directory.empty() || chdir(directory.c_str()) == 0) {
+                execv(argv[0], const_cast<char* const*>(argv.data()));
+            }
+            _exit(127);
+        }
+        close(fds[1]);
+        if (pid < 0) {
+            close(fds[0]);
+            throw std::runtime_error("Unable to start the samples");
+        }
+
+        SampleRun run;
+        char buffer[4096];
+        for (;;) {
+            auto received = read(fds[0], buffer, sizeof(buffer));
+            if (received < 0 && errno == EINTR) {
+                continue;
+            }
+            if (received <= 0) {
+                break;
+            }
+            run.Output.append(buffer, static_cast<size_t>(received));
+        }
+        close(fds[0]);
+
+        while (waitpid(pid, &run.Status, 0) < 0 && errno == EINTR) {}
+        return run;
+    }
+
+    // Runs the samples that [args] select, and returns the [events] that a RecordingLogger recorded from them.
+    inline std::string RunSamples(
+        unsigned events,
+        std::vector<std::string> args,
+        const std::string& directory = {},
+        const std::string& executable = SAMPLES_EXECUTABLE
+    ) {
+        args.insert(args.begin(), "--record=" + std::to_string(events));
+        return RunSampleExecutable(args, directory, executable).Output;
+    }
+#endif
+
+}
@@ -0,0 +1,122 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    using CppUnitTestFrameworkTest::RecordingLogger;
+
+    struct TestListTest {
+        CppUnitTestFrameworkTest::TempDirectory Directory{ "cpputf_test_list_test" };
+        std::string ListPath = (Directory / "tests.txt").string();
+
+        void WriteList(const std::string& contents) const {
+            std::ofstream(ListPath, std::ios::binary | std::ios::trunc) << contents;
+        }
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+        // Runs the samples that the list and [keywords] select.  Returns those that ran.
+        std::string RunSelected(std::vector<std::string> keywords = {}) const {
+            keywords.insert(keywords.begin(), "--test_list=" + ListPath);
+            return CppUnitTestFrameworkTest::RunSamples(RecordingLogger::Tests, keywords);
+        }
+#endif
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(TestListTest, Load) {
+        // Duplicates, blank lines and Windows line endings are all accepted.
+        WriteList("A::One\r\nB::Two\n\nA::One\nA::Three");
+        auto list = TestList::Load(ListPath);
+        REQUIRE(list);
+        CHECK_EQUAL(list->Size(), 3u);
+        CHECK(list->Contains("A::One"));
+        CHECK(list->Contains("B::Two"));
+        CHECK(list->Contains("A::Three"));
+
+        // Only whole names match.
+        CHECK_FALSE(list->Contains("A::"));
+        CHECK_FALSE(list->Contains("A::One\r"));
+
+        SECTION("Empty") {
+            WriteList("");
+            list = TestList::Load(ListPath);
+            REQUIRE(list);
+            CHECK_EQUAL(list->Size(), 0u);
+        }
+
+        SECTION("Missing") {
+            CHECK_FALSE(TestList::Load((Directory / "missing.txt").string()));
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(TestListTest, Options) {
+        WriteList("A::One\n");
+        auto option = "--test_list=" + ListPath;
+        const char* args[] = { "program", option.c_str() };
+        RunOptions options;
+        REQUIRE(options.ParseCommandLine(2, args));
+        REQUIRE(options.SelectedTests);
+        CHECK(options.SelectedTests->Contains("A::One"));
+
+        SECTION("Alias") {
+            auto alias = "--test-list=" + ListPath;
+            const char* alias_args[] = { "program", alias.c_str() };
+            RunOptions aliased;
+            REQUIRE(aliased.ParseCommandLine(2, alias_args));
+            REQUIRE(aliased.SelectedTests);
+            CHECK(aliased.SelectedTests->Contains("A::One"));
+        }
+
+        SECTION("Missing file name") {
+            const char* missing[] = { "program", "--test_list=" };
+            RunOptions rejected;
+            CHECK_FALSE(rejected.ParseCommandLine(2, missing));
+        }
+
+        SECTION("Unreadable") {
+            auto unreadable = "--test_list=" + (Directory / "missing.txt").string();
+            const char* unreadable_args[] = { "program", unreadable.c_str() };
+            RunOptions rejected;
+            CHECK_FALSE(rejected.ParseCommandLine(2, unreadable_args));
+        }
+
+        SECTION("Twice") {
+            const char* twice[] = { "program", option.c_str(), option.c_str() };
+            RunOptions rejected;
+            CHECK_FALSE(rejected.ParseCommandLine(3, twice));
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+    TEST_CASE(TestListTest, Run) {
+        // Unlike a keyword, a listed name doesn't match the names that it is a part of.
+        WriteList("TestListSample::First\n");
+        CHECK_EQUAL(RunSelected(), "EnterTest TestListSample::First\nExitTest passed\n");
+
+        SECTION("With keywords") {
+            CHECK_EQUAL(
+                RunSelected({ "TestListSample::Second" }),
+                "EnterTest TestListSample::First\nExitTest passed\n"
+                "EnterTest TestListSample::Second\nExitTest passed\n"
+            );
+        }
+
+        SECTION("Empty") {
+            WriteList("");
+            CHECK_EQUAL(RunSelected(), "");
+        }
+    }
+#endif
+
+}
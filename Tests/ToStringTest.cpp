@@ -14,16 +14,37 @@ namespace {
     struct CustomType {
         int Value;
     };
+
+    struct StreamableType {
+        int Value;
+    };
+
+    [[maybe_unused]] std::ostream& operator << (std::ostream& os, const StreamableType& value) {
+        return os << "<Streamable " << value.Value << ">";
+    }
+
+    struct FormattedType {
+        int Value;
+    };
 }
 
 namespace CppUnitTestFramework::Ext {
-    std::string ToString(const CustomType& value) {
+    inline std::string ToString(const CustomType& value) {
         std::ostringstream ss;
         ss << "[CustomType] " << value.Value;
         return ss.str();
     }
 }
 
+namespace CppUnitTestFramework::Ext {
+    template <>
+    struct Formatter<FormattedType> {
+        static void Append(std::string& out, const FormattedType& value) {
+            out += "<Formatted " + std::to_string(value.Value) + ">";
+        }
+    };
+}
+
 namespace CppUnitTestFrameworkTest {
 
     TEST_CASE(ToStringTest, Nullptr) {
@@ -45,10 +66,14 @@ namespace CppUnitTestFrameworkTest {
     //--------------------------------------------------------------------------------------------------------
 
     TEST_CASE(ToStringTest, Enum) {
-        CHECK_EQUAL(Ext::ToString(Untyped::Value1), "[enum `anonymous namespace'::ToStringTest::Untyped] 10");
-        CHECK_EQUAL(Ext::ToString(Untyped::Value2), "[enum `anonymous namespace'::ToStringTest::Untyped] -20");
-        CHECK_EQUAL(Ext::ToString(Typed::Value1), "[enum `anonymous namespace'::ToStringTest::Typed] 10");
-        CHECK_EQUAL(Ext::ToString(Typed::Value2), "[enum `anonymous namespace'::ToStringTest::Typed] 200");
+        // Type names are implementation defined, e.g. "enum `anonymous namespace'::ToStringTest::Untyped" on MSVC.
+        const std::string untyped_name = typeid(Untyped).name();
+        const std::string typed_name = typeid(Typed).name();
+
+        CHECK_EQUAL(Ext::ToString(Untyped::Value1), "[" + untyped_name + "] 10");
+        CHECK_EQUAL(Ext::ToString(Untyped::Value2), "[" + untyped_name + "] -20");
+        CHECK_EQUAL(Ext::ToString(Typed::Value1), "[" + typed_name + "] 10");
+        CHECK_EQUAL(Ext::ToString(Typed::Value2), "[" + typed_name + "] 200");
     }
 
     //--------------------------------------------------------------------------------------------------------
@@ -106,4 +131,67 @@ namespace CppUnitTestFrameworkTest {
         CHECK_EQUAL(Ext::ToString(value), "[CustomType] 1234");
     }
 
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(ToStringTest, FloatingPointRoundTrip) {
+        CHECK_EQUAL(Ext::ToString(0.1 + 0.2), "0.30000000000000004");
+        CHECK_EQUAL(Ext::ToString(1e100), "1e+100");
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(ToStringTest, NullString) {
+        const char* null_string = nullptr;
+        CHECK_EQUAL(Ext::ToString(null_string), "nullptr");
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE_WITH_TAGS(ToStringTest, Containers, "exclusive") {
+        SECTION("Sequences") {
+            CHECK_EQUAL(Ext::ToString(std::vector<int>()), "{}");
+            CHECK_EQUAL(Ext::ToString(std::vector<int>{ 1, 2, 3 }), "{ 1, 2, 3 }");
+            CHECK_EQUAL(Ext::ToString(std::array<std::string, 2>{ "a", "b" }), "{ a, b }");
+            CHECK_EQUAL(Ext::ToString(std::vector<std::vector<int>>{ { 1 }, {} }), "{ { 1 }, {} }");
+
+            int c_array[] = { 4, 5 };
+            CHECK_EQUAL(Ext::ToString(c_array), "{ 4, 5 }");
+        }
+
+        SECTION("Pairs and tuples") {
+            CHECK_EQUAL(Ext::ToString(std::make_pair(1, std::string("one"))), "(1, one)");
+            CHECK_EQUAL(Ext::ToString(std::make_tuple(1, 2.5, "three")), "(1, 2.5, three)");
+            CHECK_EQUAL(Ext::ToString(std::tuple<>()), "()");
+            CHECK_EQUAL(Ext::ToString(std::vector<std::pair<int, int>>{ { 1, 2 } }), "{ (1, 2) }");
+        }
+
+        SECTION("Optional elements") {
+            CHECK_EQUAL(Ext::ToString(std::vector<std::optional<int>>{ 1, std::nullopt }), "{ 1, ? }");
+        }
+
+        SECTION("Truncation") {
+            auto old_limit = Ext::MaxContainerElements();
+            Ext::MaxContainerElements() = 3;
+
+            CHECK_EQUAL(Ext::ToString(std::vector<int>{ 1, 2, 3 }), "{ 1, 2, 3 }");
+            CHECK_EQUAL(Ext::ToString(std::vector<int>(10000000, 7)), "{ 7, 7, 7, ... (10000000 elements) }");
+
+            Ext::MaxContainerElements() = old_limit;
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(ToStringTest, CustomizationPoints) {
+        SECTION("operator <<") {
+            CHECK_EQUAL(Ext::ToString(StreamableType{ 1 }), "<Streamable 1>");
+        }
+
+        SECTION("Formatter specialization") {
+            CHECK_EQUAL(Ext::ToString(FormattedType{ 2 }), "<Formatted 2>");
+            CHECK_EQUAL(Ext::ToString(std::vector<FormattedType>{ { 3 }, { 4 } }), "{ <Formatted 3>, <Formatted 4> }");
+        }
+    }
+
 }
\ No newline at end of file
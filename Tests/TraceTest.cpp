@@ -0,0 +1,136 @@
+#include "CppUnitTestFramework.hpp"
+#include "TestHelpers.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace CppUnitTestFramework;
+
+namespace {
+    struct TraceTest {
+        CppUnitTestFrameworkTest::TempDirectory Directory{ "cpputf_trace_test" };
+        std::string TracePath = (Directory / "trace.json").string();
+
+        // The trace file without the timestamps, which differ from run to run.
+        std::string ReadTrace() const {
+            std::ostringstream ss;
+            ss << std::ifstream(TracePath).rdbuf();
+            auto trace = ss.str();
+            for (size_t start; (start = trace.find(",\"ts\":")) != std::string::npos;) {
+                trace.erase(start, trace.find_first_not_of("0123456789.", start + 6) - start);
+            }
+            return trace;
+        }
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+        // Runs the samples with the usual reporters as well as the trace.
+        void RunSamples(std::vector<std::string> args) const {
+            args.insert(args.end(), {
+                "--reporter=json", "--out=" + (Directory / "report.json").string(), "--trace=" + TracePath, "TraceSample::"
+            });
+            CppUnitTestFrameworkTest::RunSampleExecutable(args);
+        }
+#endif
+    };
+
+    struct TraceOptions {};
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(TraceTest, Logger) {
+        auto recorder = TraceRecorder::Create(TracePath);
+        REQUIRE(recorder);
+        auto& track = recorder->AddTrack("Main thread");
+
+        // The sections left open by the failure are closed with the test case.
+        auto logger = TraceLogger::Create(track);
+        logger->EnterTest("Fixture::Failed");
+        logger->PushSection("Outer");
+        logger->PushSection("Inner");
+        logger->AssertFailed(AssertType::Throw, AssertLocation{ "File.cpp", 12 }, "message");
+        logger->ExitTest(true);
+
+        auto async_logger = TraceLogger::Create(track, 7);
+        async_logger->EnterTest("Fixture::Async");
+        async_logger->PushSection("Completed");
+        async_logger->PopSection();
+        async_logger->PushSection("Open");
+        async_logger->UnhandledException("\"quoted\"");
+        async_logger->ExitTest(false);
+
+        REQUIRE(recorder->Write());
+        CHECK_EQUAL(
+            ReadTrace(),
+            "{\"traceEvents\":[\n"
+            "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Main thread\"}},\n"
+            "{\"name\":\"Fixture::Failed\",\"ph\":\"B\",\"cat\":\"test\",\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Outer\",\"ph\":\"B\",\"cat\":\"test\",\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Inner\",\"ph\":\"B\",\"cat\":\"test\",\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"REQUIRE failed\",\"ph\":\"i\",\"cat\":\"failure\",\"s\":\"t\",\"pid\":1,\"tid\":0,\"args\":{\"message\":\"File.cpp(12): message\"}},\n"
+            "{\"name\":\"\",\"ph\":\"E\",\"cat\":\"test\",\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"\",\"ph\":\"E\",\"cat\":\"test\",\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Fixture::Failed\",\"ph\":\"E\",\"cat\":\"test\",\"pid\":1,\"tid\":0,\"args\":{\"result\":\"failed\"}},\n"
+            "{\"name\":\"Fixture::Async\",\"ph\":\"b\",\"cat\":\"test\",\"id\":7,\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Completed\",\"ph\":\"b\",\"cat\":\"test\",\"id\":7,\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Completed\",\"ph\":\"e\",\"cat\":\"test\",\"id\":7,\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Open\",\"ph\":\"b\",\"cat\":\"test\",\"id\":7,\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Unhandled exception\",\"ph\":\"i\",\"cat\":\"failure\",\"s\":\"t\",\"pid\":1,\"tid\":0,\"args\":{\"message\":\"\\\"quoted\\\"\"}},\n"
+            "{\"name\":\"Open\",\"ph\":\"e\",\"cat\":\"test\",\"id\":7,\"pid\":1,\"tid\":0},\n"
+            "{\"name\":\"Fixture::Async\",\"ph\":\"e\",\"cat\":\"test\",\"id\":7,\"pid\":1,\"tid\":0,\"args\":{\"result\":\"passed\"}}\n"
+            "],\"displayTimeUnit\":\"ms\"}\n"
+        );
+
+        SECTION("Unable to open") {
+            CHECK_FALSE(TraceRecorder::Create((Directory / "missing" / "trace.json").string()));
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+#if defined(CPPUTF_HAS_FORK) && defined(SAMPLES_EXECUTABLE)
+    TEST_CASE(TraceTest, Run) {
+        RunSamples({});
+        auto trace = ReadTrace();
+        CHECK(trace.find("\"args\":{\"name\":\"Main thread\"}") != std::string::npos);
+        CHECK(trace.find("{\"name\":\"Section: Section\",\"ph\":\"B\"") != std::string::npos);
+        CHECK(trace.find("{\"name\":\"CHECK failed\",\"ph\":\"i\"") != std::string::npos);
+        CHECK(trace.find("{\"name\":\"TraceSample::First\",\"ph\":\"E\",\"cat\":\"test\",\"pid\":1,\"tid\":0,\"args\":{\"result\":\"failed\"}}") != std::string::npos);
+        CHECK(trace.find("{\"name\":\"TraceSample::Second\",\"ph\":\"E\",\"cat\":\"test\",\"pid\":1,\"tid\":0,\"args\":{\"result\":\"passed\"}}") != std::string::npos);
+
+        SECTION("Parallel") {
+            // Each thread has a track of its own.
+            RunSamples({ "-j2" });
+            trace = ReadTrace();
+            CHECK(trace.find("\"tid\":0,\"args\":{\"name\":\"Thread 1\"}") != std::string::npos);
+            CHECK(trace.find("\"tid\":1,\"args\":{\"name\":\"Thread 2\"}") != std::string::npos);
+            CHECK(trace.find("{\"name\":\"TraceSample::First\",\"ph\":\"B\"") != std::string::npos);
+            CHECK(trace.find("{\"name\":\"TraceSample::Second\",\"ph\":\"B\"") != std::string::npos);
+        }
+
+        SECTION("More jobs than test cases") {
+            // Only one thread is started per test case.
+            RunSamples({ "-j64" });
+            trace = ReadTrace();
+            CHECK(trace.find("\"args\":{\"name\":\"Thread 2\"}") != std::string::npos);
+            CHECK(trace.find("\"args\":{\"name\":\"Thread 3\"}") == std::string::npos);
+        }
+    }
+#endif
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(TraceOptions, Options) {
+        const char* args[] = { "program", "--trace", "out.json" };
+        RunOptions options;
+        REQUIRE(options.ParseCommandLine(3, args));
+        CHECK_EQUAL(options.TraceFile, "out.json");
+
+        const char* missing[] = { "program", "--trace=" };
+        RunOptions rejected;
+        CHECK_FALSE(rejected.ParseCommandLine(2, missing));
+    }
+
+}
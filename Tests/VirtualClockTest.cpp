@@ -0,0 +1,131 @@
+#include "CppUnitTestFramework.hpp"
+
+#include <chrono>
+#include <functional>
+#include <string>
+
+using namespace CppUnitTestFramework;
+using namespace std::chrono_literals;
+
+namespace {
+    // Code under test that sleeps between attempts, doubling the delay each time.
+    struct Retrier {
+        IClockPtr Clock;
+
+        template <typename TAttempt>
+        int Run(TAttempt attempt) {
+            auto delay = IClock::Duration(1s);
+            int attempts = 1;
+            while (!attempt()) {
+                Clock->SleepFor(delay);
+                delay *= 2;
+                attempts++;
+            }
+            return attempts;
+        }
+    };
+
+    struct VirtualClockTest : VirtualClockFixture {
+        std::string Order;
+
+        // Seconds since the clock was created.
+        long long Elapsed() const {
+            return std::chrono::duration_cast<std::chrono::seconds>(TestClock->Now().time_since_epoch()).count();
+        }
+    };
+
+    // Uses assertions in the fixture, alongside the clock.
+    struct VirtualClockCommon : CommonFixture, VirtualClockFixture {
+        using CommonFixture::CommonFixture;
+
+        void CheckElapsed(long long seconds) {
+            CHECK_EQUAL(std::chrono::duration_cast<std::chrono::seconds>(TestClock->Now().time_since_epoch()).count(), seconds);
+        }
+    };
+}
+
+namespace CppUnitTestFrameworkTest {
+
+    TEST_CASE(VirtualClockTest, Advance) {
+        TestClock->After(20s, [this]() { Order += "20@" + std::to_string(Elapsed()) + ","; });
+        TestClock->After(10s, [this]() { Order += "10a@" + std::to_string(Elapsed()) + ","; });
+        TestClock->After(10s, [this]() {
+            Order += "10b,";
+            TestClock->After(5s, [this]() { Order += "15@" + std::to_string(Elapsed()) + ","; });
+        });
+
+        AdvanceClock(12s);
+        CHECK_EQUAL(Order, "10a@10,10b,");
+        CHECK_EQUAL(Elapsed(), 12);
+
+        AdvanceClock(10s);
+        CHECK_EQUAL(Order, "10a@10,10b,15@15,20@20,");
+        CHECK_EQUAL(Elapsed(), 22);
+        CHECK_EQUAL(TestClock->PendingTimers(), 0u);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(VirtualClockTest, Cancel) {
+        auto cancelled = TestClock->After(1s, [this]() { Order += "cancelled,"; });
+        TestClock->After(2s, [this]() { Order += "kept,"; });
+
+        CHECK(TestClock->Cancel(cancelled));
+        CHECK_FALSE(TestClock->Cancel(cancelled));
+        AdvanceClock(1h);
+        CHECK_EQUAL(Order, "kept,");
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(VirtualClockTest, RunAll) {
+        TestClock->After(1h, [this]() { Order += "1h,"; });
+        TestClock->After(1min, [this]() { Order += "1min,"; });
+        CHECK(RunAllTimers());
+        CHECK_EQUAL(Order, "1min,1h,");
+        CHECK_EQUAL(Elapsed(), 3600);
+
+        SECTION("Rescheduled forever") {
+            int ticks = 0;
+            std::function<void()> tick = [&]() {
+                ticks++;
+                TestClock->After(1s, tick);
+            };
+            TestClock->After(1s, tick);
+
+            CHECK_FALSE(RunAllTimers(50));
+            CHECK_EQUAL(ticks, 50);
+            CHECK_EQUAL(TestClock->PendingTimers(), 1u);
+        }
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(VirtualClockTest, SleepFor) {
+        // Eighteen hours of back-off pass at once, and runs the timers on the way.
+        TestClock->After(10s, [this]() { Order += "timer@" + std::to_string(Elapsed()); });
+
+        Retrier retrier{ TestClock };
+        int calls = 0;
+        CHECK_EQUAL(retrier.Run([&]() { return ++calls == 17; }), 17);
+        CHECK_EQUAL(Elapsed(), (1 << 16) - 1);
+        CHECK_EQUAL(Order, "timer@10");
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(VirtualClockCommon, WithCommonFixture) {
+        AdvanceClock(90s);
+        CheckElapsed(90);
+    }
+
+    //--------------------------------------------------------------------------------------------------------
+
+    TEST_CASE(VirtualClockTest, SystemClock) {
+        auto clock = SystemClock::Create();
+        auto before = clock->Now();
+        clock->SleepFor(1ms);
+        CHECK(clock->Now() - before >= IClock::Duration(1ms));
+    }
+
+}
@@ -20,6 +20,9 @@ interface TestConfiguration {
 //------------------------------------------------------------------------------------------------------------
 
 export class Adapter extends DisposableBase implements TestAdapter {
+    // Test states are fired in batches, at most this often (in milliseconds).
+    private static readonly TestStatesDelay: number = 100;
+
     private readonly _testLoadEmitter = new vscode.EventEmitter<TestLoadStartedEvent | TestLoadFinishedEvent>();
     private readonly _testStatesEmitter = new vscode.EventEmitter<TestSuiteEvent | TestEvent>();
     private readonly _reloadEmitter = new vscode.EventEmitter<void>();
@@ -32,6 +35,9 @@ export class Adapter extends DisposableBase implements TestAdapter {
     private _executableWatcher?: vscode.FileSystemWatcher = undefined;
     private _testRun?: AsyncExec = undefined;
 
+    private readonly _pendingTestStates = new Map<string, TestEvent>();
+    private _testStatesTimer?: NodeJS.Timeout = undefined;
+
     //----------------------------------------------------------------------------------------------------
 
     get testStates() : vscode.Event<TestSuiteEvent | TestEvent> {
@@ -89,6 +95,16 @@ export class Adapter extends DisposableBase implements TestAdapter {
             this.untrackAndDispose(this._testRun);
             this._testRun = undefined;
         }
+        this._flushTestStates();
+    }
+
+    public dispose() {
+        if (this._testStatesTimer) {
+            clearTimeout(this._testStatesTimer);
+            this._testStatesTimer = undefined;
+        }
+
+        super.dispose();
     }
 
     //----------------------------------------------------------------------------------------------------
@@ -182,7 +198,7 @@ export class Adapter extends DisposableBase implements TestAdapter {
             children: []
         };
 
-        const resolveSourceFile = (sourceFile: string): string => {
+        const findSourceFile = (sourceFile: string): string => {
             // If the source file can be found (either absolute or relative) then just us it.
             if (fs.existsSync(sourceFile)) { return sourceFile; }
 
@@ -197,13 +213,23 @@ export class Adapter extends DisposableBase implements TestAdapter {
             return sourceFile;
         };
 
+        // Many tests share each source file, so each is only looked up once.
+        const resolvedSourceFiles = new Map<string, string>();
+        const resolveSourceFile = (sourceFile: string): string => {
+            let resolved = resolvedSourceFiles.get(sourceFile);
+            if (resolved === undefined) {
+                resolved = findSourceFile(sourceFile);
+                resolvedSourceFiles.set(sourceFile, resolved);
+            }
+            return resolved;
+        };
+
+        const fixtureSuites = new Map<string, TestSuiteInfo>();
         const handleLine = (line: string) => {
             const [fixtureTest, sourceFile, sourceLine] = line.split(',');
             const [fixture, test] = fixtureTest.split('::');
             
-            let fixtureTests = <TestSuiteInfo>testSuite.children.find(
-                value => value.id == fixture
-            );
+            let fixtureTests = fixtureSuites.get(fixture);
             if (!fixtureTests) {
                 fixtureTests = {
                     type: 'suite',
@@ -211,6 +237,7 @@ export class Adapter extends DisposableBase implements TestAdapter {
                     label: fixture,
                     children: []
                 };
+                fixtureSuites.set(fixture, fixtureTests);
                 testSuite.children.push(fixtureTests);
             }
 
@@ -292,7 +319,7 @@ export class Adapter extends DisposableBase implements TestAdapter {
 
         let testsComplete: boolean = false;
         let currentTestName: string = '';
-        let currentMessageLines: string[] = [];
+        let currentMessage: string = '';
 
         const handleLine = (line: string) => {
             if (testsComplete) {
@@ -310,17 +337,16 @@ export class Adapter extends DisposableBase implements TestAdapter {
                 // The current test has finished.  Update the status.
                 const passed = line.substring(15) == "passed";
                 const status = passed ? "passed" : "failed";
-                const message = currentMessageLines.join(os.EOL);
-                this._updateTestStatus(currentTestName, status, message);
+                this._updateTestStatus(currentTestName, status, currentMessage);
 
                 currentTestName = '';
-                currentMessageLines = [];
+                currentMessage = '';
                 return;
             }
 
             if (line.startsWith('Skip:')) {
-                const testName = line.substring(6);
-                this._updateTestStatus(testName, "skipped", "");
+                // Only the tests that don't match [testIds] are skipped.  They weren't asked for, so their
+                // state is left alone.
                 return;
             }
 
@@ -347,7 +373,7 @@ export class Adapter extends DisposableBase implements TestAdapter {
                 }
 
                 // Assume output from the test
-                currentMessageLines.push(line);
+                currentMessage += (currentMessage.length != 0) ? os.EOL + line : line;
                 return;
             }
 
@@ -356,10 +382,14 @@ export class Adapter extends DisposableBase implements TestAdapter {
             return;
         };
 
+        const selection = this._writeTestList(testIds);
+
         return new Promise<void>((resolve, reject) => {
             this.track(this._testRun = new AsyncExec(this._logger));
             
             this._testRun.onExit((code) => {
+                this._flushTestStates();
+                this._deleteTestList(selection.testListFile);
                 if (code == 0) {
                     this._logger.write('Done.');
                     resolve();
@@ -371,6 +401,8 @@ export class Adapter extends DisposableBase implements TestAdapter {
                 this._testRun = undefined;
             })
             this._testRun.onError((error) => {
+                this._flushTestStates();
+                this._deleteTestList(selection.testListFile);
                 this._logger.write('Failed with error ' + error.message);
                 reject(error);
                 this.untrack(<AsyncExec>this._testRun);
@@ -378,7 +410,7 @@ export class Adapter extends DisposableBase implements TestAdapter {
             });
             this._testRun.onStdoutLine(handleLine);
 
-            const execArgs: string[] = [ "--verbose", "--adapter_info", ...testIds ];
+            const execArgs: string[] = [ "--verbose", "--adapter_info", ...selection.args ];
 
             this._logger.write('Running tests...');
             this._testRun.start(
@@ -411,7 +443,8 @@ export class Adapter extends DisposableBase implements TestAdapter {
             return;
         }
 
-        const execArgs: string[] = [ "--verbose", ...testIds ];
+        const selection = this._writeTestList(testIds);
+        const execArgs: string[] = [ "--verbose", ...selection.args ];
 
         // Build a DebugConfiguration that runs the requested tests through the C++ debugger.
         const debugLaunchConfig: vscode.DebugConfiguration = {
@@ -446,6 +479,7 @@ export class Adapter extends DisposableBase implements TestAdapter {
             const success = await vscode.debug.startDebugging(this._workspaceFolder, debugLaunchConfig);
             const activeSession = vscode.debug.activeDebugSession;
             if (!success || !activeSession) {
+                this._deleteTestList(selection.testListFile);
                 this._logger.write('Failed to start debugging session');
                 reject("Failed to start debugging session");
                 return;
@@ -455,6 +489,7 @@ export class Adapter extends DisposableBase implements TestAdapter {
                 if (activeSession != session) {
                     return;
                 }
+                this._deleteTestList(selection.testListFile);
                 resolve();
                 this.untrackAndDispose(subscription);
             });
@@ -464,17 +499,60 @@ export class Adapter extends DisposableBase implements TestAdapter {
 
     //----------------------------------------------------------------------------------------------------
 
+    private _writeTestList(testIds: string[]) : { args: string[], testListFile?: string } {
+        // Fixture ids are passed as keywords, which match every test in the fixture.
+        const fixtureKeywords = testIds.filter((id) => !id.includes('::')).map((id) => id + '::');
+        const testNames = testIds.filter((id) => id.includes('::'));
+        if (testNames.length == 0) {
+            return { args: fixtureKeywords };
+        }
+
+        // The tests are passed in a file, as a large selection won't fit on the command line.
+        const testListFile = path.join(os.tmpdir(), 'cpputf-tests-' + process.pid + '-' + Date.now() + '.txt');
+        fs.writeFileSync(testListFile, testNames.join('\n') + '\n');
+        return {
+            args: [ '--test_list=' + testListFile, ...fixtureKeywords ],
+            testListFile: testListFile
+        };
+    }
+
+    private _deleteTestList(testListFile: string | undefined) : void {
+        if (testListFile) {
+            fs.unlink(testListFile, () => {});
+        }
+    }
+
+    //----------------------------------------------------------------------------------------------------
+
     private _updateTestStatus(
         testId: string,
         state: "running" | "passed" | "failed" | "skipped",
         message: string
     ) : boolean {
-        this._testStatesEmitter.fire({
+        // Only the latest state of each test is kept until the batch is fired.
+        this._pendingTestStates.delete(testId);
+        this._pendingTestStates.set(testId, {
             type: 'test',
             test: testId,
             state: state,
             message: message
         });
+
+        if (!this._testStatesTimer) {
+            this._testStatesTimer = setTimeout(() => { this._flushTestStates(); }, Adapter.TestStatesDelay);
+        }
         return true;
     }
+
+    private _flushTestStates() : void {
+        if (this._testStatesTimer) {
+            clearTimeout(this._testStatesTimer);
+            this._testStatesTimer = undefined;
+        }
+
+        for (const event of this._pendingTestStates.values()) {
+            this._testStatesEmitter.fire(event);
+        }
+        this._pendingTestStates.clear();
+    }
 }
\ No newline at end of file
@@ -10,7 +10,7 @@ export class AsyncExec extends DisposableBase {
     private readonly _logger: Logger;
     private _process?: childProcess.ChildProcess = undefined;
 
-    private _incompleteLine?: string = undefined;
+    private _incompleteLine: string = '';
 
     //--------------------------------------------------------------------------------------------------------
 
@@ -57,7 +57,8 @@ export class AsyncExec extends DisposableBase {
         this._process = childProcess.spawn(executable, args, spawnConfig);
         this._process.on('close', (code) => { this._onExit(code); });
         this._process.on('error', (error) => { this._onError(error) });
-        this._process.stdout!.on('data', (chunk) => { this._onChunk(chunk); });
+        this._process.stdout!.setEncoding('utf8');   // Characters split across chunks are decoded whole
+        this._process.stdout!.on('data', (chunk: string) => { this._onChunk(chunk); });
     }
 
     //--------------------------------------------------------------------------------------------------------
@@ -89,37 +90,37 @@ export class AsyncExec extends DisposableBase {
         this._errorEmitter.fire(error);
     }
 
-    private _onChunk(chunk: any) {
-        // Split the chunk into lines.
-        const lines = chunk.toString().split(/[\r\n]+/);
-
-        // Append the first line from the chunk with the [this._incompleteLine], if one exists.
-        if (this._incompleteLine) {
-            this._incompleteLine += lines.shift();
-        }
-
-        // If we have at least one complete line then output all complete lines.
-        if (lines.length > 0) {
-            // [this._incompleteLine] must be complete.
-            if (this._incompleteLine) {
-                this._stdoutLineEmitter.fire(this._incompleteLine);
+    private _onChunk(chunk: string) {
+        // Only the new chunk is scanned for line breaks.  The incomplete line at its end is held in
+        // [this._incompleteLine] until the rest of it arrives.
+        let start = 0;
+        for (let end = chunk.indexOf('\n'); end >= 0; end = chunk.indexOf('\n', start)) {
+            let line = chunk.substring(start, end);
+            if (start == 0 && this._incompleteLine) {
+                line = this._incompleteLine + line;
+                this._incompleteLine = '';
             }
+            this._fireLine(line);
+            start = end + 1;
+        }
+        this._incompleteLine += chunk.substring(start);
+    }
 
-            // Set [this._incompleteLine] to the last line in the chunk.  We don't know for sure that
-            // it's complete yet.
-            this._incompleteLine = lines.pop();
+    private _fireLine(line: string) {
+        if (line.endsWith('\r')) {
+            line = line.substring(0, line.length - 1);
+        }
 
-            // Output remaining complete lines.
-            for (let line of lines) {
-                this._stdoutLineEmitter.fire(line);
-            }
+        // Blank lines carry no information.
+        if (line.length != 0) {
+            this._stdoutLineEmitter.fire(line);
         }
     }
 
     private _flushIncompleteLine() {
         if (this._incompleteLine) {
-            this._stdoutLineEmitter.fire(this._incompleteLine);
-            this._incompleteLine = undefined;
+            this._fireLine(this._incompleteLine);
+            this._incompleteLine = '';
         }
     }
 }
\ No newline at end of file